@@ -0,0 +1,1697 @@
+// Benchmarks of the logs formatting functions, measured in time-stamp counter ticks per call.
+// Compilation command lines:
+// - With MSVC on Windows (inside a x64 Native Tools Command Prompt for VS):
+//   cl.exe /nologo /DLOGS_ENABLED /DLOGS_BUFFER_SIZE=65536 /O2 /std:c11 /utf-8 logs.c benchmark.c /link /entry:mainCRTStartup /nodefaultlib /subsystem:console kernel32.lib
+// - With GCC:
+//   gcc -DLOGS_ENABLED -DLOGS_BUFFER_SIZE=65536 -O2 -fno-builtin -fno-stack-protector -mbmi2 -mlzcnt -mssse3 -nostdlib logs.c benchmark.c
+// - With clang:
+//   clang -DLOGS_ENABLED -DLOGS_BUFFER_SIZE=65536 -O2 -fno-builtin -fno-stack-protector -mbmi2 -mlzcnt -mssse3 -nostdlib logs.c benchmark.c
+#include "logs.h"
+
+#if defined(_MSC_VER)
+#  include <intrin.h>
+#endif
+
+// Count of values formatted per measurement, and count of times each measurement is repeated
+#define BENCH_VALUE_COUNT 1024
+#define BENCH_ROUND_COUNT 32
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//// Helpers
+static inline u64 read_tsc(void)
+{
+#if defined(_MSC_VER)
+  _mm_lfence();
+  return __rdtsc();
+#elif defined(__clang__) || defined(__GNUC__)
+  __builtin_ia32_lfence();
+  return __builtin_ia32_rdtsc();
+#endif
+}
+
+
+// xorshift64, see https://www.jstatsoft.org/article/view/v008i14
+static u64 random_state = 0x9E3779B97F4A7C15ull;
+
+static inline u64 random_u64(void)
+{
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 7;
+  random_state ^= random_state << 17;
+
+  return random_state;
+}
+
+
+// Text columns, binary logs builds report their results with log_binary()
+#if !defined(LOGS_BINARY) || (LOGS_BINARY == 0)
+// Log num in decimal, right-aligned in a column of column_width characters
+static void log_aligned_dec_u64(u64 num, u64 column_width)
+{
+  const u64 digit_count = u64_digit_count(num);
+  for (u64 i = digit_count; i < column_width; i++)
+  {
+    log_character(' ');
+  }
+
+  log_sized_dec_u64(num, digit_count);
+}
+
+
+// Log ticks / call_count with 2 fractional digits, right-aligned in a column of 9 characters
+static void log_ticks_per_call(u64 ticks, u64 call_count)
+{
+  const u64 hundredths = (ticks * 100) / call_count;
+
+  log_aligned_dec_u64(hundredths / 100, 6);
+  log_character('.');
+  log_sized_dec_u64(hundredths % 100, 2);
+}
+#endif
+
+
+#if defined(LOGS_OS_LINUX)
+static inline s64 bench_syscall3(u64 number, u64 arg_0, u64 arg_1, u64 arg_2)
+{
+  register u64 number_rax __asm__("rax") = number;
+  register u64 arg_0_rdi  __asm__("rdi") = arg_0;
+  register u64 arg_1_rsi  __asm__("rsi") = arg_1;
+  register u64 arg_2_rdx  __asm__("rdx") = arg_2;
+  s64 result;
+  __asm__ __volatile__ ("syscall" :
+                        "=a"(result) :
+                        "r"(number_rax), "r"(arg_0_rdi), "r"(arg_1_rsi), "r"(arg_2_rdx) :
+                        "rcx", "r11", "memory");
+  return result;
+}
+
+
+// CLOCK_MONOTONIC time in nanoseconds
+static inline u64 read_monotonic_ns(void)
+{
+  static struct { s64 sec; s64 nsec; } time;
+  bench_syscall3(228, 1, (u64)&time, 0); // clock_gettime(CLOCK_MONOTONIC, &time)
+
+  return ((u64)time.sec * 1000000000ull) + (u64)time.nsec;
+}
+#endif
+
+
+
+
+// Formatting functions are measured by the builds without LOGS_SHARED_RING, which only appends to
+// reserved records of up to LOGS_SHARED_RING_MAX_RECORD_SIZE bytes, without LOGS_BINARY, whose
+// output is decoded by logs_decode, without LOGS_DEFERRED_FORMATTING, which formats on flushes, and
+// without LOGS_MMAP_FILE and LOGS_FILE_ROTATION, which only change how files are written
+#if (!defined(LOGS_SHARED_RING) || (LOGS_SHARED_RING == 0)) &&                   \
+    (!defined(LOGS_BINARY) || (LOGS_BINARY == 0)) &&                             \
+    (!defined(LOGS_DEFERRED_FORMATTING) || (LOGS_DEFERRED_FORMATTING == 0)) &&   \
+    (!defined(LOGS_MMAP_FILE) || (LOGS_MMAP_FILE == 0)) &&                       \
+    (!defined(LOGS_FILE_ROTATION) || (LOGS_FILE_ROTATION == 0))
+///////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//// Decimal integers
+// Digit-per-iteration loop log_sized_dec_u64() used before the 2-digit table, kept as a reference
+static void loop_sized_dec_u64(u64 num, u64 digit_to_write_count)
+{
+  u8* const num_str_start = logs.buffer + logs.buffer_end_idx;
+  u8*       dest          = num_str_start + digit_to_write_count;
+  while (dest > num_str_start)
+  {
+    u64 quotient = num / 10;
+    u8  digit    = (u8)(num - (quotient * 10));
+
+    dest -= 1;
+    *dest = '0' + digit;
+
+    num = quotient;
+  }
+
+  logs.buffer_end_idx += digit_to_write_count;
+}
+
+
+static void bench_dec_u64(void)
+{
+  static u64 values[BENCH_VALUE_COUNT];
+
+  log_literal_str("log_sized_dec_u64(), ticks per call\n"
+                  "digits |     loop |     logs\n");
+  logs_flush();
+
+  u64 pow10 = 1;
+  for (u64 digit_count = 1; digit_count <= U64_MAX_DEC_STR_SIZE; digit_count++)
+  {
+    // Values in [10^(digit_count - 1); 10^digit_count - 1]
+    const u64 range = (digit_count == U64_MAX_DEC_STR_SIZE) ? (0ull - pow10) : (pow10 * 9);
+    for (u64 i = 0; i < BENCH_VALUE_COUNT; i++)
+    {
+      values[i] = pow10 + (random_u64() % range);
+    }
+    pow10 *= 10;
+
+    u64 loop_ticks = 0;
+    u64 logs_ticks = 0;
+    for (u64 round = 0; round < BENCH_ROUND_COUNT; round++)
+    {
+      u64 start = read_tsc();
+      for (u64 i = 0; i < BENCH_VALUE_COUNT; i++)
+      {
+        loop_sized_dec_u64(values[i], digit_count);
+        logs.buffer_end_idx = 0;
+      }
+      u64 mid = read_tsc();
+      for (u64 i = 0; i < BENCH_VALUE_COUNT; i++)
+      {
+        log_sized_dec_u64(values[i], digit_count);
+        logs.buffer_end_idx = 0;
+      }
+      u64 end = read_tsc();
+
+      loop_ticks  += mid - start;
+      logs_ticks += end - mid;
+    }
+
+    const u64 call_count = BENCH_VALUE_COUNT * BENCH_ROUND_COUNT;
+    log_aligned_dec_u64(digit_count, 6);
+    log_literal_str(" |");
+    log_ticks_per_call(loop_ticks, call_count);
+    log_literal_str(" |");
+    log_ticks_per_call(logs_ticks, call_count);
+    log_character('\n');
+    logs_flush();
+  }
+
+  log_character('\n');
+  logs_flush();
+}
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//// Floating-point numbers
+// Naive floating-point formatting: num is scaled to [1; 10[ by repeated multiplications or divisions
+// by 10, then digit_count digits are extracted by multiplying the remainder by 10. Results are
+// neither the shortest nor always exact
+static void multiply_dec_float(f64 num, u64 digit_count)
+{
+  u64 is_neg = num < 0.;
+
+  logs.buffer[logs.buffer_end_idx] = '-'; // overwritten if unnecessary
+  logs.buffer_end_idx += is_neg;
+
+  num = is_neg ? -num : num;
+  s64 dec_exp = 0;
+  while (num >= 10.)
+  {
+    num     /= 10.;
+    dec_exp += 1;
+  }
+  while ((num < 1.) && (num != 0.))
+  {
+    num     *= 10.;
+    dec_exp -= 1;
+  }
+
+  u8* dest = logs.buffer + logs.buffer_end_idx;
+  for (u64 i = 0; i < digit_count; i++)
+  {
+    u8 digit = (u8)num;
+    *dest = '0' + digit;
+    dest += 1 + (i == 0);
+    num = (num - digit) * 10.;
+  }
+  logs.buffer[logs.buffer_end_idx + 1] = '.';
+  logs.buffer_end_idx += digit_count + 1;
+
+  log_character('e');
+  log_dec_s64(dec_exp);
+}
+
+
+static void bench_dec_float(void)
+{
+  static f32 f32_values[BENCH_VALUE_COUNT];
+  static f64 f64_values[BENCH_VALUE_COUNT];
+
+  // Random significands with exponents in [2^-10; 2^21] (f32) and [2^-30; 2^60] (f64)
+  for (u64 i = 0; i < BENCH_VALUE_COUNT; i++)
+  {
+    u64 random = random_u64();
+    u32 f32_bits = ((u32)random & 0x807FFFFF) | ((u32)(117 + ((random >> 32) % 31)) << 23);
+    u64 f64_bits = (random & 0x800FFFFFFFFFFFFFull) | ((993 + (random % 90)) << 52);
+    f32_values[i] = *(f32*)&f32_bits;
+    f64_values[i] = *(f64*)&f64_bits;
+  }
+
+  // Ticks of the naive loop and of log_dec_*(), log_sized_sci_*() and log_sized_dec_*(), for f32
+  // then f64
+  static u64 ticks[2][4];
+  for (u64 round = 0; round < BENCH_ROUND_COUNT; round++)
+  {
+    u64 start = read_tsc();
+    for (u64 i = 0; i < BENCH_VALUE_COUNT; i++)
+    {
+      multiply_dec_float(f32_values[i], F32_MAX_DEC_SIGNIFICANT_DIGITS);
+      logs.buffer_end_idx = 0;
+    }
+    u64 f32_multiply_end = read_tsc();
+    for (u64 i = 0; i < BENCH_VALUE_COUNT; i++)
+    {
+      log_dec_f32(f32_values[i]);
+      logs.buffer_end_idx = 0;
+    }
+    u64 f32_shortest_end = read_tsc();
+    for (u64 i = 0; i < BENCH_VALUE_COUNT; i++)
+    {
+      log_sized_sci_f32(f32_values[i], F32_MAX_DEC_SIGNIFICANT_DIGITS);
+      logs.buffer_end_idx = 0;
+    }
+    u64 f32_sci_end = read_tsc();
+    for (u64 i = 0; i < BENCH_VALUE_COUNT; i++)
+    {
+      log_sized_dec_f32(f32_values[i], F32_DEC_FRAC_DEFAULT_STR_SIZE);
+      logs.buffer_end_idx = 0;
+    }
+    u64 f32_fixed_end = read_tsc();
+    for (u64 i = 0; i < BENCH_VALUE_COUNT; i++)
+    {
+      multiply_dec_float(f64_values[i], F64_MAX_DEC_SIGNIFICANT_DIGITS);
+      logs.buffer_end_idx = 0;
+    }
+    u64 f64_multiply_end = read_tsc();
+    for (u64 i = 0; i < BENCH_VALUE_COUNT; i++)
+    {
+      log_dec_f64(f64_values[i]);
+      logs.buffer_end_idx = 0;
+    }
+    u64 f64_shortest_end = read_tsc();
+    for (u64 i = 0; i < BENCH_VALUE_COUNT; i++)
+    {
+      log_sized_sci_f64(f64_values[i], F64_MAX_DEC_SIGNIFICANT_DIGITS);
+      logs.buffer_end_idx = 0;
+    }
+    u64 f64_sci_end = read_tsc();
+    for (u64 i = 0; i < BENCH_VALUE_COUNT; i++)
+    {
+      log_sized_dec_f64(f64_values[i], F32_DEC_FRAC_DEFAULT_STR_SIZE);
+      logs.buffer_end_idx = 0;
+    }
+    u64 f64_fixed_end = read_tsc();
+
+    ticks[0][0] += f32_multiply_end - start;
+    ticks[0][1] += f32_shortest_end - f32_multiply_end;
+    ticks[0][2] += f32_sci_end      - f32_shortest_end;
+    ticks[0][3] += f32_fixed_end    - f32_sci_end;
+    ticks[1][0] += f64_multiply_end - f32_fixed_end;
+    ticks[1][1] += f64_shortest_end - f64_multiply_end;
+    ticks[1][2] += f64_sci_end      - f64_shortest_end;
+    ticks[1][3] += f64_fixed_end    - f64_sci_end;
+  }
+
+  // multiply and sci write all the significant digits, fixed writes 6 fractional digits
+  const u64 call_count = BENCH_VALUE_COUNT * BENCH_ROUND_COUNT;
+  log_literal_str("log_dec_f32/f64(), log_sized_sci_f32/f64() and log_sized_dec_f32/f64() on random "
+                  "values, ticks per call\n"
+                  "  type | multiply | shortest |      sci |    fixed\n");
+  for (u64 type_idx = 0; type_idx < 2; type_idx++)
+  {
+    log_literal_str("   f");
+    log_dec_u64(32 << type_idx);
+    log_literal_str(" |");
+    for (u64 column_idx = 0; column_idx < 4; column_idx++)
+    {
+      log_ticks_per_call(ticks[type_idx][column_idx], call_count);
+      if (column_idx < 3)
+      {
+        log_literal_str(" |");
+      }
+    }
+    log_character('\n');
+  }
+  log_character('\n');
+  logs_flush();
+}
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//// UTF-8 strings
+#define BENCH_UTF8_STR_MAX_SIZE (64 * 1024)
+
+// log_sized_utf8_str() appends up to 64 KiB at once
+#if LOGS_BUFFER_SIZE < BENCH_UTF8_STR_MAX_SIZE
+#  error "The benchmark needs a logs buffer of at least 64 KiB, compile it with -DLOGS_BUFFER_SIZE=65536"
+#endif
+
+// 8-byte per iteration log_sized_utf8_str() used before size-tiered copies, kept as a reference
+static void loop_sized_utf8_str(const char* str, u64 char_count)
+{
+  char* dest_u8 = (char*)(logs.buffer + logs.buffer_end_idx);
+
+  const u64         u8_x8_count = char_count & ~7;
+  const char* const str_x8_end  = str + u8_x8_count;
+  const char* const str_end     = str + char_count;
+
+  while (str < str_x8_end)
+  {
+    *(u64*)dest_u8 = *(u64*)str;
+
+    dest_u8 += 8;
+    str  += 8;
+  }
+
+  while (str < str_end)
+  {
+    *dest_u8 = *str;
+    dest_u8 += 1;
+    str  += 1;
+  }
+
+  logs.buffer_end_idx += char_count;
+}
+
+
+static void bench_utf8_str(void)
+{
+  static const u64 sizes[] =
+  {
+    1, 3, 7, 8, 13, 16, 24, 32, 48, 64, 100, 128, 256, 512, 1024, 2048, 4096, 8192, 16384, 32768,
+    65536
+  };
+  static char str[BENCH_UTF8_STR_MAX_SIZE + 64];
+  for (u64 i = 0; i < sizeof(str); i++)
+  {
+    str[i] = 'a' + (char)(random_u64() % 26);
+  }
+
+  log_literal_str("log_sized_utf8_str(), ticks per call\n"
+                  "  size |     loop |     logs\n");
+  logs_flush();
+
+  for (u64 size_idx = 0; size_idx < (sizeof(sizes) / sizeof(sizes[0])); size_idx++)
+  {
+    // Fewer calls for larger sizes, the source string start varies across the first 64 bytes
+    const u64 size       = sizes[size_idx];
+    const u64 call_count = (size <= 1024) ? BENCH_VALUE_COUNT : ((BENCH_VALUE_COUNT * 1024) / size);
+
+    u64 loop_ticks = 0;
+    u64 logs_ticks = 0;
+    for (u64 round = 0; round < BENCH_ROUND_COUNT; round++)
+    {
+      u64 start = read_tsc();
+      for (u64 i = 0; i < call_count; i++)
+      {
+        loop_sized_utf8_str(str + (i & 63), size);
+        logs.buffer_end_idx = 0;
+      }
+      u64 mid = read_tsc();
+      for (u64 i = 0; i < call_count; i++)
+      {
+        log_sized_utf8_str(str + (i & 63), size);
+        logs.buffer_end_idx = 0;
+      }
+      u64 end = read_tsc();
+
+      loop_ticks += mid - start;
+      logs_ticks += end - mid;
+    }
+
+    log_aligned_dec_u64(size, 6);
+    log_literal_str(" |");
+    log_ticks_per_call(loop_ticks, call_count * BENCH_ROUND_COUNT);
+    log_literal_str(" |");
+    log_ticks_per_call(logs_ticks, call_count * BENCH_ROUND_COUNT);
+    log_character('\n');
+    logs_flush();
+  }
+
+  log_character('\n');
+  logs_flush();
+}
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//// UTF-16 strings
+#define BENCH_UTF16_STR_SIZE 256
+
+// Code point per iteration log_sized_utf16_str() used before SIMD transcoding, kept as a reference
+static void loop_sized_utf16_str(const char16* str, u64 char16_count)
+{
+  u8* dest = logs.buffer + logs.buffer_end_idx;
+  while (char16_count != 0)
+  {
+    u32 unicode;
+    u64 char16_read        = utf16_code_point_to_unicode(str, &unicode);
+    u64 written_byte_count = unicode_to_utf8_code_point(unicode, dest);
+
+    char16_count -= char16_read;
+    str          += char16_read;
+    dest         += written_byte_count;
+  }
+
+  logs.buffer_end_idx = dest - logs.buffer;
+}
+
+
+static void bench_utf16_str(void)
+{
+  // ASCII, Latin-1 Supplement, CJK and emoji (surrogate pairs) characters, 1 in 8 of them being
+  // non-ASCII
+  static const char16 non_ascii_chars[4][2] = {{u'a', 0}, {u'é', 0}, {u'語', 0}, {0xD83D, 0xDE00}};
+  static const char   column_names[]        = "ascii  latin  cjk    emoji  ";
+  static char16       str[BENCH_UTF16_STR_SIZE + 1];
+
+  log_literal_str("log_sized_utf16_str() on 256 code units, ticks per call\n"
+                  "  text |     loop |     logs\n");
+  logs_flush();
+
+  for (u64 text_idx = 0; text_idx < 4; text_idx++)
+  {
+    for (u64 i = 0; i < BENCH_UTF16_STR_SIZE; i++)
+    {
+      str[i] = ((random_u64() & 7) == 0) ? non_ascii_chars[text_idx][0] : u'a';
+      if ((str[i] >= 0xD800) && (str[i] <= 0xDBFF))
+      {
+        i      += 1;
+        str[i]  = non_ascii_chars[text_idx][1];
+      }
+    }
+
+    u64 loop_ticks = 0;
+    u64 logs_ticks = 0;
+    for (u64 round = 0; round < BENCH_ROUND_COUNT; round++)
+    {
+      u64 start = read_tsc();
+      for (u64 i = 0; i < BENCH_VALUE_COUNT; i++)
+      {
+        loop_sized_utf16_str(str, BENCH_UTF16_STR_SIZE);
+        logs.buffer_end_idx = 0;
+      }
+      u64 mid = read_tsc();
+      for (u64 i = 0; i < BENCH_VALUE_COUNT; i++)
+      {
+        log_sized_utf16_str(str, BENCH_UTF16_STR_SIZE);
+        logs.buffer_end_idx = 0;
+      }
+      u64 end = read_tsc();
+
+      loop_ticks += mid - start;
+      logs_ticks += end - mid;
+    }
+
+    const u64 call_count = BENCH_VALUE_COUNT * BENCH_ROUND_COUNT;
+    log_character(' ');
+    log_sized_utf8_str(column_names + (text_idx * 7), 6);
+    log_literal_str("|");
+    log_ticks_per_call(loop_ticks, call_count);
+    log_literal_str(" |");
+    log_ticks_per_call(logs_ticks, call_count);
+    log_character('\n');
+    logs_flush();
+  }
+
+  log_character('\n');
+  logs_flush();
+}
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//// Timestamps
+#if defined(LOGS_OS_LINUX)
+#define BENCH_TIMESTAMP_STEP_NS 1000
+
+// log_time_of_day() (format_idx 0), log_iso8601_ms() (1) and log_iso8601_ns() (2) without their
+// date and time cache, converting and formatting every field on each call, kept as a reference
+static void uncached_timestamp(u64 timestamp_ns, u64 format_idx)
+{
+  const u64 seconds    = timestamp_ns / 1000000000ull;
+  const u64 day_second = seconds % 86400;
+  const u64 has_date   = format_idx != 0;
+  if (has_date)
+  {
+    const s64 days      = (s64)(seconds / 86400) + 719468;
+    const s64 era       = days / 146097;
+    const u64 era_day   = (u64)(days - (era * 146097));
+    const u64 era_year  = (era_day - (era_day / 1460) + (era_day / 36524) - (era_day / 146096)) / 365;
+    const u64 year_day  = era_day - ((365 * era_year) + (era_year / 4) - (era_year / 100));
+    const u64 month_idx = ((5 * year_day) + 2) / 153;
+    const u64 day       = year_day - (((153 * month_idx) + 2) / 5) + 1;
+    const u64 month     = (month_idx < 10) ? (month_idx + 3) : (month_idx - 9);
+    const u64 year      = (u64)(era * 400) + era_year + (month <= 2);
+
+    log_sized_dec_u64(year, 4);
+    log_character('-');
+    log_sized_dec_u64(month, 2);
+    log_character('-');
+    log_sized_dec_u64(day, 2);
+    log_character('T');
+  }
+
+  log_sized_dec_u64(day_second / 3600, 2);
+  log_character(':');
+  log_sized_dec_u64((day_second / 60) % 60, 2);
+  log_character(':');
+  log_sized_dec_u64(day_second % 60, 2);
+  log_character('.');
+  if (format_idx == 1)
+  {
+    log_sized_dec_u64((timestamp_ns % 1000000000ull) / 1000000, 3);
+  }
+  else
+  {
+    log_sized_dec_u64(timestamp_ns % 1000000000ull, 9);
+  }
+  if (has_date)
+  {
+    log_character('Z');
+  }
+}
+
+
+static void bench_timestamps(void)
+{
+  static const char format_names[] = "    time of day ns |       ISO 8601 ms |       ISO 8601 ns |";
+  static struct { s64 sec; s64 nsec; } time;
+
+  logs_calibrate_clock();
+
+  log_literal_str("Timestamps, ticks per call\n"
+                  "         clock_gettime syscall |");
+  logs_flush();
+
+  u64 syscall_ticks = 0;
+  u64 logs_ticks    = 0;
+  u64 sum           = 0;
+  for (u64 round = 0; round < BENCH_ROUND_COUNT; round++)
+  {
+    u64 start = read_tsc();
+    for (u64 i = 0; i < BENCH_VALUE_COUNT; i++)
+    {
+      bench_syscall3(228, 0, (u64)&time, 0); // clock_gettime(CLOCK_REALTIME, &time)
+    }
+    u64 mid = read_tsc();
+    for (u64 i = 0; i < BENCH_VALUE_COUNT; i++)
+    {
+      sum += logs_timestamp_ns();
+    }
+    u64 end = read_tsc();
+
+    syscall_ticks += mid - start;
+    logs_ticks    += end - mid;
+  }
+
+  const u64 call_count = BENCH_VALUE_COUNT * BENCH_ROUND_COUNT;
+  log_ticks_per_call(syscall_ticks, call_count);
+  log_literal_str("\n"
+                  "           logs_timestamp_ns() |");
+  log_ticks_per_call(logs_ticks, call_count);
+  log_literal_str("\n\n"
+                  "Timestamps 1 us apart, ticks per call\n"
+                  "            format | uncached |     logs\n");
+  logs_flush();
+
+  const u64 base_ns = sum / call_count;
+  for (u64 format_idx = 0; format_idx < 3; format_idx++)
+  {
+    u64 uncached_ticks = 0;
+    u64 cached_ticks   = 0;
+    for (u64 round = 0; round < BENCH_ROUND_COUNT; round++)
+    {
+      u64 timestamp_ns = base_ns + (round * BENCH_VALUE_COUNT * BENCH_TIMESTAMP_STEP_NS);
+      u64 start        = read_tsc();
+      for (u64 i = 0; i < BENCH_VALUE_COUNT; i++)
+      {
+        uncached_timestamp(timestamp_ns + (i * BENCH_TIMESTAMP_STEP_NS), format_idx);
+        logs.buffer_end_idx = 0;
+      }
+      u64 mid = read_tsc();
+      if (format_idx == 0)
+      {
+        for (u64 i = 0; i < BENCH_VALUE_COUNT; i++)
+        {
+          log_time_of_day(timestamp_ns + (i * BENCH_TIMESTAMP_STEP_NS));
+          logs.buffer_end_idx = 0;
+        }
+      }
+      else if (format_idx == 1)
+      {
+        for (u64 i = 0; i < BENCH_VALUE_COUNT; i++)
+        {
+          log_iso8601_ms((timestamp_ns + (i * BENCH_TIMESTAMP_STEP_NS)) / 1000000);
+          logs.buffer_end_idx = 0;
+        }
+      }
+      else
+      {
+        for (u64 i = 0; i < BENCH_VALUE_COUNT; i++)
+        {
+          log_iso8601_ns(timestamp_ns + (i * BENCH_TIMESTAMP_STEP_NS));
+          logs.buffer_end_idx = 0;
+        }
+      }
+      u64 end = read_tsc();
+
+      uncached_ticks += mid - start;
+      cached_ticks   += end - mid;
+    }
+
+    log_sized_utf8_str(format_names + (format_idx * 20), 20);
+    log_ticks_per_call(uncached_ticks, call_count);
+    log_literal_str(" |");
+    log_ticks_per_call(cached_ticks, call_count);
+    log_character('\n');
+    logs_flush();
+  }
+
+  log_character('\n');
+  logs_flush();
+}
+#endif
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//// Line prefixes
+#define BENCH_PREFIX_BASE_NS 1700000000000000000ull
+
+// "HH:MM:SS.nnnnnnnnn [INFO] tttttt: " built by the calls it takes without templates, with or
+// without colours, kept as a reference
+static void piecemeal_prefix(u64 timestamp_ns, u64 thread_id, u64 has_colours)
+{
+  if (has_colours)
+  {
+    log_literal_str(LOGS_ANSI_GRAY);
+  }
+  log_time_of_day(timestamp_ns);
+  if (has_colours)
+  {
+    log_literal_str(LOGS_ANSI_RESET " [" LOGS_ANSI_GREEN "INFO" LOGS_ANSI_RESET "] ");
+  }
+  else
+  {
+    log_literal_str(" [INFO] ");
+  }
+  log_sized_dec_u64(thread_id, 6);
+  log_literal_str(": ");
+}
+
+
+static void bench_line_prefixes(void)
+{
+  static logs_prefix prefix;
+  static const char  column_names[] = "plain  colour ";
+
+  logs_prefix_append_literal_ansi_str(&prefix, LOGS_ANSI_GRAY);
+  logs_prefix_append_field(&prefix, LOGS_PREFIX_TIME_OF_DAY, 9);
+  logs_prefix_append_literal_ansi_str(&prefix, LOGS_ANSI_RESET);
+  logs_prefix_append_literal_str(&prefix, " [");
+  logs_prefix_append_literal_ansi_str(&prefix, LOGS_ANSI_GREEN);
+  logs_prefix_append_literal_str(&prefix, "INFO");
+  logs_prefix_append_literal_ansi_str(&prefix, LOGS_ANSI_RESET);
+  logs_prefix_append_literal_str(&prefix, "] ");
+  logs_prefix_append_field(&prefix, LOGS_PREFIX_DEC, 6);
+  logs_prefix_append_literal_str(&prefix, ": ");
+
+  log_literal_str("Line prefixes \"HH:MM:SS.nnnnnnnnn [INFO] tttttt: \" 1 us apart, ticks per call\n"
+                  "prefix | log_* calls | log_prefix()\n");
+  logs_flush();
+
+  for (u64 has_colours = 0; has_colours < 2; has_colours++)
+  {
+    u64 piecemeal_ticks = 0;
+    u64 template_ticks  = 0;
+    for (u64 round = 0; round < BENCH_ROUND_COUNT; round++)
+    {
+      u64 timestamp_ns = BENCH_PREFIX_BASE_NS + (round * BENCH_VALUE_COUNT * 1000);
+      u64 start        = read_tsc();
+      for (u64 i = 0; i < BENCH_VALUE_COUNT; i++)
+      {
+        piecemeal_prefix(timestamp_ns + (i * 1000), i, has_colours);
+        logs.buffer_end_idx = 0;
+      }
+      u64 mid = read_tsc();
+      if (has_colours)
+      {
+        logs_enable_console_ansi_escape_sequence();
+      }
+      for (u64 i = 0; i < BENCH_VALUE_COUNT; i++)
+      {
+        const u64 values[2] = {timestamp_ns + (i * 1000), i};
+        log_prefix(&prefix, values);
+        logs.buffer_end_idx = 0;
+      }
+      u64 end = read_tsc();
+      logs_disable_console_ansi_escape_sequence();
+
+      piecemeal_ticks += mid - start;
+      template_ticks  += end - mid;
+    }
+
+    const u64 call_count = BENCH_VALUE_COUNT * BENCH_ROUND_COUNT;
+    log_sized_utf8_str(column_names + (has_colours * 7), 7);
+    log_literal_str("|   ");
+    log_ticks_per_call(piecemeal_ticks, call_count);
+    log_literal_str(" |    ");
+    log_ticks_per_call(template_ticks, call_count);
+    log_character('\n');
+    logs_flush();
+  }
+
+  log_character('\n');
+  logs_flush();
+}
+#endif
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//// Flushes
+#if defined(LOGS_OS_LINUX) && defined(LOGS_IO_URING) && (LOGS_IO_URING != 0)
+#define BENCH_FLUSH_FILE_NAME     "logs_bench_flush.txt"
+#define BENCH_MESSAGES_PER_FLUSH  64
+#define BENCH_FLUSH_COUNT         2048
+
+// Log messages of about 50 bytes, flushing them to the open outputs every BENCH_MESSAGES_PER_FLUSH
+// messages. Results are written to results[0] (messages per second), results[1] (ticks per flush,
+// times 100) and results[2] (maximum ticks of a flush)
+static void bench_flush_mode(logs_flush_mode flush_mode, u64 results[3])
+{
+  logs_set_flush_mode(flush_mode);
+
+  u64 flush_ticks     = 0;
+  u64 max_flush_ticks = 0;
+  u64 start_ns        = read_monotonic_ns();
+  for (u64 flush_idx = 0; flush_idx < BENCH_FLUSH_COUNT; flush_idx++)
+  {
+    for (u64 i = 0; i < BENCH_MESSAGES_PER_FLUSH; i++)
+    {
+      const u64 value = random_u64();
+      log_literal_str("[worker ");
+      log_dec_u64(i);
+      log_literal_str("] value=");
+      log_dec_u64(value >> 24);
+      log_literal_str(" ratio=");
+      log_dec_f64((f64)(value >> 11) * 0x1p-53);
+      log_character('\n');
+    }
+
+    const u64 start = read_tsc();
+    logs_flush();
+    const u64 ticks = read_tsc() - start;
+
+    flush_ticks     += ticks;
+    max_flush_ticks  = (ticks > max_flush_ticks) ? ticks : max_flush_ticks;
+  }
+
+  logs_wait_for_flush();
+  const u64 elapsed_ns    = read_monotonic_ns() - start_ns;
+  const u64 message_count = BENCH_FLUSH_COUNT * BENCH_MESSAGES_PER_FLUSH;
+
+  results[0] = (message_count * 1000000ull) / (elapsed_ns / 1000);
+  results[1] = (flush_ticks * 100) / BENCH_FLUSH_COUNT;
+  results[2] = max_flush_ticks;
+
+  logs_set_flush_mode(LOGS_FLUSH_WRITE);
+}
+
+
+static void bench_flush(void)
+{
+  static const char* const mode_names[3] =
+  {
+    "write syscalls        |",
+    "io_uring              |",
+    "io_uring asynchronous |"
+  };
+  static const logs_flush_mode modes[3] =
+  {
+    LOGS_FLUSH_WRITE,
+    LOGS_FLUSH_IO_URING,
+    LOGS_FLUSH_IO_URING_ASYNC
+  };
+  static u64 results[3][3];
+
+  // The console is replaced by /dev/null while measuring
+  // 2: open(path, flags, mode), 87: unlink(path), 3: close(fd)
+  const u32 console_output = logs.outputs[LOGS_OUTPUT_CONSOLE];
+  const s64 dev_null       = bench_syscall3(2, (u64)"/dev/null", 00000001, 0); // O_WRONLY
+  logs.outputs[LOGS_OUTPUT_CONSOLE] = (u32)dev_null;
+  logs_open_file_output(BENCH_FLUSH_FILE_NAME);
+
+  for (u64 mode_idx = 0; mode_idx < 3; mode_idx++)
+  {
+    bench_flush_mode(modes[mode_idx], results[mode_idx]);
+  }
+
+  logs_close_file_output();
+  bench_syscall3(87, (u64)BENCH_FLUSH_FILE_NAME, 0, 0);
+  bench_syscall3(3, (u64)dev_null, 0, 0);
+  logs.outputs[LOGS_OUTPUT_CONSOLE] = console_output;
+
+  log_literal_str("logs_flush() of 64 messages to a file and /dev/null\n"
+                  "mode                  |   messages/s | ticks/flush |  max ticks\n");
+  for (u64 mode_idx = 0; mode_idx < 3; mode_idx++)
+  {
+    log_null_terminated_str(mode_names[mode_idx]);
+    log_aligned_dec_u64(results[mode_idx][0], 13);
+    log_literal_str(" |");
+    log_ticks_per_call(results[mode_idx][1], 100);
+    log_literal_str("   |");
+    log_aligned_dec_u64(results[mode_idx][2], 11);
+    log_character('\n');
+  }
+
+  log_character('\n');
+  logs_flush();
+}
+#endif
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//// Threads
+#if defined(LOGS_OS_LINUX) && defined(LOGS_PER_THREAD) && (LOGS_PER_THREAD != 0)
+#define BENCH_THREAD_MAX_COUNT          8
+#define BENCH_THREAD_MESSAGE_COUNT      (256 * 1024)
+#define BENCH_THREAD_MESSAGES_PER_FLUSH 64
+#define BENCH_THREAD_STACK_SIZE         (64 * 1024)
+#define BENCH_THREAD_MESSAGE_MAX_SIZE   (8 + U64_MAX_DEC_STR_SIZE + 8 + U64_MAX_DEC_STR_SIZE + 7 + \
+                                         F64_MAX_DEC_STR_SIZE + 1)
+
+static _Alignas(16) u8 thread_stacks[BENCH_THREAD_MAX_COUNT][BENCH_THREAD_STACK_SIZE];
+static logs_thread     thread_logs[BENCH_THREAD_MAX_COUNT];
+
+static struct
+{
+  // Whether all threads share thread_logs[0], locked by lock, instead of using their own buffer
+  u32 share_buffer;
+  u32 lock;
+
+  // Thread identifiers, which the kernel sets to 0 once a thread has exited
+  u32 tids[BENCH_THREAD_MAX_COUNT];
+} bench_threads;
+
+
+static void lock_shared_buffer(void)
+{
+  while (__atomic_exchange_n(&bench_threads.lock, 1, __ATOMIC_ACQUIRE) != 0)
+  {
+    bench_syscall3(24, 0, 0, 0); // sched_yield()
+  }
+}
+
+
+static void unlock_shared_buffer(void)
+{
+  __atomic_store_n(&bench_threads.lock, 0, __ATOMIC_RELEASE);
+}
+
+
+// Body of a benchmark thread: log BENCH_THREAD_MESSAGE_COUNT messages of about 50 bytes, flushing
+// them every BENCH_THREAD_MESSAGES_PER_FLUSH messages, then exit the thread
+static void append_from_thread(u64 thread_idx)
+{
+  const u64 share_buffer = bench_threads.share_buffer;
+  logs_attach_thread(&thread_logs[share_buffer ? 0 : thread_idx]);
+
+  u64 state = 0x9E3779B97F4A7C15ull * (thread_idx + 1);
+  for (u64 i = 0; i < BENCH_THREAD_MESSAGE_COUNT; i++)
+  {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+
+    if (share_buffer)
+    {
+      lock_shared_buffer();
+    }
+
+#if defined(LOGS_SHARED_RING) && (LOGS_SHARED_RING != 0)
+    logs_reserve(BENCH_THREAD_MESSAGE_MAX_SIZE);
+#endif
+    log_literal_str("[worker ");
+    log_dec_u64(thread_idx);
+    log_literal_str("] value=");
+    log_dec_u64(state >> 24);
+    log_literal_str(" ratio=");
+    log_dec_f64((f64)(state >> 11) * 0x1p-53);
+    log_character('\n');
+#if defined(LOGS_SHARED_RING) && (LOGS_SHARED_RING != 0)
+    logs_commit();
+#endif
+    if ((i % BENCH_THREAD_MESSAGES_PER_FLUSH) == (BENCH_THREAD_MESSAGES_PER_FLUSH - 1))
+    {
+      logs_flush();
+    }
+
+    if (share_buffer)
+    {
+      unlock_shared_buffer();
+    }
+  }
+
+  bench_syscall3(60, 0, 0, 0); // exit(0), of this thread only
+}
+
+
+// Create a thread with a raw clone syscall, which starts on its own stack by calling
+// append_from_thread(thread_idx). Its identifier is stored in bench_threads.tids[thread_idx], and
+// cleared then woken up on by the kernel once the thread has exited and left its stack
+static void start_thread(u64 thread_idx)
+{
+  // CLONE_VM | CLONE_FS | CLONE_FILES | CLONE_SIGHAND | CLONE_THREAD | CLONE_SYSVSEM |
+  // CLONE_PARENT_SETTID | CLONE_CHILD_CLEARTID
+  register u64  clone_syscall_rax __asm__("rax") = 56;
+  register u64  flags_rdi         __asm__("rdi") = 0x350F00;
+  register u8*  stack_rsi         __asm__("rsi") = thread_stacks[thread_idx] + BENCH_THREAD_STACK_SIZE;
+  register u32* parent_tid_rdx    __asm__("rdx") = &bench_threads.tids[thread_idx];
+  register u32* child_tid_r10     __asm__("r10") = &bench_threads.tids[thread_idx];
+  register u64  tls_r8            __asm__("r8")  = 0;
+  register void (*entry_r12)(u64) __asm__("r12") = append_from_thread;
+  register u64  thread_idx_r13    __asm__("r13") = thread_idx;
+  __asm__ __volatile__ ("syscall\n\t"
+                        "testq %%rax, %%rax\n\t"
+                        "jnz 1f\n\t"
+                        "xorl %%ebp, %%ebp\n\t"
+                        "movq %%r13, %%rdi\n\t"
+                        "callq *%%r12\n\t"
+                        "ud2\n\t"
+                        "1:" :
+                        "+r"(clone_syscall_rax) :
+                        "r"(flags_rdi), "r"(stack_rsi), "r"(parent_tid_rdx), "r"(child_tid_r10),
+                        "r"(tls_r8), "r"(entry_r12), "r"(thread_idx_r13) :
+                        "rcx", "r11", "memory");
+}
+
+
+// Run thread_count threads appending messages at the same time, and return how many messages per
+// second they logged in total
+static u64 bench_thread_count(u64 thread_count, u64 share_buffer)
+{
+  bench_threads.share_buffer = (u32)share_buffer;
+
+  const u64 start_ns = read_monotonic_ns();
+  for (u64 thread_idx = 0; thread_idx < thread_count; thread_idx++)
+  {
+    start_thread(thread_idx);
+  }
+
+  // futex(FUTEX_WAIT) on each thread identifier until it is cleared, without timeout
+  for (u64 thread_idx = 0; thread_idx < thread_count; thread_idx++)
+  {
+    u32* tid = &bench_threads.tids[thread_idx];
+    for (u32 tid_value; (tid_value = __atomic_load_n(tid, __ATOMIC_ACQUIRE)) != 0;)
+    {
+      register u64  futex_syscall_rax __asm__("rax") = 202;
+      register u32* address_rdi       __asm__("rdi") = tid;
+      register u64  operation_rsi     __asm__("rsi") = 0;
+      register u64  expected_rdx      __asm__("rdx") = tid_value;
+      register u64  timeout_r10       __asm__("r10") = 0;
+      __asm__ __volatile__ ("syscall" :
+                            "+r"(futex_syscall_rax) :
+                            "r"(address_rdi), "r"(operation_rsi), "r"(expected_rdx),
+                            "r"(timeout_r10) :
+                            "rcx", "r11", "memory");
+    }
+  }
+
+  const u64 elapsed_ns    = read_monotonic_ns() - start_ns;
+  const u64 message_count = thread_count * BENCH_THREAD_MESSAGE_COUNT;
+
+  return (message_count * 1000000ull) / (elapsed_ns / 1000);
+}
+
+
+#if defined(LOGS_SHARED_RING) && (LOGS_SHARED_RING != 0)
+static void bench_ring_append(void)
+{
+  static const u64 thread_counts[4] = {1, 2, 4, 8};
+  static u64 results[4];
+  static u64 dropped_byte_counts[4];
+
+  // The console is replaced by /dev/null while measuring
+  // 2: open(path, flags, mode), 3: close(fd)
+  const u32 console_output = logs.outputs[LOGS_OUTPUT_CONSOLE];
+  const s64 dev_null       = bench_syscall3(2, (u64)"/dev/null", 00000001, 0); // O_WRONLY
+  logs.outputs[LOGS_OUTPUT_CONSOLE] = (u32)dev_null;
+
+  for (u64 i = 0; i < 4; i++)
+  {
+    const u64 dropped_byte_count = logs_ring_dropped_byte_count();
+    results[i]             = bench_thread_count(thread_counts[i], 0);
+    dropped_byte_counts[i] = logs_ring_dropped_byte_count() - dropped_byte_count;
+  }
+
+  bench_syscall3(3, (u64)dev_null, 0, 0);
+  logs.outputs[LOGS_OUTPUT_CONSOLE] = console_output;
+
+  // Logs only reach the ring through reserved records
+  logs_reserve(LOGS_SHARED_RING_MAX_RECORD_SIZE);
+#  if defined(LOGS_PER_CPU) && (LOGS_PER_CPU != 0)
+  log_literal_str("Messages/s appended to per-CPU rings by threads flushing them every 64 messages\n"
+                  "threads |   messages/s | speedup | dropped bytes\n");
+#  else
+  log_literal_str("Messages/s appended to the shared ring by threads flushing it every 64 messages\n"
+                  "threads |   messages/s | speedup | dropped bytes\n");
+#  endif
+  for (u64 i = 0; i < 4; i++)
+  {
+    log_aligned_dec_u64(thread_counts[i], 7);
+    log_literal_str(" |");
+    log_aligned_dec_u64(results[i], 13);
+    log_literal_str(" |");
+    log_ticks_per_call(results[i], results[0]);
+    log_literal_str(" |");
+    log_aligned_dec_u64(dropped_byte_counts[i], 14);
+    log_character('\n');
+  }
+
+  log_character('\n');
+  logs_commit();
+  logs_flush();
+}
+#else
+static void bench_threads_append(void)
+{
+  static const u64 thread_counts[4] = {1, 2, 4, 8};
+  static u64 results[2][4];
+
+  // The console is replaced by /dev/null while measuring
+  // 2: open(path, flags, mode), 3: close(fd)
+  const u32 console_output = logs.outputs[LOGS_OUTPUT_CONSOLE];
+  const s64 dev_null       = bench_syscall3(2, (u64)"/dev/null", 00000001, 0); // O_WRONLY
+  logs.outputs[LOGS_OUTPUT_CONSOLE] = (u32)dev_null;
+
+  for (u64 share_buffer = 0; share_buffer < 2; share_buffer++)
+  {
+    for (u64 i = 0; i < 4; i++)
+    {
+      results[share_buffer][i] = bench_thread_count(thread_counts[i], share_buffer);
+    }
+  }
+
+  bench_syscall3(3, (u64)dev_null, 0, 0);
+  logs.outputs[LOGS_OUTPUT_CONSOLE] = console_output;
+
+  log_literal_str("Messages/s appended by threads flushing to /dev/null every 64 messages\n"
+                  "threads | per-thread buffers | speedup | shared buffer + lock | speedup\n");
+  for (u64 i = 0; i < 4; i++)
+  {
+    log_aligned_dec_u64(thread_counts[i], 7);
+    log_literal_str(" |");
+    log_aligned_dec_u64(results[0][i], 19);
+    log_literal_str(" |");
+    log_ticks_per_call(results[0][i], results[0][0]);
+    log_literal_str(" |");
+    log_aligned_dec_u64(results[1][i], 21);
+    log_literal_str(" |");
+    log_ticks_per_call(results[1][i], results[1][0]);
+    log_character('\n');
+  }
+
+  log_character('\n');
+  logs_flush();
+}
+#endif
+#endif
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//// File output throughput
+#if defined(LOGS_OS_LINUX) && (!defined(LOGS_SHARED_RING) || (LOGS_SHARED_RING == 0)) && \
+    (!defined(LOGS_BINARY) || (LOGS_BINARY == 0)) &&                                     \
+    (!defined(LOGS_DEFERRED_FORMATTING) || (LOGS_DEFERRED_FORMATTING == 0))
+#define BENCH_FILE_NAME        "logs_bench_file.txt"
+#define BENCH_FILE_TOTAL_SIZE  (64 * 1024 * 1024)
+
+// Flush lines of text to a file only, in flushes of 4 KiB to 64 KiB, and measure the throughput of
+// the write syscalls, or of the copies to the mapped file with LOGS_MMAP_FILE. The slowest flush
+// shows the stalls of growing the file, or of rotating it with LOGS_FILE_ROTATION
+static void bench_file_output(void)
+{
+  static char lines[LOGS_BUFFER_SIZE];
+  for (u64 i = 0; i < LOGS_BUFFER_SIZE; i++)
+  {
+    lines[i] = ((i % 64) == 63) ? '\n' : (char)('a' + (random_u64() % 26));
+  }
+
+  static u64 results[3][3];
+  for (u64 size_idx = 0; size_idx < 3; size_idx++)
+  {
+    const u64 flush_size  = 4096ull << (size_idx * 2);
+    const u64 flush_count = BENCH_FILE_TOTAL_SIZE / flush_size;
+    logs_open_file_output(BENCH_FILE_NAME);
+
+    u64 flush_ticks     = 0;
+    u64 max_flush_ticks = 0;
+    u64 start_ns        = read_monotonic_ns();
+    for (u64 flush_idx = 0; flush_idx < flush_count; flush_idx++)
+    {
+      log_sized_utf8_str(lines, flush_size);
+
+      const u64 start = read_tsc();
+      logs_flush_to(LOGS_OUTPUT_FILE);
+      const u64 ticks = read_tsc() - start;
+      flush_ticks     += ticks;
+      max_flush_ticks  = (ticks > max_flush_ticks) ? ticks : max_flush_ticks;
+    }
+
+    logs_close_file_output();
+    const u64 elapsed_ns = read_monotonic_ns() - start_ns;
+    bench_syscall3(87, (u64)BENCH_FILE_NAME, 0, 0); // unlink(path)
+#  if defined(LOGS_FILE_ROTATION) && (LOGS_FILE_ROTATION != 0)
+    static char rotated_file_name[] = BENCH_FILE_NAME ".0";
+    for (char number = '1'; number <= ('0' + LOGS_FILE_ROTATION_FILE_COUNT); number++)
+    {
+      rotated_file_name[sizeof(rotated_file_name) - 2] = number;
+      bench_syscall3(87, (u64)rotated_file_name, 0, 0);
+    }
+#  endif
+
+    results[size_idx][0] = (BENCH_FILE_TOTAL_SIZE * 1000ull) / elapsed_ns; // MB/s
+    results[size_idx][1] = flush_ticks;
+    results[size_idx][2] = max_flush_ticks;
+  }
+
+#  if defined(LOGS_MMAP_FILE) && (LOGS_MMAP_FILE != 0)
+  log_literal_str("64 MiB flushed to a memory-mapped file\n");
+#  elif defined(LOGS_FILE_ROTATION) && (LOGS_FILE_ROTATION != 0)
+  log_literal_str("64 MiB flushed to a file rotated every ");
+  log_dec_u64(LOGS_FILE_ROTATION_SIZE / (1024 * 1024));
+  log_literal_str(" MiB, with write syscalls\n");
+#  else
+  log_literal_str("64 MiB flushed to a file with write syscalls\n");
+#  endif
+  log_literal_str("flush size |     MB/s | ticks/flush | max ticks/flush\n");
+  for (u64 size_idx = 0; size_idx < 3; size_idx++)
+  {
+    const u64 flush_size = 4096ull << (size_idx * 2);
+    log_aligned_dec_u64(flush_size, 10);
+    log_literal_str(" |");
+    log_aligned_dec_u64(results[size_idx][0], 9);
+    log_literal_str(" |  ");
+    log_ticks_per_call(results[size_idx][1], BENCH_FILE_TOTAL_SIZE / flush_size);
+    log_literal_str(" |");
+    log_aligned_dec_u64(results[size_idx][2], 16);
+    log_character('\n');
+  }
+
+  log_character('\n');
+  logs_flush();
+}
+#endif
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//// Zero-copy strings
+#if defined(LOGS_OS_LINUX) && defined(LOGS_ZERO_COPY) && (LOGS_ZERO_COPY != 0)
+#define BENCH_PAYLOAD_MAX_SIZE (32 * 1024)
+
+// Log payloads between 2 lines of text and flush them to /dev/null, copied to the logs buffer or
+// referenced
+static void bench_zero_copy(void)
+{
+  static char payload[BENCH_PAYLOAD_MAX_SIZE];
+  for (u64 i = 0; i < BENCH_PAYLOAD_MAX_SIZE; i++)
+  {
+    payload[i] = 'a' + (char)(random_u64() % 26);
+  }
+
+  // 2: open(path, flags, mode), 3: close(fd)
+  const u32 console_output = logs.outputs[LOGS_OUTPUT_CONSOLE];
+  const s64 dev_null       = bench_syscall3(2, (u64)"/dev/null", 00000001, 0); // O_WRONLY
+  logs.outputs[LOGS_OUTPUT_CONSOLE] = (u32)dev_null;
+
+  static u64 results[4][2];
+  for (u64 size_idx = 0; size_idx < 4; size_idx++)
+  {
+    const u64 payload_size = 512ull << (size_idx * 2);
+    u64 copy_ticks = 0;
+    u64 ref_ticks  = 0;
+    for (u64 round = 0; round < BENCH_ROUND_COUNT; round++)
+    {
+      u64 start = read_tsc();
+      log_literal_str("request body:\n");
+      log_sized_utf8_str(payload, payload_size);
+      log_literal_str("\nend of request body\n");
+      logs_flush();
+      u64 mid = read_tsc();
+      log_literal_str("request body:\n");
+      log_sized_utf8_str_ref(payload, payload_size);
+      log_literal_str("\nend of request body\n");
+      logs_flush();
+      u64 end = read_tsc();
+
+      copy_ticks += mid - start;
+      ref_ticks  += end - mid;
+    }
+
+    results[size_idx][0] = copy_ticks;
+    results[size_idx][1] = ref_ticks;
+  }
+
+  bench_syscall3(3, (u64)dev_null, 0, 0);
+  logs.outputs[LOGS_OUTPUT_CONSOLE] = console_output;
+
+  log_literal_str("Payload logged then flushed to /dev/null, ticks per payload\n"
+                  "bytes |      copy | reference\n");
+  for (u64 size_idx = 0; size_idx < 4; size_idx++)
+  {
+    log_aligned_dec_u64(512ull << (size_idx * 2), 5);
+    log_literal_str(" |");
+    log_aligned_dec_u64(results[size_idx][0] / BENCH_ROUND_COUNT, 10);
+    log_literal_str(" |");
+    log_aligned_dec_u64(results[size_idx][1] / BENCH_ROUND_COUNT, 10);
+    log_character('\n');
+  }
+
+  log_character('\n');
+  logs_flush();
+}
+#endif
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//// Binary logs
+#if defined(LOGS_OS_LINUX) && defined(LOGS_BINARY) && (LOGS_BINARY != 0)
+#define BENCH_BINARY_MESSAGE_COUNT 64
+
+// Log the same messages of 3 values as text and as binary logs, and compare their cost and size.
+// Results are logged with log_binary() too, the output of this build is read with logs_decode:
+//   ./build/logs_bench_binary | ./build/logs_decode
+static void bench_binary(void)
+{
+  static u64 values[BENCH_BINARY_MESSAGE_COUNT];
+
+  u64 text_ticks   = 0;
+  u64 text_bytes   = 0;
+  u64 binary_ticks = 0;
+  u64 binary_bytes = 0;
+  for (u64 round = 0; round < BENCH_ROUND_COUNT; round++)
+  {
+    for (u64 i = 0; i < BENCH_BINARY_MESSAGE_COUNT; i++)
+    {
+      values[i] = random_u64();
+    }
+
+    u64 start = read_tsc();
+    for (u64 i = 0; i < BENCH_BINARY_MESSAGE_COUNT; i++)
+    {
+      log_literal_str("[worker ");
+      log_dec_u64(i);
+      log_literal_str("] value=");
+      log_dec_u64(values[i] >> 24);
+      log_literal_str(" ratio=");
+      log_dec_f64((f64)(values[i] >> 11) * 0x1p-53);
+      log_character('\n');
+    }
+    text_ticks          += read_tsc() - start;
+    text_bytes          += logs.buffer_end_idx;
+    logs.buffer_end_idx  = 0;
+
+    start = read_tsc();
+    for (u64 i = 0; i < BENCH_BINARY_MESSAGE_COUNT; i++)
+    {
+      log_binary("[worker {}] value={} ratio={}\n", i, values[i] >> 24, (f64)(values[i] >> 11) * 0x1p-53);
+    }
+    binary_ticks        += read_tsc() - start;
+    binary_bytes        += logs.buffer_end_idx;
+    logs.buffer_end_idx  = 0;
+  }
+
+  const f64 message_count = BENCH_BINARY_MESSAGE_COUNT * BENCH_ROUND_COUNT;
+  log_binary("Messages of 3 values, as text and as binary logs\n"
+             "format | ticks/message | bytes/message\n");
+  log_binary("text   | {.2} | {.2}\n", (f64)text_ticks / message_count, (f64)text_bytes / message_count);
+  log_binary("binary | {.2} | {.2}\n\n", (f64)binary_ticks / message_count, (f64)binary_bytes / message_count);
+  logs_flush();
+}
+#endif
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//// Deferred formatting
+#if defined(LOGS_OS_LINUX) && defined(LOGS_DEFERRED_FORMATTING) && (LOGS_DEFERRED_FORMATTING != 0)
+#define BENCH_DEFERRED_MESSAGE_COUNT 64
+
+static void append_deferred_messages(const u64* values)
+{
+  for (u64 i = 0; i < BENCH_DEFERRED_MESSAGE_COUNT; i++)
+  {
+    log_literal_str("[worker ");
+    log_dec_u64(i);
+    log_literal_str("] value=");
+    log_dec_u64(values[i] >> 24);
+    log_literal_str(" ratio=");
+    log_dec_f64((f64)(values[i] >> 11) * 0x1p-53);
+    log_character('\n');
+  }
+}
+
+
+// Append messages of 3 values, then flush them to the closed file output, which drops them
+// unformatted, or to the console replaced by /dev/null, which formats them
+static void bench_deferred(void)
+{
+  static u64 values[BENCH_DEFERRED_MESSAGE_COUNT];
+
+  // 2: open(path, flags, mode), 3: close(fd)
+  const u32 console_output = logs.outputs[LOGS_OUTPUT_CONSOLE];
+  const s64 dev_null       = bench_syscall3(2, (u64)"/dev/null", 00000001, 0); // O_WRONLY
+  logs.outputs[LOGS_OUTPUT_CONSOLE] = (u32)dev_null;
+
+  u64 append_ticks          = 0;
+  u64 closed_flush_ticks    = 0;
+  u64 formatted_flush_ticks = 0;
+  for (u64 round = 0; round < BENCH_ROUND_COUNT; round++)
+  {
+    for (u64 i = 0; i < BENCH_DEFERRED_MESSAGE_COUNT; i++)
+    {
+      values[i] = random_u64();
+    }
+
+    u64 start = read_tsc();
+    append_deferred_messages(values);
+    u64 mid = read_tsc();
+    logs_flush_to(LOGS_OUTPUT_FILE);
+    u64 end = read_tsc();
+
+    append_ticks       += mid - start;
+    closed_flush_ticks += end - mid;
+
+    append_deferred_messages(values);
+    start = read_tsc();
+    logs_flush_to(LOGS_OUTPUT_CONSOLE);
+    end = read_tsc();
+
+    formatted_flush_ticks += end - start;
+  }
+
+  bench_syscall3(3, (u64)dev_null, 0, 0);
+  logs.outputs[LOGS_OUTPUT_CONSOLE] = console_output;
+
+  const u64 message_count = BENCH_DEFERRED_MESSAGE_COUNT * BENCH_ROUND_COUNT;
+  log_literal_str("Deferred formatting of messages of 3 values, ticks per message\n"
+                  "append           |");
+  log_ticks_per_call(append_ticks, message_count);
+  log_literal_str("\nflush to closed  |");
+  log_ticks_per_call(closed_flush_ticks, message_count);
+  log_literal_str("\nflush formatted  |");
+  log_ticks_per_call(formatted_flush_ticks, message_count);
+  log_literal_str("\n\n");
+  logs_flush();
+}
+#endif
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//// Log levels
+#if defined(LOGS_OS_LINUX) && (!defined(LOGS_SHARED_RING) || (LOGS_SHARED_RING == 0)) && \
+    (!defined(LOGS_BINARY) || (LOGS_BINARY == 0)) &&                                     \
+    (!defined(LOGS_DEFERRED_FORMATTING) || (LOGS_DEFERRED_FORMATTING == 0)) &&           \
+    (!defined(LOGS_MMAP_FILE) || (LOGS_MMAP_FILE == 0)) &&                               \
+    (!defined(LOGS_FILE_ROTATION) || (LOGS_FILE_ROTATION == 0))
+#define BENCH_LEVELS_MESSAGE_COUNT 64
+
+// Messages of levels LOGS_LEVEL_DEBUG to LOGS_LEVEL_ERROR in turn, in logs_at_level() statements or
+// appended unconditionally
+static void append_level_messages(const u64* values, u64 use_levels)
+{
+  for (u64 i = 0; i < BENCH_LEVELS_MESSAGE_COUNT; i++)
+  {
+    if (use_levels)
+    {
+      logs_at_level(LOGS_LEVEL_DEBUG + (u32)(i % 4))
+      {
+        log_literal_str("[worker ");
+        log_dec_u64(i);
+        log_literal_str("] value=");
+        log_dec_u64(values[i]);
+        log_character('\n');
+      }
+    }
+    else
+    {
+      log_literal_str("[worker ");
+      log_dec_u64(i);
+      log_literal_str("] value=");
+      log_dec_u64(values[i]);
+      log_character('\n');
+    }
+  }
+}
+
+
+// Append messages without statements, in statements of enabled levels and in statements filtered
+// out at run time. The buffer is emptied by flushes to the closed file output. With
+// LOGS_OUTPUT_LEVELS, also flush messages to the console and the file, both replaced by /dev/null,
+// with the same minimum level or with different ones, which routes segments of the buffer
+static void bench_levels(void)
+{
+  static u64 values[BENCH_LEVELS_MESSAGE_COUNT];
+  static u64 ticks[5];
+
+  for (u64 round = 0; round < BENCH_ROUND_COUNT; round++)
+  {
+    for (u64 i = 0; i < BENCH_LEVELS_MESSAGE_COUNT; i++)
+    {
+      values[i] = random_u64() >> 24;
+    }
+
+    for (u64 mode = 0; mode < 3; mode++)
+    {
+      logs_set_level((mode == 2) ? LOGS_LEVEL_OFF : LOGS_LEVEL_TRACE);
+      const u64 start = read_tsc();
+      append_level_messages(values, mode != 0);
+      ticks[mode] += read_tsc() - start;
+      logs_flush_to(LOGS_OUTPUT_FILE);
+    }
+
+#  if defined(LOGS_OUTPUT_LEVELS) && (LOGS_OUTPUT_LEVELS != 0)
+    // 2: open(path, flags, mode), 3: close(fd)
+    const u32 console_output      = logs.outputs[LOGS_OUTPUT_CONSOLE];
+    const s64 dev_null_outputs[2] =
+    {
+      bench_syscall3(2, (u64)"/dev/null", 00000001, 0), // O_WRONLY
+      bench_syscall3(2, (u64)"/dev/null", 00000001, 0)
+    };
+    logs.outputs[LOGS_OUTPUT_CONSOLE] = (u32)dev_null_outputs[0];
+    logs.outputs[LOGS_OUTPUT_FILE]    = (u32)dev_null_outputs[1];
+    for (u64 mode = 3; mode < 5; mode++)
+    {
+      logs_set_level(LOGS_LEVEL_DEBUG);
+      if (mode == 4)
+      {
+        logs_set_output_level(LOGS_OUTPUT_CONSOLE, LOGS_LEVEL_WARN);
+      }
+      append_level_messages(values, 1);
+      const u64 start = read_tsc();
+      logs_flush();
+      ticks[mode] += read_tsc() - start;
+    }
+    bench_syscall3(3, (u64)dev_null_outputs[0], 0, 0);
+    bench_syscall3(3, (u64)dev_null_outputs[1], 0, 0);
+    logs.outputs[LOGS_OUTPUT_CONSOLE] = console_output;
+    logs.outputs[LOGS_OUTPUT_FILE]    = 0;
+#  endif
+  }
+  logs_set_level(LOGS_LEVEL_TRACE);
+
+  const u64 message_count = BENCH_LEVELS_MESSAGE_COUNT * BENCH_ROUND_COUNT;
+  log_literal_str("Messages of 1 value and log levels, ticks per message\n"
+                  "no statement     |");
+  log_ticks_per_call(ticks[0], message_count);
+  log_literal_str("\nlevel enabled    |");
+  log_ticks_per_call(ticks[1], message_count);
+  log_literal_str("\nlevel filtered   |");
+  log_ticks_per_call(ticks[2], message_count);
+#  if defined(LOGS_OUTPUT_LEVELS) && (LOGS_OUTPUT_LEVELS != 0)
+  log_literal_str("\nflush same level |");
+  log_ticks_per_call(ticks[3], message_count);
+  log_literal_str("\nflush routed     |");
+  log_ticks_per_call(ticks[4], message_count);
+#  endif
+  log_literal_str("\n\n");
+  logs_flush();
+}
+#endif
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//// Rate limiting & sampling
+#if defined(LOGS_OS_LINUX) && (!defined(LOGS_SHARED_RING) || (LOGS_SHARED_RING == 0)) && \
+    (!defined(LOGS_BINARY) || (LOGS_BINARY == 0)) &&                                     \
+    (!defined(LOGS_DEFERRED_FORMATTING) || (LOGS_DEFERRED_FORMATTING == 0)) &&           \
+    (!defined(LOGS_MMAP_FILE) || (LOGS_MMAP_FILE == 0)) &&                               \
+    (!defined(LOGS_FILE_ROTATION) || (LOGS_FILE_ROTATION == 0))
+// Append a message from a site without limit, from a rate-limited site of 1 message per second,
+// which suppresses all of them but the first, and from a site sampling 1 in 64 of them. The buffer
+// is emptied by flushes to the closed file output
+static void bench_rate_limits(void)
+{
+  static u64 values[BENCH_VALUE_COUNT];
+  static u64 ticks[3];
+
+  for (u64 round = 0; round < BENCH_ROUND_COUNT; round++)
+  {
+    for (u64 i = 0; i < BENCH_VALUE_COUNT; i++)
+    {
+      values[i] = random_u64() >> 24;
+    }
+
+    u64 start = read_tsc();
+    for (u64 i = 0; i < BENCH_VALUE_COUNT; i++)
+    {
+      log_literal_str("retrying, value=");
+      log_dec_u64(values[i]);
+      log_character('\n');
+    }
+    u64 end = read_tsc();
+    ticks[0] += end - start;
+    logs_flush_to(LOGS_OUTPUT_FILE);
+
+    start = read_tsc();
+    for (u64 i = 0; i < BENCH_VALUE_COUNT; i++)
+    {
+      logs_rate_limited(1, 1, log_literal_str("retrying, value=");
+                              log_dec_u64(values[i]);
+                              log_character('\n'));
+    }
+    end = read_tsc();
+    ticks[1] += end - start;
+    logs_flush_to(LOGS_OUTPUT_FILE);
+
+    start = read_tsc();
+    for (u64 i = 0; i < BENCH_VALUE_COUNT; i++)
+    {
+      logs_sampled(64, log_literal_str("retrying, value=");
+                       log_dec_u64(values[i]);
+                       log_character('\n'));
+    }
+    end = read_tsc();
+    ticks[2] += end - start;
+    logs_flush_to(LOGS_OUTPUT_FILE);
+  }
+
+  const u64 message_count = BENCH_VALUE_COUNT * BENCH_ROUND_COUNT;
+  log_literal_str("Messages of 1 value and call site limits, ticks per message\n"
+                  "no limit         |");
+  log_ticks_per_call(ticks[0], message_count);
+  log_literal_str("\nrate limited     |");
+  log_ticks_per_call(ticks[1], message_count);
+  log_literal_str("\nsampled 1 in 64  |");
+  log_ticks_per_call(ticks[2], message_count);
+  log_literal_str("\n\n");
+  logs_flush();
+}
+#endif
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//// Entry point
+void run_benchmarks(void)
+{
+#if defined(LOGS_OS_LINUX) && defined(LOGS_PER_THREAD) && (LOGS_PER_THREAD != 0)
+  static logs_thread main_thread_logs;
+  logs_attach_thread(&main_thread_logs);
+#endif
+
+  logs_open_console_output();
+
+#if defined(LOGS_OS_LINUX) && defined(LOGS_SHARED_RING) && (LOGS_SHARED_RING != 0)
+  bench_ring_append();
+#elif defined(LOGS_OS_LINUX) && defined(LOGS_BINARY) && (LOGS_BINARY != 0)
+  bench_binary();
+#elif defined(LOGS_OS_LINUX) && defined(LOGS_DEFERRED_FORMATTING) && (LOGS_DEFERRED_FORMATTING != 0)
+  bench_deferred();
+#elif defined(LOGS_OS_LINUX) && ((defined(LOGS_MMAP_FILE) && (LOGS_MMAP_FILE != 0)) || \
+                                 (defined(LOGS_FILE_ROTATION) && (LOGS_FILE_ROTATION != 0)))
+  bench_file_output();
+#else
+  bench_dec_u64();
+  bench_dec_float();
+  bench_utf8_str();
+  bench_utf16_str();
+#  if defined(LOGS_OS_LINUX)
+  bench_timestamps();
+#  endif
+  bench_line_prefixes();
+#  if defined(LOGS_OS_LINUX)
+  bench_levels();
+  bench_rate_limits();
+#  endif
+#  if defined(LOGS_OS_LINUX) && defined(LOGS_IO_URING) && (LOGS_IO_URING != 0)
+  bench_flush();
+#  endif
+#  if defined(LOGS_OS_LINUX) && defined(LOGS_ZERO_COPY) && (LOGS_ZERO_COPY != 0)
+  bench_zero_copy();
+#  endif
+#  if defined(LOGS_OS_LINUX)
+  bench_file_output();
+#  endif
+#  if defined(LOGS_OS_LINUX) && defined(LOGS_PER_THREAD) && (LOGS_PER_THREAD != 0)
+  bench_threads_append();
+#  endif
+#endif
+
+  logs_close_console_output();
+}
+
+
+#if defined(LOGS_OS_WINDOWS)
+  extern void ExitProcess(u32);
+  s32 _fltused;
+
+  void mainCRTStartup(void)
+  {
+    run_benchmarks();
+    ExitProcess(0);
+  }
+  #elif defined(LOGS_OS_LINUX)
+  void _start(void)
+  {
+    run_benchmarks();
+    // exit_group, which also ends the threads the logs may have started
+    __asm__ ("syscall" : : "a"(231), "D"(0));
+  }
+#endif
@@ -34,9 +34,11 @@ set LINK_FLAGS=/link                   ^
                /nodefaultlib           ^
                /opt:ref                ^
                /incremental:no         ^
-               /fixed                  ^
-               /out:%BUILD_DIR%\%EXE_OUTPUT%
+               /fixed
 set SOURCES=logs.c example.c
+set BENCH_EXE_OUTPUT=logs_bench.exe
+set BENCH_SOURCES=logs.c benchmark.c
+set BENCH_COMP_FLAGS=/DLOGS_BUFFER_SIZE=65536
 set LIBRARIES=kernel32.lib
 
 pushd %~dp0
@@ -59,10 +61,27 @@ popd
     mkdir %OBJS_DIR%
   )
 
-  call cl.exe %COMP_FLAGS% %SOURCES% %LINK_FLAGS% %LIBRARIES%
+  call cl.exe %COMP_FLAGS% %SOURCES% %LINK_FLAGS% /out:%BUILD_DIR%\%EXE_OUTPUT% %LIBRARIES%
   echo Done.
   goto :eof
 
+:arg_bench
+  if "%VSCMD_VER%"=="" (
+    call :initialize_env
+  )
+
+  if not exist %BUILD_DIR% (
+    mkdir %BUILD_DIR%
+  )
+
+  if not exist %OBJS_DIR% (
+    mkdir %OBJS_DIR%
+  )
+
+  call cl.exe %COMP_FLAGS% %BENCH_COMP_FLAGS% %BENCH_SOURCES% %LINK_FLAGS% /out:%BUILD_DIR%\%BENCH_EXE_OUTPUT% %LIBRARIES%
+  call %BUILD_DIR%\%BENCH_EXE_OUTPUT%
+  goto :eof
+
 :arg_run
   call %BUILD_DIR%\%EXE_OUTPUT% %2 %3 %4 %5 %6 %7 %8 %9
   goto :eof
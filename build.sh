@@ -8,6 +8,7 @@ comp_flags="-DLOGS_ENABLED=1
             -fno-stack-protector
             -mbmi2
             -mlzcnt
+            -mssse3
             -O2
             -pedantic
             -std=c11
@@ -22,6 +23,30 @@ link_flags="-flto
             -Wl,--build-id=none
             -Wl,-n"
 sources="logs.c example.c"
+async_exe_name=logs_async
+async_comp_flags="-DLOGS_ASYNC_FLUSH=1"
+bench_exe_name=logs_bench
+bench_comp_flags="-DLOGS_BUFFER_SIZE=65536 -DLOGS_IO_URING=1 -DLOGS_ZERO_COPY=1"
+bench_sources="logs.c benchmark.c"
+bench_threads_exe_name=logs_bench_threads
+bench_threads_comp_flags="-DLOGS_BUFFER_SIZE=65536 -DLOGS_PER_THREAD=1"
+bench_ring_exe_name=logs_bench_ring
+bench_ring_comp_flags="-DLOGS_BUFFER_SIZE=65536 -DLOGS_PER_THREAD=1 -DLOGS_SHARED_RING=1"
+bench_per_cpu_exe_name=logs_bench_per_cpu
+bench_per_cpu_comp_flags="-DLOGS_BUFFER_SIZE=65536 -DLOGS_PER_THREAD=1 -DLOGS_SHARED_RING=1 -DLOGS_PER_CPU=1"
+bench_binary_exe_name=logs_bench_binary
+bench_binary_comp_flags="-DLOGS_BUFFER_SIZE=65536 -DLOGS_BINARY=1"
+bench_deferred_exe_name=logs_bench_deferred
+bench_deferred_comp_flags="-DLOGS_BUFFER_SIZE=65536 -DLOGS_DEFERRED_FORMATTING=1"
+bench_mmap_exe_name=logs_bench_mmap
+bench_mmap_comp_flags="-DLOGS_BUFFER_SIZE=65536 -DLOGS_MMAP_FILE=1"
+bench_rotation_exe_name=logs_bench_rotation
+bench_rotation_comp_flags="-DLOGS_BUFFER_SIZE=65536 -DLOGS_FILE_ROTATION=1 -DLOGS_FILE_ROTATION_SIZE=8388608"
+bench_levels_exe_name=logs_bench_levels
+bench_levels_comp_flags="-DLOGS_BUFFER_SIZE=65536 -DLOGS_OUTPUT_LEVELS=1"
+decode_exe_name=logs_decode
+decode_comp_flags="-DLOGS_AUTO_FLUSH=1"
+decode_sources="logs.c logs_decode.c"
 
 for arg in "$@"; do declare $arg=1; done
 
@@ -34,6 +59,44 @@ then
     ./$0
   fi
   ./$project_dir/$build_dir/$exe_name
+elif [ -v async ];
+then
+  pushd $project_dir >/dev/null
+    mkdir -p $build_dir
+    $compiler $comp_flags $async_comp_flags $link_flags $sources -o $build_dir/$async_exe_name && \
+    ./$build_dir/$async_exe_name
+  popd >/dev/null
+elif [ -v bench ];
+then
+  pushd $project_dir >/dev/null
+    mkdir -p $build_dir
+    $compiler $comp_flags $bench_comp_flags $link_flags $bench_sources -o $build_dir/$bench_exe_name && \
+    $compiler $comp_flags $bench_threads_comp_flags $link_flags $bench_sources -o $build_dir/$bench_threads_exe_name && \
+    $compiler $comp_flags $bench_ring_comp_flags $link_flags $bench_sources -o $build_dir/$bench_ring_exe_name && \
+    $compiler $comp_flags $bench_per_cpu_comp_flags $link_flags $bench_sources -o $build_dir/$bench_per_cpu_exe_name && \
+    $compiler $comp_flags $bench_binary_comp_flags $link_flags $bench_sources -o $build_dir/$bench_binary_exe_name && \
+    $compiler $comp_flags $bench_deferred_comp_flags $link_flags $bench_sources -o $build_dir/$bench_deferred_exe_name && \
+    $compiler $comp_flags $bench_mmap_comp_flags $link_flags $bench_sources -o $build_dir/$bench_mmap_exe_name && \
+    $compiler $comp_flags $bench_rotation_comp_flags $link_flags $bench_sources -o $build_dir/$bench_rotation_exe_name && \
+    $compiler $comp_flags $bench_levels_comp_flags $link_flags $bench_sources -o $build_dir/$bench_levels_exe_name && \
+    $compiler $comp_flags $decode_comp_flags $link_flags $decode_sources -o $build_dir/$decode_exe_name && \
+    ./$build_dir/$bench_exe_name && \
+    ./$build_dir/$bench_threads_exe_name && \
+    ./$build_dir/$bench_ring_exe_name && \
+    ./$build_dir/$bench_per_cpu_exe_name && \
+    ./$build_dir/$bench_binary_exe_name | ./$build_dir/$decode_exe_name && \
+    ./$build_dir/$bench_deferred_exe_name && \
+    ./$build_dir/$bench_mmap_exe_name && \
+    ./$build_dir/$bench_rotation_exe_name && \
+    ./$build_dir/$bench_levels_exe_name
+  popd >/dev/null
+elif [ -v decode ];
+then
+  pushd $project_dir >/dev/null
+    mkdir -p $build_dir
+    $compiler $comp_flags $decode_comp_flags $link_flags $decode_sources -o $build_dir/$decode_exe_name && \
+    echo Executable successfully created: $build_dir/$decode_exe_name
+  popd >/dev/null
 elif [ -v clean ];
 then
   if [ -d $project_dir/$build_dir ];
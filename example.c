@@ -2,13 +2,19 @@
 // - With MSVC on Windows (inside a x64 Native Tools Command Prompt for VS):
 //   cl.exe /nologo /DLOGS_ENABLED /std:c11 /utf-8 logs.c example.c /link /entry:mainCRTStartup /nodefaultlib /subsystem:console kernel32.lib
 // - With GCC:
-//   gcc -DLOGS_ENABLED -fno-builtin -fno-stack-protector -mbmi2 -mlzcnt -nostdlib logs.c example.c
+//   gcc -DLOGS_ENABLED -fno-builtin -fno-stack-protector -mbmi2 -mlzcnt -mssse3 -nostdlib logs.c example.c
 // - With clang:
-//   clang -DLOGS_ENABLED -fno-builtin -fno-stack-protector -mbmi2 -mlzcnt -nostdlib logs.c example.c
+//   clang -DLOGS_ENABLED -fno-builtin -fno-stack-protector -mbmi2 -mlzcnt -mssse3 -nostdlib logs.c example.c
 #include "logs.h"
 
 void run_example(void)
 {
+#if defined(LOGS_OS_LINUX) && defined(LOGS_PER_THREAD) && (LOGS_PER_THREAD != 0)
+  // Each thread logs to its own buffer, registered before any other call
+  static logs_thread main_thread_logs;
+  logs_attach_thread(&main_thread_logs);
+#endif
+
   const os_utf_char* const logs_file_name = OS_UTF_STR("Fluß_¼½¾_Öçé_ǅ.txt");
   logs_open_console_output();
   logs_open_file_output(logs_file_name);
@@ -59,6 +65,7 @@ void run_example(void)
   void _start(void)
   {
     run_example();
-    __asm__ ("syscall" : : "a"(60), "D"(0));
+    // exit_group, which also ends the threads the logs may have started
+    __asm__ ("syscall" : : "a"(231), "D"(0));
   }
 #endif
\ No newline at end of file
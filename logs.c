@@ -1,1177 +1,6210 @@
-#if defined(LOGS_ENABLED) && (LOGS_ENABLED != 0)
-#include "logs.h"
-
-#if defined(LOGS_OS_WINDOWS)
-#  define _WIN32_WINNT 0x0501 // ATTACH_PARENT_PROCESS
-#  include <Windows.h>
-#elif defined(LOGS_OS_LINUX)
-// #  include "linux_logs_syscalls.h"
-#  define STDOUT_FD 1
-#endif
-
-
-///////////////////////////////////////////////////////////////////////////////////////////////////
-///////////////////////////////////////////////////////////////////////////////////////////////////
-//// Helpers
-static inline u32 open_file_output_ascii(const char* file_path)
-{
-#if defined(LOGS_OS_WINDOWS)
-  const u32 SHARE_RDWR = FILE_SHARE_READ | FILE_SHARE_WRITE;
-  HANDLE output = CreateFileA(file_path,        // lpFileName
-                              FILE_APPEND_DATA, // dwDesiredAccess
-                              SHARE_RDWR,       // dwShareMode
-                              0,                // lpSecurityAttributes
-                              OPEN_ALWAYS,      // dwCreationDisposition
-                              0,                // dwFlagsAndAttributes
-                              0);               // hTemplateFile
-  return (u32)(u64)output;
-#elif defined(LOGS_OS_LINUX)
-  // TODO: O_ASYNC?
-  #define O_RDWR	          00000002
-  #define O_CREAT           00000100
-  #define O_APPEND          00002000
-  #define CREAT_PERMISSIONS 00000775
-  
-  const u64 flags = O_RDWR | O_CREAT | O_APPEND; 
-  register u64         open_syscall_rax __asm__("rax") = 2;
-  register const char* file_path_rdi    __asm__("rdi") = file_path;
-  register u64         flags_rsi        __asm__("rsi") = flags;
-  register u64         mode_rdx         __asm__("rdx") = CREAT_PERMISSIONS;
-  s64 output;
-  __asm__ __volatile__ ("syscall" :
-                        "=a"(output) :
-                        "r"(open_syscall_rax), "r"(file_path_rdi), "r"(flags_rsi), "r"(mode_rdx) :
-                        "rcx", "r11", "memory");
-  return (u32)(s32)output;
-#endif
-}
-
-static inline void write_to_output(u32 output, const u8* data, u64 data_size)
-{
-#if defined(LOGS_OS_WINDOWS)
-  HANDLE handle = (HANDLE)(u64)output;
-  WriteFile(handle, data, (u32)data_size, 0, 0);
-#elif defined(LOGS_OS_LINUX)
-  register u64       write_syscall_rax __asm__("rax") = 1;
-  register u32       output_rdi        __asm__("rdi") = output;
-  register const u8* data_rsi          __asm__("rsi") = data;
-  register u64       data_size_rdx     __asm__("rdx") = data_size;
-  __asm__ __volatile__ ("syscall" : :
-                        "r"(write_syscall_rax), "r"(output_rdi), "r"(data_rsi), "r"(data_size_rdx) :
-                        "rcx", "r11", "memory");
-#endif
-}
-
-
-static inline void logs_close_output(logs_output_idx output_idx)
-{
-#if defined(LOGS_OS_WINDOWS)
-  u32 output = logs.outputs[output_idx];
-  CloseHandle((HANDLE)(u64)output);
-#elif defined(LOGS_OS_LINUX)
-  register u64 close_syscall_rax __asm__("rax") = 3;
-  register u64 output_rdi        __asm__("rdi") = logs.outputs[output_idx];
-  __asm__ __volatile__ ("syscall" : :
-                        "r"(close_syscall_rax), "r"(output_rdi) :
-                        "rcx", "r11", "memory");
-#endif
-
-  logs.outputs[output_idx] = 0;
-}
-
-
-
-
-///////////////////////////////////////////////////////////////////////////////////////////////////
-///////////////////////////////////////////////////////////////////////////////////////////////////
-//// Global
-struct logs logs =
-{
-  .buffer = {0},
-  .outputs =
-  {
-#if defined(LOGS_OS_LINUX)
-    // stdout is opened by default
-    [LOGS_OUTPUT_CONSOLE] = STDOUT_FD,
-#else
-    [LOGS_OUTPUT_CONSOLE] = 0,
-#endif
-    [LOGS_OUTPUT_FILE]    = 0
-  },
-  .buffer_end_idx = 0
-};
-
-
-
-
-///////////////////////////////////////////////////////////////////////////////////////////////////
-///////////////////////////////////////////////////////////////////////////////////////////////////
-//// Output management
-// Console output
-void logs_open_console_output(void)
-{
-  if (logs.outputs[LOGS_OUTPUT_CONSOLE] == 0)
-  {
-#if defined(LOGS_OS_WINDOWS)
-    const BOOL success    = AttachConsole(ATTACH_PARENT_PROCESS);
-    const u32  last_error = GetLastError();
-    if ((success == 0) && (last_error != ERROR_ACCESS_DENIED))
-    {
-      // There is no console to borrow, or something went wrong. Create a new console
-      AllocConsole();
-      SetConsoleTitleA("Logs");
-
-      logs.console_original_output_code_page = 0;
-    }
-    else
-    {
-      // An existing console is attached
-      logs.console_original_output_code_page = GetConsoleOutputCP();
-    }
-
-    SetConsoleOutputCP(CP_UTF8);
-
-    const u32 SHARE_MODE = FILE_SHARE_READ | FILE_SHARE_WRITE;
-    HANDLE output = CreateFileA("\\\\?\\CONOUT$", // lpFileName
-                                GENERIC_WRITE,    // dwDesiredAccess
-                                SHARE_MODE,       // dwShareMode
-                                0,                // lpSecurityAttributes
-                                OPEN_EXISTING,    // dwCreationDisposition
-                                0,                // dwFlagsAndAttributes
-                                0);               // hTemplateFile
-    logs.outputs[LOGS_OUTPUT_CONSOLE] = (u32)(u64)output;
-
-#elif defined(LOGS_OS_LINUX)
-    // Since stdout is not opened nor handled by this process, its file descriptor is set and unset
-    // to indicate whether it should be used or not, but it is otherwise left opened and never
-    // closed nor re-opened
-    logs.outputs[LOGS_OUTPUT_CONSOLE] = STDOUT_FD;
-#endif
-  }
-}
-
-
-// NOTE (Sami): this breaks Windows Terminal (the default Windows 11 console)
-void logs_close_console_output(void)
-{
-  if (logs.outputs[LOGS_OUTPUT_CONSOLE] != 0)
-  {
-#if defined(LOGS_OS_WINDOWS)
-    logs_close_output(LOGS_OUTPUT_CONSOLE);
-    if (logs.console_original_output_code_page != 0)
-    {
-      SetConsoleOutputCP(logs.console_original_output_code_page);
-    }
-    
-    // Free the console of this process
-    FreeConsole();
-#elif defined(LOGS_OS_LINUX)
-    // stdout file descriptor is removed to indicate it should not be used, but it is never closed
-    logs.outputs[LOGS_OUTPUT_CONSOLE] = 0;
-#endif
-  }
-}
-
-
-// File output
-void logs_open_file_output_ascii(const char* file_path)
-{
-  if (logs.outputs[LOGS_OUTPUT_FILE] == 0)
-  {
-    u32 output = open_file_output_ascii(file_path);
-    logs.outputs[LOGS_OUTPUT_FILE] = output;
-  }
-}
-
-
-void logs_open_file_output_utf16(const char16* file_path)
-{
-  if (logs.outputs[LOGS_OUTPUT_FILE] == 0)
-  {
-#if defined(LOGS_OS_WINDOWS)
-    const u32 SHARE_MODE = FILE_SHARE_READ | FILE_SHARE_WRITE;
-    HANDLE output = CreateFileW(file_path,        // lpFileName
-                                FILE_APPEND_DATA, // dwDesiredAccess
-                                SHARE_MODE,       // dwShareMode
-                                0,                // lpSecurityAttributes
-                                OPEN_ALWAYS,      // dwCreationDisposition
-                                0,                // dwFlagsAndAttributes
-                                0);               // hTemplateFile
-    logs.outputs[LOGS_OUTPUT_FILE] = (u32)(u64)output;
-#elif defined(LOGS_OS_LINUX)
-    u32 output = open_file_output_ascii((char*)file_path);
-    logs.outputs[LOGS_OUTPUT_FILE] = output;
-#endif
-  }
-}
-
-
-void logs_close_file_output(void)
-{
-  if (logs.outputs[LOGS_OUTPUT_FILE] != 0)
-  {
-    logs_close_output(LOGS_OUTPUT_FILE);
-  }
-}
-
-
-// All outputs
-void logs_flush(void)
-{
-  // Trust that the caller knows the log buffer is not empty
-  for (u64 i = 0; i < LOGS_OUTPUT_COUNT; i++)
-  {
-    u32 output = logs.outputs[i];
-    if (output != 0)
-    {
-      write_to_output(output, logs.buffer, logs.buffer_end_idx);
-    }
-  }
-
-  logs.buffer_end_idx = 0;
-}
-
-
-void logs_flush_to(logs_output_idx output_idx)
-{
-  u32 output = logs.outputs[output_idx];
-  if (output != 0)
-  {
-    write_to_output(output, logs.buffer, logs.buffer_end_idx);
-  }
-
-  logs.buffer_end_idx = 0;
-}
-
-
-
-
-///////////////////////////////////////////////////////////////////////////////////////////////////
-//// Memory
-u64 logs_buffer_remaining_bytes(void)
-{
-  s64 difference      = LOGS_BUFFER_SIZE - logs.buffer_end_idx;
-  u64 remaining_bytes = (difference > 0ll) ? difference : 0ll;
-
-  return remaining_bytes;
-}
-
-
-
-
-///////////////////////////////////////////////////////////////////////////////////////////////////
-//// Characters & strings logging
-void log_utf8_character(char character)
-{
-  logs.buffer[logs.buffer_end_idx] = character;
-  logs.buffer_end_idx += 1;
-}
-
-
-void log_utf16_character(char16 character)
-{
-  log_sized_utf16_str(&character, 1);
-}
-
-
-void log_sized_utf8_str(const char* str, u64 char_count)
-{
-  char* dest_u8 = (char*)(logs.buffer + logs.buffer_end_idx);
-
-  const u64         u8_x8_count = char_count & ~7;
-  const char* const str_x8_end  = str + u8_x8_count;
-  const char* const str_end     = str + char_count;
-
-  while (str < str_x8_end)
-  {
-    *(u64*)dest_u8 = *(u64*)str;
-
-    dest_u8 += 8;
-    str  += 8;
-  }
-
-  while (str < str_end)
-  {
-    *dest_u8 = *str;
-    dest_u8 += 1;
-    str  += 1;
-  }
-
-  logs.buffer_end_idx += char_count;
-}
-
-
-void log_sized_utf16_str(const char16* str, u64 char16_count)
-{
-  u8* dest = logs.buffer + logs.buffer_end_idx;
-  while (char16_count != 0)
-  {
-    u32 unicode;
-    u64 char16_read        = utf16_code_point_to_unicode(str, &unicode);
-    u64 written_byte_count = unicode_to_utf8_code_point(unicode, dest);
-    
-    char16_count -= char16_read;
-    str          += char16_read;
-    dest         += written_byte_count;
-  }
-
-  logs.buffer_end_idx = dest - logs.buffer;
-}
-
-
-void log_null_terminated_utf8_str(const char* str)
-{
-  char character = *str;
-  while (character != '\0')
-  {
-    logs.buffer[logs.buffer_end_idx] = character;
-    logs.buffer_end_idx += 1;
-    
-    str       += 1;
-    character = *str;
-  }
-}
-
-
-void log_null_terminated_utf16_str(const char16* str)
-{
-  u8* dest = logs.buffer + logs.buffer_end_idx;
-  while (*str != u'\0')
-  {
-    u32 unicode;
-    u64 char16_read      = utf16_code_point_to_unicode(str, &unicode);
-    u64 written_u8_count = unicode_to_utf8_code_point(unicode, dest);
-    
-    str  += char16_read;
-    dest += written_u8_count;
-  }
-
-  logs.buffer_end_idx = dest - logs.buffer;
-}
-
-
-
-
-///////////////////////////////////////////////////////////////////////////////////////////////////
-//// Non-alphanumeric types logging
-static const char* bool_str = "truefalse";
-
-void log_bool(u64 boolean)
-{
-  const u64 is_false = (boolean == 0);
-  const u64 offset   = is_false << 2; // 4 if (boolean == 0), 0 otherwise
-
-  // Starts either at the 't' of "true" or the 'f' of "false"
-  const char* bool_str_start = bool_str + offset;
-
-  // length("true") = 4, length("false") = 5, is_false = 0 or 1
-  const u64 char_count  = 4 + is_false;   
-  log_sized_utf8_str(bool_str_start, char_count);
-}
-
-
-
-
-///////////////////////////////////////////////////////////////////////////////////////////////////
-//// Compounds logging
-static const u64 unit_multipliers[] =
-{
-  1ull, // no unit multiplier
-  1000ull, // Kilo (K)
-  1000000ull, // Mega (M)
-  1000000000ull, // Giga (G)
-  1000000000000ull, // Tera (T)
-  1000000000000000ull, // Peta (P)
-  1000000000000000000ull // Exa (E)
-};
-
-static const char unit_prefixes[7] = {0, 'K', 'M', 'G', 'T', 'P', 'E'};
-
-void log_byte_count_dec_unit(u64 byte_count)
-{
-  // Log the integer part
-  const u64 digit_count          = u64_digit_count(byte_count); // in [1; 20]
-  const u64 unit_idx             = (digit_count - 1) / 3; // in [0; 6]
-  const u64 unit_mul             = unit_multipliers[unit_idx];
-  const u64 int_byte_count       = byte_count / unit_mul; // has 1 to 3 digits
-  const u64 int_byte_digit_count = digit_count - (unit_idx * 3);
-
-  log_sized_dec_u64(int_byte_count, int_byte_digit_count);
-
-  // Log the fractional part (if necessary)
-  const u32 byte_count_ge_1000 = byte_count >= 1000;
-  if (byte_count_ge_1000)
-  {
-    const u64 byte_count_remainder = byte_count - (int_byte_count * unit_mul);
-    const u64 frac_byte_count      = (BYTE_COUNT_FRAC_DIV * byte_count_remainder) / unit_mul;
-    log_character('.');
-    log_sized_dec_u64(frac_byte_count, BYTE_COUNT_FRAC_SIZE);
-  }
-
-  // Log the unit prefix and the unit itself
-  // ' ' [+ unit prefix] + 'B' = 2 mandatory + 1 optional characters
-  u8* const dest              = logs.buffer + logs.buffer_end_idx;
-  const u64 b_char_idx        = 1 + byte_count_ge_1000;
-  const u64 suffix_char_count = 2 + byte_count_ge_1000;
-
-  dest[0]          = ' ';
-  dest[1]          = unit_prefixes[unit_idx]; // overwritten if unnecessary
-  dest[b_char_idx] = 'B';
-
-  logs.buffer_end_idx += suffix_char_count;
-}
-
-
-void log_byte_count_bin_unit(u64 byte_count)
-{
-  // Log the integer part
-  const u64 msb_idx        = get_msb_1_bit_idx_u64(byte_count);
-  const u64 prefix_idx     = msb_idx / 10;
-  const u8  mul_shift      = (u8)(prefix_idx * 10);
-  const u32 int_byte_count = (u32)(byte_count >> mul_shift);
-  log_dec_u32(int_byte_count);
-
-  // Log the fractional part (if necessary)
-  const u32 byte_count_ge_1024 = byte_count >= 1024;
-  if (byte_count_ge_1024)
-  {
-    const u64 byte_count_remainder = byte_count - (int_byte_count << mul_shift);
-    const u64 unit_mul             = 1ull << mul_shift;
-    const u64 frac_byte_count      = (BYTE_COUNT_FRAC_DIV * byte_count_remainder) / unit_mul;
-    log_character('.');
-    log_sized_dec_u64(frac_byte_count, BYTE_COUNT_FRAC_SIZE);
-  }
-
-  // Log the unit prefix and the unit itself
-  // ' ' [+ unit prefix + 'i'] + 'B' = 2 mandatory + 2 optional characters
-  u8* const dest              = logs.buffer + logs.buffer_end_idx;
-  const u64 b_char_offset     = byte_count_ge_1024 * 2;
-  const u64 suffix_char_count = 2 + b_char_offset;
-  const u64 i_char_idx        = 1 + byte_count_ge_1024;
-  const u64 b_char_idx        = 1 + b_char_offset;
-
-  dest[0]          = ' ';
-  dest[1]          = unit_prefixes[prefix_idx]; // overwritten if unnecessary
-  dest[i_char_idx] = 'i'; // overwritten if unnecessary
-  dest[b_char_idx] = 'B';
-
-  logs.buffer_end_idx += suffix_char_count;
-}
-
-
-void log_os_api_error(u32 error_code)
-{
-#if defined(LOGS_OS_WINDOWS)
-  const DWORD flags = FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS;
-
-  // Can be obtained either from winnt.h, or through "Windows Language Code Identifier (LCID)
-  // Reference", version 16.0 (23rd April 2024), page 14:
-  // https://winprotocoldoc.z19.web.core.windows.net/MS-LCID/[MS-LCID].pdf#page=14
-  const WORD en_us_lang_id = 0x0409;
-
-  // None of the functions appending content to the logs buffer make sure there is enough space to
-  // write to. Lie about the available space in the logs buffer to remain consistent
-  const DWORD max_bytes = 64000; // maximum allowed by FormatMessage()
-
-  log_literal_str("Windows API error ");
-  log_dec_u32(error_code);
-  log_literal_str(": ");
-
-  char* dest = (char*)(logs.buffer + logs.buffer_end_idx);
-
-  DWORD char_written = FormatMessageA(flags,         // dwFlags
-                                      0,             // lpSource
-                                      error_code,    // dwMessageId
-                                      en_us_lang_id, // dwLanguageId
-                                      dest,          // lpBuffer
-                                      max_bytes,     // nSize
-                                      0);            // Arguments
-  if (char_written == 0)
-  {
-    // Something went wrong, fallback
-    log_literal_str("couldn't get error description)");
-  }
-  else
-  {
-    // Messages finish with a carriage return + linefeed. Both are removed
-    logs.buffer_end_idx += char_written - 2;
-  }
-#elif defined(LOGS_OS_LINUX)
-#  include "linux_errno_to_str.inl"
-  const char* error_str = linux_errno_to_str[error_code];
-  log_literal_str("Linux API error ");
-  log_dec_u32(error_code);
-  log_literal_str(": ");
-  log_null_terminated_ascii_str(error_str);
-#endif
-}
-
-
-
-
-///////////////////////////////////////////////////////////////////////////////////////////////////
-///////////////////////////////////////////////////////////////////////////////////////////////////
-//// Numbers logging
-// Binary
-void log_sized_bin_s8 (s8  num, u64 bit_to_write_count) { log_sized_bin_u64((u64)num, bit_to_write_count); }
-void log_sized_bin_s16(s16 num, u64 bit_to_write_count) { log_sized_bin_u64((u64)num, bit_to_write_count); }
-void log_sized_bin_s32(s32 num, u64 bit_to_write_count) { log_sized_bin_u64((u64)num, bit_to_write_count); }
-void log_sized_bin_s64(s64 num, u64 bit_to_write_count) { log_sized_bin_u64((u64)num, bit_to_write_count); }
-void log_sized_bin_u8 (u8  num, u64 bit_to_write_count) { log_sized_bin_u64(num,      bit_to_write_count); }
-void log_sized_bin_u16(u16 num, u64 bit_to_write_count) { log_sized_bin_u64(num,      bit_to_write_count); }
-void log_sized_bin_u32(u32 num, u64 bit_to_write_count) { log_sized_bin_u64(num,      bit_to_write_count); }
-
-
-void log_sized_bin_u64(u64 num, u64 bit_to_write_count)
-{
-  u8* const num_str_start = logs.buffer + logs.buffer_end_idx;
-  u8*       dest          = num_str_start + bit_to_write_count;
-  while (dest > num_str_start)
-  {
-    u8 bit = num & 1;
-    
-    dest -= 1;
-    *dest = '0' + bit;
-    
-    num >>= 1;
-  }
-
-  logs.buffer_end_idx += bit_to_write_count;
-}
-
-
-void log_sized_bin_f32(f32 num, u64 bit_to_write_count) { log_sized_bin_u64(*(u32*)(&num), bit_to_write_count); }
-
-
-void log_bin_s8 (s8  num) { log_sized_bin_u64((u64)num,      u32_bit_count((u32)num));    }
-void log_bin_s16(s16 num) { log_sized_bin_u64((u64)num,      u32_bit_count((u32)num));    }
-void log_bin_s32(s32 num) { log_sized_bin_u64((u64)num,      u32_bit_count((u32)num));    }
-void log_bin_s64(s64 num) { log_sized_bin_u64((u64)num,      u64_bit_count((u64)num));    }
-void log_bin_u8 (u8  num) { log_sized_bin_u64(num,           u32_bit_count(num));         }
-void log_bin_u16(u16 num) { log_sized_bin_u64(num,           u32_bit_count(num));         }
-void log_bin_u32(u32 num) { log_sized_bin_u64(num,           u32_bit_count(num));         }
-void log_bin_u64(u64 num) { log_sized_bin_u64(num,           u64_bit_count(num));         }
-void log_bin_f32(f32 num) { log_sized_bin_u64(*(u32*)(&num), u32_bit_count(*(u32*)&num)); }
-
-
-// Decimal number logging
-void log_sized_dec_s8 (s8  num, u64 digit_to_write_count) { log_sized_dec_u64((u64)num, digit_to_write_count); }
-void log_sized_dec_s16(s16 num, u64 digit_to_write_count) { log_sized_dec_u64((u64)num, digit_to_write_count); }
-void log_sized_dec_s32(s32 num, u64 digit_to_write_count) { log_sized_dec_u64((u64)num, digit_to_write_count); }
-
-
-void log_sized_dec_s64(s64 num, u64 digit_to_write_count)
-{
-  u64 is_neg  = num < 0;
-  u64 pos_num = is_neg ? -num : num;
-
-  logs.buffer[logs.buffer_end_idx] = '-'; // overwritten if unnecessary
-  logs.buffer_end_idx += is_neg;
-  
-  log_sized_dec_u64(pos_num, digit_to_write_count);
-}
-
-
-void log_sized_dec_u8 (u8  num, u64 digit_to_write_count) { log_sized_dec_u64(num, digit_to_write_count); }
-void log_sized_dec_u16(u16 num, u64 digit_to_write_count) { log_sized_dec_u64(num, digit_to_write_count); }
-void log_sized_dec_u32(u32 num, u64 digit_to_write_count) { log_sized_dec_u64(num, digit_to_write_count); }
-
-
-void log_sized_dec_u64(u64 num, u64 digit_to_write_count)
-{
-  u8* const num_str_start = logs.buffer + logs.buffer_end_idx;
-  u8*       dest          = num_str_start + digit_to_write_count;
-  while (dest > num_str_start)
-  {
-    u64 quotient = num / 10;
-    u8  digit    = (u8)(num - (quotient * 10));
-
-    dest -= 1;
-    *dest = '0' + digit;
-    
-    num = quotient;
-  }
-  
-  logs.buffer_end_idx += digit_to_write_count;
-}
-
-
-static const f32 f32_frac_size_to_mul[F32_DEC_FRAC_MAX_STR_SIZE + 1] =
-{
-  1.f,
-  10.f,
-  100.f,
-  1000.f,
-  10000.f,
-  100000.f,
-  1000000.f,
-  10000000.f,
-  100000000.f,
-  1000000000.f
-};
-
-void log_sized_dec_f32_number(f32 num, u64 frac_digit_to_write_count)
-{
-  u32 is_neg = num < 0.f;
-  
-  logs.buffer[logs.buffer_end_idx] = '-'; // overwritten if unnecessary
-  logs.buffer_end_idx += is_neg;
-
-  // Absolute values equal or greater to 8 388 608 are likely better represented as a s32 or s64
-  // than as a 32-bit floating-point value (thereafter referred to as "f32"), for two reasons:
-  // 
-  // 1. Range of values: f32 values can be as large as +/- 3.4 x 10^38. I've never needed to
-  // represent values that large as a f32. If they are ever necessary to you, I believe s32 and s64
-  // are better fits because they can represent values up to +/- 2.15 x 10^9 and +/- 9.22 x 10^18
-  // respectively, which might cover your needs. Otherwise, changing scale (i.e. meter to lightyear)
-  // might be a better option because of reason #2.
-  // 
-  // 2. Precision: starting at 8 388 608 and beyond, f32 values cannot have a fractional part.
-  // Starting at 16 777 216 and beyond, adding 1 to a f32 value doesn't change it. The fractional
-  // part is not very significant at this magnitude, but s32 and s64 retain a precision of 1 on the
-  // full range of values they cover.
-  //
-  // Nonetheless, 8 388 608 needs 23 bits to be represented, which would require a u32. So the full
-  // range of the u32 type (+/- [0; 4 294 967 296]) may as well be supported, adding an extra
-  // margin
-  num = is_neg ? -num : num;
-  if (num < 4294967296.f)
-  {
-    u32 num_int = (u32)num;
-    log_dec_u32(num_int);
-    
-    if (num < 8388608.f)
-    {
-      // The same way values I've never needed to represent very large f32 values, I believe 
-      // representing values under 0.000001 (without changing units) should never be needed
-      f32 num_rounded = (f32)num_int;
-      f32 num_frac    = num - num_rounded;
-      if (num_frac >= 0.000001f)
-      {
-        log_character('.');
-
-        // Fun fact: for floating-point values with exponent n (n < 23), the maximum count of decimal
-        // fractional digit is 23 - n. Using the unbiased exponent u, this is the same as 150 - u.
-        //
-        //   u32 num_bits             = *(u32*)&num;
-        //   s8  unbiased_exp         = (s8)((num_bits & 0x7F800000) >> 23);
-        //   u8  max_frac_digit_count = 150u - unbiased_exp;
-
-        // There can never be more fractional digits than the configured maximum allowed.
-        // F32_DEC_FRAC_MAX_STR_SIZE is defined in logs.h
-        u64 num_frac_digit_to_write_count = (frac_digit_to_write_count < F32_DEC_FRAC_MAX_STR_SIZE) ?
-                                            frac_digit_to_write_count : F32_DEC_FRAC_MAX_STR_SIZE;
-        f32 num_frac_ext = num_frac * f32_frac_size_to_mul[num_frac_digit_to_write_count];
-        u32 num_frac_int = (u32)num_frac_ext;
-
-        log_sized_dec_u32(num_frac_int, num_frac_digit_to_write_count);
-      }
-    }
-  }
-  else
-  {
-    u8* dest = logs.buffer + logs.buffer_end_idx;
-    dest[0] = 'b';
-    dest[1] = 'i';
-    dest[2] = 'g';
-
-    logs.buffer_end_idx += 3;
-  }
-}
-
-
-void log_sized_dec_f32(f32 num, u64 frac_size)
-{
-  u64 is_a_number = f32_is_a_number(num);
-  if (is_a_number)
-  {
-    log_sized_dec_f32_number(num, frac_size);
-  }
-  else
-  {
-    log_dec_f32_nan_or_inf(num);
-  }
-}
-
-
-void log_dec_s8 (s8  num) { log_dec_s32(num); }
-void log_dec_s16(s16 num) { log_dec_s32(num); }
-
-
-void log_dec_s32(s32 num)
-{
-  u32 is_neg  = num < 0ll;
-  u32 pos_num = (u32)(is_neg ? -num : num);
-
-  u8* num_str_start        = logs.buffer + logs.buffer_end_idx;
-  u64 digit_to_write_count = u32_digit_count(pos_num);
-  u64 char_to_write_count  = digit_to_write_count + is_neg;
-  u8* dest                 = num_str_start + char_to_write_count;
-  
-  *num_str_start = '-'; // will be overwritten if not needed
-  num_str_start += is_neg;
-  while (dest > num_str_start)
-  {
-    u32 quotient = pos_num / 10;
-    u8  digit    = (u8)(pos_num - (quotient * 10u));
-
-    dest -= 1;
-    *dest = '0' + digit;
-    
-    pos_num = quotient;
-  }
-  
-  logs.buffer_end_idx += char_to_write_count;
-}
-
-
-void log_dec_s64(s64 num)
-{
-  u64 is_neg  = num < 0ll;
-  u64 pos_num = (u64)(is_neg ? -num : num);
-
-  u8* const num_str_start        = logs.buffer + logs.buffer_end_idx;
-  u64       digit_to_write_count = u64_digit_count(pos_num);
-  u64       char_to_write_count  = digit_to_write_count + is_neg;
-  u8*       dest                 = num_str_start + char_to_write_count;
-  
-  *num_str_start = '-'; // will be overwritten if not needed
-  while (dest > num_str_start)
-  {
-    u64 quotient = pos_num / 10;
-    u8  digit    = (u8)(pos_num - (quotient * 10));
-
-    dest -= 1;
-    *dest = '0' + digit;
-    
-    pos_num = quotient;
-  }
-  
-  logs.buffer_end_idx += char_to_write_count;
-}
-
-
-void log_dec_u8 (u8  num) { log_sized_dec_u64(num, u32_digit_count(num)); }
-void log_dec_u16(u16 num) { log_sized_dec_u64(num, u32_digit_count(num)); }
-void log_dec_u32(u32 num) { log_sized_dec_u64(num, u32_digit_count(num)); }
-void log_dec_u64(u64 num) { log_sized_dec_u64(num, u64_digit_count(num)); }
-
-
-void log_dec_f32_nan_or_inf(f32 num)
-{
-  u32 num_bits = *(u32*)&num;
-  
-  // num is +infinity, -infinity, qnan, -qnan, snan or -snan
-  // The negative sign is overwritten if it is unnecessary
-  u8* const num_str_start = logs.buffer + logs.buffer_end_idx;
-  num_str_start[0] = '-'; // overwritten if unnecessary
-
-  u8* dest = num_str_start;
-  dest += num_bits >> 31;
- 
-  const u32 MANTISSA_MASK = 0x007FFFFF;
-  u32 mantissa_bits = num_bits & MANTISSA_MASK;
-  if (mantissa_bits == 0)
-  {
-    dest[0] = 'i';
-    dest[1] = 'n';
-    dest[2] = 'f';
-    dest += 3;
-  }
-  else
-  {
-    // A nan is a float with all the exponent bits set and at least one fraction bit set.
-    // A quiet nan (qnan) is a nan with the leftmost, highest fraction bit set.
-    // A signaling nan (qnan) is a nan with the leftmost, highest fraction bit clear.
-    // 's' - 'q' is 2, which is a multiple of 2. We can use this to change 's' to a 'q' by
-    // offsetting 's' to 'q' without ifs
-    u8 is_quiet_offset = (u8)((num_bits & 0x00400000) >> 21);
-    
-    dest[0] = 's' - is_quiet_offset;
-    dest[1] = 'n';
-    dest[2] = 'a';
-    dest[3] = 'n';
-    dest += 4;
-  }
-
-  logs.buffer_end_idx += (u64)(dest - num_str_start);
-}
-
-
-void log_dec_f32_number(f32 num)
-{
-  u64 is_neg = num < 0.f;
-  
-  logs.buffer[logs.buffer_end_idx] = '-'; // overwritten if unnecessary
-  logs.buffer_end_idx += is_neg;
-
-  // Absolute values equal or greater than 8 388 608 are likely better represented as a s32 or s64
-  // than as a 32-bit floating-point value (thereafter referred to as "f32"), for two reasons:
-  // 
-  // 1. Range of values: f32 values can be as large as +/- 3.4 x 10^38. I've never needed to
-  // represent values that large as a f32. If they are ever necessary to you, I believe s32 and s64
-  // are better fits because they can represent values up to +/- 2.15 x 10^9 and +/- 9.22 x 10^18
-  // respectively, which might cover your needs. Otherwise, changing scale (i.e. meter to lightyear)
-  // might be a better option because of reason #2.
-  // 
-  // 2. Precision: starting at 8 388 608 and beyond, f32 values cannot have a fractional part.
-  // Starting at 16 777 216 and beyond, adding 1 to a f32 value doesn't change it. The fractional
-  // part is not very significant at this magnitude, but s32 and s64 retain a precision of 1 on the
-  // full range of values they cover.
-  //
-  // Nonetheless, 8 388 608 needs 23 bits to be represented, which would require a u32. So the full
-  // range of the u32 type (+/- [0; 4 294 967 296]) may as well be supported, adding an extra
-  // margin
-  num = is_neg ? -num : num;
-  if (num < 4294967296.f)
-  {
-    u32 num_int = (u32)num;
-    log_dec_u32(num_int);
-    
-    if (num < 8388608.f)
-    {
-      // The same way values I've never needed to represent very large f32 values, I believe 
-      // representing values under 0.000001 (without changing units) should never be needed
-      f32 num_rounded = (f32)num_int;
-      f32 num_frac    = num - num_rounded;
-      if (num_frac >= 0.000001f)
-      {
-        log_character('.');
-
-        // Fun fact: for floating-point values with exponent n (n < 23), the maximum count of decimal
-        // fractional digit is 23 - n. Using the unbiased exponent u, this is the same as 150 - u.
-        //
-        //   u32 num_bits             = *(u32*)&num;
-        //   s8  unbiased_exp         = (s8)((num_bits & 0x7F800000) >> 23);
-        //   u8  max_frac_digit_count = 150u - unbiased_exp;
-
-        // F32_DEC_FRAC_MULT and F32_DEC_FRAC_DEFAULT_STR_SIZE are defined in logs.h
-        u32 num_frac_int = (u32)(num_frac * F32_DEC_FRAC_MULT);
-        log_sized_dec_u32(num_frac_int, F32_DEC_FRAC_DEFAULT_STR_SIZE);
-      }
-    }
-  }
-  else
-  {
-    u8* dest = logs.buffer + logs.buffer_end_idx;
-    dest[0] = 'b';
-    dest[1] = 'i';
-    dest[2] = 'g';
-
-    logs.buffer_end_idx += 3;
-  }
-}
-
-
-void log_dec_f32(f32 num)
-{
-  u64 is_a_number = f32_is_a_number(num);
-  if (is_a_number)
-  {
-    log_dec_f32_number(num);
-  }
-  else
-  {
-    log_dec_f32_nan_or_inf(num);
-  }
-}
-
-
-// Hexadecimal
-static const char hex_digits[] = "0123456789ABCDEF";
-
-void log_sized_hex_s8 (s8  num, u64 nibble_to_write_count) { log_sized_hex_u64((u64)num, nibble_to_write_count); }
-void log_sized_hex_s16(s16 num, u64 nibble_to_write_count) { log_sized_hex_u64((u64)num, nibble_to_write_count); }
-void log_sized_hex_s32(s32 num, u64 nibble_to_write_count) { log_sized_hex_u64((u64)num, nibble_to_write_count); }
-void log_sized_hex_s64(s64 num, u64 nibble_to_write_count) { log_sized_hex_u64((u64)num, nibble_to_write_count); }
-void log_sized_hex_u8 (u8  num, u64 nibble_to_write_count) { log_sized_hex_u64(num,      nibble_to_write_count); }
-void log_sized_hex_u16(u16 num, u64 nibble_to_write_count) { log_sized_hex_u64(num,      nibble_to_write_count); }
-void log_sized_hex_u32(u32 num, u64 nibble_to_write_count) { log_sized_hex_u64(num,      nibble_to_write_count); }
-
-
-void log_sized_hex_u64(u64 num, u64 nibble_to_write_count)
-{
-  u8* const num_str_start = logs.buffer + logs.buffer_end_idx;
-  u8*       dest          = num_str_start + nibble_to_write_count;
-  while (dest > num_str_start)
-  {
-    u8 nibble_idx = num & 0xF;
-    
-    dest -= 1;
-    *dest = hex_digits[nibble_idx];
-    
-    num >>= 4;
-  }
-
-  logs.buffer_end_idx += nibble_to_write_count;
-}
-
-
-void log_sized_hex_f32(f32 num, u64 nibble_to_write_count) { log_sized_hex_u64(*(u32*)&num, nibble_to_write_count); }
-
-
-void log_hex_s8 (s8  num) { log_sized_hex_u64((u64)num,    u32_nibble_count((u32)num));    }
-void log_hex_s16(s16 num) { log_sized_hex_u64((u64)num,    u32_nibble_count((u32)num));    }
-void log_hex_s32(s32 num) { log_sized_hex_u64((u64)num,    u32_nibble_count((u32)num));    }
-void log_hex_s64(s64 num) { log_sized_hex_u64((u64)num,    u64_nibble_count((u64)num));    }
-void log_hex_u8 (u8  num) { log_sized_hex_u64(num,         u32_nibble_count(num));         }
-void log_hex_u16(u16 num) { log_sized_hex_u64(num,         u32_nibble_count(num));         }
-void log_hex_u32(u32 num) { log_sized_hex_u64(num,         u32_nibble_count(num));         }
-void log_hex_u64(u64 num) { log_sized_hex_u64(num,         u64_nibble_count(num));         }
-void log_hex_f32(f32 num) { log_sized_hex_u64(*(u32*)&num, u32_nibble_count(*(u32*)&num)); }
-
-
-
-
-///////////////////////////////////////////////////////////////////////////////////////////////////
-///////////////////////////////////////////////////////////////////////////////////////////////////
-//// Utilities
-u64 lzcnt32(u32 num)
-{
-#if defined(_MSC_VER)
-  return __lzcnt(num);
-#elif defined(__clang__) || defined(__GNUC__)
-  return __builtin_ia32_lzcnt_u32(num);
-#endif
-}
-
-
-u64 lzcnt64(u64 num)
-{
-#if defined(_MSC_VER)
-  return __lzcnt64(num);
-#elif defined(__clang__) || defined(__GNUC__)
-  return __builtin_ia32_lzcnt_u64(num);
-#endif
-}
-
-
-u32 pdep32(u32 a, u32 mask)
-{
-#if defined(_MSC_VER)
-  return _pdep_u32(a, mask);
-#elif defined(__clang__) || defined(__GNUC__)
-  return __builtin_ia32_pdep_si(a, mask);
-#endif
-}
-
-
-u32 bswap32(u32 a)
-{
-#if defined(_MSC_VER)
-  // Should generate a bswap instruction
-  return (a              << 24) |
-         (a              >> 24) |
-         ((a & 0xFF00)   << 8) |
-         ((a & 0xFF0000) >> 8);
-#elif defined(__clang__) || defined(__GNUC__)
-  return __builtin_bswap32(a);
-#endif
-}
-
-
-u64 get_msb_1_bit_idx_u32(u32 num)
-{
-  return 31 ^ lzcnt32(num | 1);
-}
-
-
-u64 get_msb_1_bit_idx_u64(u64 num)
-{
-  return 63 ^ lzcnt64(num | 1);
-}
-
-
-// Numerals count in a number
-u64 u32_digit_count(u32 num)
-{
-  // Similar to https://commaok.xyz/post/lookup_tables/, but:
-  // - lzcnt replaces bsr
-  // - table is reversed
-  // - an extra entry is added for num = 0, so this function returns 1
-  // - the bitwise OR and substraction performed by int_log2() no longer happen
-  static const u64 offsets[33] =
-  {
-    42949672960ull, 42949672960ull,                                 // (10 << 32)
-    41949672960ull, 41949672960ull, 41949672960ull,                 // (10 << 32) - 1000000000
-    38554705664ull, 38554705664ull, 38554705664ull,                 // (9  << 32) - 100000000
-    34349738368ull, 34349738368ull, 34349738368ull, 34349738368ull, // (8  << 32) - 10000000
-    30063771072ull, 30063771072ull, 30063771072ull,                 // (7  << 32) - 1000000
-    25769703776ull, 25769703776ull, 25769703776ull,                 // (6  << 32) - 100000
-    21474826480ull, 21474826480ull, 21474826480ull, 21474826480ull, // (5  << 32) - 10000
-    17179868184ull, 17179868184ull, 17179868184ull,                 // (4  << 32) - 1000
-    12884901788ull, 12884901788ull, 12884901788ull,                 // (3  << 32) - 100
-    8589934582ull,  8589934582ull,  8589934582ull,                  // (2  << 32) - 10
-    4294967296ull,                                                  // (1  << 32)
-    4294967296ull                                                   // (1  << 32)
-  };
-
-  u64 lzcnt       = lzcnt32(num);
-  u64 offset      = offsets[lzcnt];
-  u64 digit_count = (num + offset) >> 32;
-
-  return digit_count;
-}
-
-
-u64 u64_digit_count(u64 num)
-{
-  // https://lemire.me/blog/2025/01/07/counting-the-digits-of-64-bit-integers/
-  static u64 thresholds[19] =
-  {
-    9ull,
-    99ull,
-    999ull,
-    9999ull,
-    99999ull,
-    999999ull,
-    9999999ull,
-    99999999ull,
-    999999999ull,
-    9999999999ull,
-    99999999999ull,
-    999999999999ull,
-    9999999999999ull,
-    99999999999999ull,
-    999999999999999ull,
-    9999999999999999ull,
-    99999999999999999ull,
-    999999999999999999ull,
-    9999999999999999999ull
-  };
-  u64 msb_idx       = get_msb_1_bit_idx_u64(num);
-  u64 threshold_idx = (19 * msb_idx) >> 6;
-  u64 threshold     = thresholds[threshold_idx];
-  u64 is_greater    = num > threshold;
-  u64 digit_count   = threshold_idx + is_greater + 1;
-
-  return digit_count;
-}
-
-
-u64 u32_bit_count(u32 num)
-{
-  return get_msb_1_bit_idx_u32(num) + 1;
-}
-
-
-u64 u64_bit_count(u64 num)
-{
-  return get_msb_1_bit_idx_u64(num) + 1;
-}
-
-
-u64 u32_nibble_count(u32 num)
-{
-  u64 msb_idx      = get_msb_1_bit_idx_u32(num);
-  u64 nibble_count = 1 + (msb_idx >> 2);
-
-  return nibble_count;
-}
-
-
-u64 u64_nibble_count(u64 num)
-{
-  u64 msb_idx      = get_msb_1_bit_idx_u64(num);
-  u64 nibble_count = 1 + (msb_idx >> 2);
-  
-  return nibble_count;
-}
-
-
-u64 f32_is_a_number(f32 num)
-{
-  const u32 EXPONENT_ALL_ONE = 0x7F800000;
-  
-  u32 num_bits = *(u32*)&num;
-  
-  return (num_bits & EXPONENT_ALL_ONE) != EXPONENT_ALL_ONE;
-}
-
-
-u64 utf16_code_point_to_unicode(const u16* utf16, u32* unicode)
-{
-  const u16 range = 0xDFFF - 0xD800;
-  u16 offset = utf16[0] - 0xD800;
-  if (offset > range)
-  {
-    *unicode = utf16[0];
-    return 1;
-  }
-  else
-  {
-    u32 lo = utf16[0] & 0x3FF;
-    u32 hi = (utf16[1] & 0x3FF) << 10;
-    
-    *unicode = (hi | lo) + 0x10000;
-    return 2;
-  }
-}
-
-
-static const u8 lzcnt_to_utf8_byte_count[33] =
-{
-  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-  4, 4, 4, 4, 4,
-  3, 3, 3, 3, 3,
-  2, 2, 2, 2,
-  1, 1, 1, 1, 1, 1, 1,
-  0
-};
-
-static const u32 high_order_bits[] =
-{
-  0x0,
-  0x0,
-  0x80C0, // 0b1000000011000000
-  0x8080E0, // 0b100000001000000011100000
-  0x808080F0, // 0b10000000100000001000000011110000
-};
-
-static const u32 pdep_mask[] =
-{
-  0x0,
-  0xFF000000, // 0b11111111000000000000000000000000
-  0x1F3F0000, // 0b00011111001111110000000000000000
-  0x0F3F3F00, // 0b00001111001111110011111100000000
-  0x073F3F3F  // 0b00000111001111110011111100111111
-};
-
-u64 unicode_to_utf8_code_point(u32 unicode, u8* utf8)
-{
-  // lzcnt | byte_count | Unicode
-  // ------|------------|---------------------------
-  // 31-25 | 1          | 0wwwwwww
-  // 24-21 | 2          | 00000xxx xxwwwwww
-  // 20-16 | 3          | yyyyxxxx xxwwwwww
-  // 15-11 | 4          | 000zzzyy yyyyxxxx xxwwwwww
-  // 10- 0 | 0          | Invalid unicode
-  u64 lzcnt      = lzcnt32(unicode);
-  u64 byte_count = lzcnt_to_utf8_byte_count[lzcnt];
-
-  // byte_count |              deposited              |         bswap32(deposited)
-  // -----------|-------------------------------------|------------------------------------
-  // 1          | wwwwwwww 00000000 00000000 00000000 | 00000000 00000000 00000000 wwwwwwww
-  // 2          | 000xxxxx 00wwwwww 00000000 00000000 | 00000000 00000000 00wwwwww 000xxxxx
-  // 3          | 0000yyyy 00xxxxxx 00wwwwww 00000000 | 00000000 00wwwwww 00xxxxxx 0000yyyy
-  // 4          | 00000zzz 00yyyyyy 00xxxxxx 00wwwwww | 00wwwwww 00xxxxxx 00yyyyyy 00000zzz
-  u32 deposited = pdep32(unicode, pdep_mask[byte_count]);
-  u32 bswapped  = bswap32(deposited);
-
-  // byte_count |         bswap32(deposited)          |               encoded
-  // -----------|-------------------------------------|------------------------------------
-  // 1          | 00000000 00000000 00000000 wwwwwwww | 00000000 00000000 00000000 wwwwwwww
-  // 2          | 00000000 00000000 00wwwwww 000xxxxx | 00000000 00000000 10wwwwww 110xxxxx
-  // 3          | 00000000 00wwwwww 00xxxxxx 0000yyyy | 00000000 10wwwwww 10xxxxxx 1110yyyy
-  // 4          | 00wwwwww 00xxxxxx 00yyyyyy 00000zzz | 10wwwwww 10xxxxxx 10yyyyyy 11110zzz
-  u32 high_bits = high_order_bits[byte_count];
-  u32 encoded   = high_bits | bswapped;
-
-  *(u32*)utf8 = encoded;
-
-  return byte_count;
-}
-
-#elif defined(_MSC_VER)
-#  pragma warning(disable: 4206) // Disable "empty translation unit" warning
-#endif // defined(LOGS_ENABLED) && (LOGS_ENABLED != 0)
+#if defined(LOGS_ENABLED) && (LOGS_ENABLED != 0)
+#include "logs.h"
+
+#if defined(LOGS_OS_WINDOWS)
+#  define _WIN32_WINNT 0x0501 // ATTACH_PARENT_PROCESS
+#  include <Windows.h>
+#elif defined(LOGS_OS_LINUX)
+// #  include "linux_logs_syscalls.h"
+#  define STDOUT_FD 1
+#  define STDERR_FD 2
+#endif
+
+// SSE2 is part of x86_64. SSSE3 (pshufb) is available on every CPU supporting BMI2, which this
+// library already requires
+#include <emmintrin.h>
+#include <tmmintrin.h>
+
+// AVX is only used by functions compiled for it, which are called after checking that the CPU
+// supports it
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#  define TARGET_AVX
+#elif defined(__clang__) || defined(__GNUC__)
+#  define TARGET_AVX __attribute__((target("avx")))
+#endif
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//// Helpers
+#if defined(LOGS_OS_LINUX)
+// struct timespec of <time.h>
+struct linux_timespec
+{
+  s64 sec;
+  s64 nsec;
+};
+#endif
+
+
+// CPU features used by copy_bytes(), detected on first use
+#define CPU_FEATURES_DETECTED 0x1
+#define CPU_FEATURE_AVX       0x2
+#define CPU_FEATURE_ERMS      0x4 // Enhanced "rep movsb"
+
+static u64 cpu_features = 0;
+
+static void detect_cpu_features(void)
+{
+  u32 leaf_1[4];
+  u32 leaf_7[4];
+#if defined(_MSC_VER)
+  __cpuidex((int*)leaf_1, 1, 0);
+  __cpuidex((int*)leaf_7, 7, 0);
+#elif defined(__clang__) || defined(__GNUC__)
+  __asm__ ("cpuid" : "=a"(leaf_1[0]), "=b"(leaf_1[1]), "=c"(leaf_1[2]), "=d"(leaf_1[3]) : "a"(1), "c"(0));
+  __asm__ ("cpuid" : "=a"(leaf_7[0]), "=b"(leaf_7[1]), "=c"(leaf_7[2]), "=d"(leaf_7[3]) : "a"(7), "c"(0));
+#endif
+
+  // AVX also requires the OS to save the YMM registers (OSXSAVE, then XCR0 bits 1 and 2)
+  u64 features = CPU_FEATURES_DETECTED;
+  if (((leaf_1[2] >> 27) & 1) && ((leaf_1[2] >> 28) & 1))
+  {
+#if defined(_MSC_VER)
+    const u64 xcr0 = _xgetbv(0);
+#elif defined(__clang__) || defined(__GNUC__)
+    u32 xcr0_lo;
+    u32 xcr0_hi;
+    __asm__ ("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+    const u64 xcr0 = ((u64)xcr0_hi << 32) | xcr0_lo;
+#endif
+    features |= ((xcr0 & 0x6) == 0x6) ? CPU_FEATURE_AVX : 0;
+  }
+
+  features |= ((leaf_7[1] >> 9) & 1) ? CPU_FEATURE_ERMS : 0;
+  cpu_features = features;
+}
+
+
+// Copy size bytes (more than 64) from src to dest 32 bytes at a time. The last 32 bytes are copied
+// with a store overlapping the previous one
+TARGET_AVX static void copy_bytes_avx(u8* dest, const u8* src, u64 size)
+{
+  const __m256i last_bytes = _mm256_loadu_si256((const __m256i*)(src + size - 32));
+  for (u64 i = 0; i < (size - 32); i += 32)
+  {
+    _mm256_storeu_si256((__m256i*)(dest + i), _mm256_loadu_si256((const __m256i*)(src + i)));
+  }
+  _mm256_storeu_si256((__m256i*)(dest + size - 32), last_bytes);
+}
+
+
+// Copy size bytes (more than 64) from src to dest 16 bytes at a time. The last 16 bytes are copied
+// with a store overlapping the previous one
+static void copy_bytes_sse2(u8* dest, const u8* src, u64 size)
+{
+  const __m128i last_bytes = _mm_loadu_si128((const __m128i*)(src + size - 16));
+  for (u64 i = 0; i < (size - 16); i += 16)
+  {
+    _mm_storeu_si128((__m128i*)(dest + i), _mm_loadu_si128((const __m128i*)(src + i)));
+  }
+  _mm_storeu_si128((__m128i*)(dest + size - 16), last_bytes);
+}
+
+
+static void copy_bytes_rep_movsb(u8* dest, const u8* src, u64 size)
+{
+#if defined(_MSC_VER)
+  __movsb(dest, src, size);
+#elif defined(__clang__) || defined(__GNUC__)
+  __asm__ volatile ("rep movsb" : "+D"(dest), "+S"(src), "+c"(size) : : "memory");
+#endif
+}
+
+
+// From this size, "rep movsb" beats vector loops on CPUs with ERMS
+#define REP_MOVSB_MIN_SIZE 2048
+
+// Copy size bytes from src to dest. src is never read past its size bytes, and dest is only
+// written to within them. The strategy depends on size:
+// - up to 64 bytes: 2 to 4 possibly overlapping loads and stores, without any loop
+// - up to REP_MOVSB_MIN_SIZE (or more without ERMS): a 32-byte AVX or 16-byte SSE2 loop
+// - from REP_MOVSB_MIN_SIZE: "rep movsb"
+static inline void copy_bytes(u8* dest, const u8* src, u64 size)
+{
+  if (size <= 16)
+  {
+    if (size >= 8)
+    {
+      const u64 first_bytes = *(const u64*)src;
+      const u64 last_bytes  = *(const u64*)(src + size - 8);
+      *(u64*)dest              = first_bytes;
+      *(u64*)(dest + size - 8) = last_bytes;
+    }
+    else if (size >= 4)
+    {
+      const u32 first_bytes = *(const u32*)src;
+      const u32 last_bytes  = *(const u32*)(src + size - 4);
+      *(u32*)dest              = first_bytes;
+      *(u32*)(dest + size - 4) = last_bytes;
+    }
+    else if (size != 0)
+    {
+      // 1 to 3 bytes: first, middle and last bytes
+      const u8 first_byte  = src[0];
+      const u8 middle_byte = src[size / 2];
+      const u8 last_byte   = src[size - 1];
+      dest[0]        = first_byte;
+      dest[size / 2] = middle_byte;
+      dest[size - 1] = last_byte;
+    }
+  }
+  else if (size <= 32)
+  {
+    const __m128i first_bytes = _mm_loadu_si128((const __m128i*)src);
+    const __m128i last_bytes  = _mm_loadu_si128((const __m128i*)(src + size - 16));
+    _mm_storeu_si128((__m128i*)dest,               first_bytes);
+    _mm_storeu_si128((__m128i*)(dest + size - 16), last_bytes);
+  }
+  else if (size <= 64)
+  {
+    const __m128i bytes_0 = _mm_loadu_si128((const __m128i*)src);
+    const __m128i bytes_1 = _mm_loadu_si128((const __m128i*)(src + 16));
+    const __m128i bytes_2 = _mm_loadu_si128((const __m128i*)(src + size - 32));
+    const __m128i bytes_3 = _mm_loadu_si128((const __m128i*)(src + size - 16));
+    _mm_storeu_si128((__m128i*)dest,               bytes_0);
+    _mm_storeu_si128((__m128i*)(dest + 16),        bytes_1);
+    _mm_storeu_si128((__m128i*)(dest + size - 32), bytes_2);
+    _mm_storeu_si128((__m128i*)(dest + size - 16), bytes_3);
+  }
+  else
+  {
+    if (cpu_features == 0)
+    {
+      detect_cpu_features();
+    }
+
+    if ((size >= REP_MOVSB_MIN_SIZE) && (cpu_features & CPU_FEATURE_ERMS))
+    {
+      copy_bytes_rep_movsb(dest, src, size);
+    }
+    else if (cpu_features & CPU_FEATURE_AVX)
+    {
+      copy_bytes_avx(dest, src, size);
+    }
+    else
+    {
+      copy_bytes_sse2(dest, src, size);
+    }
+  }
+}
+
+
+#if (defined(LOGS_AUTO_FLUSH) && (LOGS_AUTO_FLUSH != 0))                            || \
+    (defined(LOGS_OS_LINUX) && defined(LOGS_SHARED_RING) && (LOGS_SHARED_RING != 0)) || \
+    (defined(LOGS_OS_LINUX) && defined(LOGS_BINARY) && (LOGS_BINARY != 0))
+// Get the count of bytes before the null terminator of str, read with aligned 16-byte loads like
+// in copy_null_terminated_str()
+static inline u64 utf8_str_length(const char* str)
+{
+  const u64      misalignment = (u64)str & 15;
+  const __m128i* block        = (const __m128i*)((u64)str - misalignment);
+
+  // Null characters found before str are ignored
+  u32 null_char_mask = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128(block), _mm_setzero_si128()));
+  null_char_mask &= 0xFFFFu << misalignment;
+  while (null_char_mask == 0)
+  {
+    block          += 1;
+    null_char_mask  = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128(block), _mm_setzero_si128()));
+  }
+
+  return (u64)block + tzcnt32(null_char_mask) - (u64)str;
+}
+#endif
+
+
+// Two ASCII digits for each number in [0; 99], e.g. "42" starts at offset 2 * 42
+static const char dec_digit_pairs[] =
+  "00010203040506070809"
+  "10111213141516171819"
+  "20212223242526272829"
+  "30313233343536373839"
+  "40414243444546474849"
+  "50515253545556575859"
+  "60616263646566676869"
+  "70717273747576777879"
+  "80818283848586878889"
+  "90919293949596979899";
+
+static inline u64 dec_digit_pair(u64 num)
+{
+  return *(const u16*)(dec_digit_pairs + (num * 2));
+}
+
+
+// Convert num (in [0; 9 999]) to 4 ASCII digits, left-padded with '0'. The most significant digit
+// is placed in the lowest byte, so the result can be stored to memory as is
+static inline u64 dec_4_digits(u32 num)
+{
+  // See dec_8_digits() below, with num / 10^2 as the fixed-point number
+  const u64 FRAC_BITS = 57;
+  const u64 FRAC_MASK = (1ull << FRAC_BITS) - 1;
+
+  u64 fixed  = (u64)num * 1441151880758559ull; // ceil(2^57 / 10^2)
+  u64 digits = dec_digit_pair(fixed >> FRAC_BITS);
+
+  fixed   = (fixed & FRAC_MASK) * 100;
+  digits |= dec_digit_pair(fixed >> FRAC_BITS) << 16;
+
+  return digits;
+}
+
+
+// Convert num (in [0; 99 999 999]) to 8 ASCII digits, left-padded with '0'. The most significant
+// digit is placed in the lowest byte, so the result can be stored to memory as is
+static inline u64 dec_8_digits(u32 num)
+{
+  // Similar to https://github.com/jeaiii/itoa: num / 10^6 is computed as a fixed-point number with
+  // 57 fractional bits, whose integer part holds the 2 leading digits. Multiplying the fractional
+  // part by 100 moves the next 2 digits into the integer part, so no division is ever performed.
+  // The multiplier is rounded up by less than 0.15: the error it introduces is positive and, even
+  // multiplied by num and 100^3 (about 1.4e13), stays below 2^57 / 10^2 (about 1.4e15), so it can
+  // never carry into the integer part
+  const u64 FRAC_BITS = 57;
+  const u64 FRAC_MASK = (1ull << FRAC_BITS) - 1;
+
+  u64 fixed  = (u64)num * 144115188076ull; // ceil(2^57 / 10^6)
+  u64 digits = dec_digit_pair(fixed >> FRAC_BITS);
+
+  fixed   = (fixed & FRAC_MASK) * 100;
+  digits |= dec_digit_pair(fixed >> FRAC_BITS) << 16;
+
+  fixed   = (fixed & FRAC_MASK) * 100;
+  digits |= dec_digit_pair(fixed >> FRAC_BITS) << 32;
+
+  fixed   = (fixed & FRAC_MASK) * 100;
+  digits |= dec_digit_pair(fixed >> FRAC_BITS) << 48;
+
+  return digits;
+}
+
+
+// Convert num (in [0; 10^16 - 1]) to 16 ASCII digits, left-padded with '0', using SSE2. num is split
+// into 4 blocks of 4 digits. Each block is copied to 4 16-bit lanes, which are divided by 1000, 100,
+// 10 and 1 at once with multiply-high instructions, then each lane subtracts 10 times its neighbour
+// to only keep 1 digit. See http://0x80.pl/articles/sse-itoa.html
+static inline __m128i dec_16_digits_sse2(u64 num)
+{
+  // 2 64-bit lanes holding the 8 most significant digits (abcdefgh) then the 8 least significant
+  // digits (ijklmnop). The division by 10^4 is a multiplication by ceil(2^45 / 10^4)
+  const __m128i halves   = _mm_set_epi64x(num % 100000000, num / 100000000);
+  const __m128i div_10e4 = _mm_set1_epi32((s32)0xD1B71759);
+  const __m128i abcd     = _mm_srli_epi64(_mm_mul_epu32(halves, div_10e4), 45);
+  const __m128i efgh     = _mm_sub_epi32(halves, _mm_mul_epu32(abcd, _mm_set1_epi32(10000)));
+
+  // 32-bit lanes [abcd, efgh, ijkl, mnop], multiplied by 4 to keep more precision from the first
+  // multiply-high
+  const __m128i blocks    = _mm_slli_epi32(_mm_or_si128(abcd, _mm_slli_epi64(efgh, 32)), 2);
+  const __m128i blocks_lo = _mm_shufflelo_epi16(blocks, _MM_SHUFFLE(0, 0, 0, 0));
+  const __m128i blocks_hi = _mm_shufflelo_epi16(blocks, _MM_SHUFFLE(2, 2, 2, 2));
+  const __m128i abcd_ijkl = _mm_shufflehi_epi16(blocks_lo, _MM_SHUFFLE(0, 0, 0, 0));
+  const __m128i efgh_mnop = _mm_shufflehi_epi16(blocks_hi, _MM_SHUFFLE(2, 2, 2, 2));
+
+  // 16-bit lanes [a, ab, abc, abcd] with a = abcd / 1000, ab = abcd / 100, abc = abcd / 10
+  const __m128i div_powers   = _mm_set_epi16((s16)32768, 13108, 5243, 8389,
+                                             (s16)32768, 13108, 5243, 8389);
+  const __m128i shift_powers = _mm_set_epi16((s16)(1 << 15), 1 << 13, 1 << 11, 1 << 7,
+                                             (s16)(1 << 15), 1 << 13, 1 << 11, 1 << 7);
+  const __m128i ten          = _mm_set1_epi16(10);
+
+  __m128i left  = _mm_mulhi_epu16(_mm_mulhi_epu16(abcd_ijkl, div_powers), shift_powers);
+  __m128i right = _mm_mulhi_epu16(_mm_mulhi_epu16(efgh_mnop, div_powers), shift_powers);
+
+  // [a, ab, abc, abcd] - [0, a0, ab0, abc0] = [a, b, c, d]
+  left  = _mm_sub_epi16(left,  _mm_slli_epi64(_mm_mullo_epi16(left,  ten), 16));
+  right = _mm_sub_epi16(right, _mm_slli_epi64(_mm_mullo_epi16(right, ten), 16));
+
+  // [a, b, c, d, i, j, k, l] and [e, f, g, h, m, n, o, p] to bytes [a, b, ..., p]
+  const __m128i abcdefgh = _mm_unpacklo_epi64(left, right);
+  const __m128i ijklmnop = _mm_unpackhi_epi64(left, right);
+  const __m128i digits   = _mm_packus_epi16(abcdefgh, ijklmnop);
+
+  return _mm_add_epi8(digits, _mm_set1_epi8('0'));
+}
+
+
+// Write the digit_count (>= 1) least significant decimal digits of num to dest, left-padded with
+// '0'. Up to 7 bytes past the last digit may be overwritten
+static inline void write_dec_u64(u8* dest, u64 num, u64 digit_count)
+{
+  if (digit_count <= 2)
+  {
+    u64 pair = dec_digit_pair(num % 100);
+    *(u16*)dest = (u16)(pair >> ((2 - digit_count) * 8));
+  }
+  else if (digit_count <= 4)
+  {
+    u64 digits = dec_4_digits((u32)(num % 10000));
+    *(u32*)dest = (u32)(digits >> ((4 - digit_count) * 8));
+  }
+  else if (digit_count <= 8)
+  {
+    u64 digits = dec_8_digits((u32)(num % 100000000));
+    *(u64*)dest = digits >> ((8 - digit_count) * 8);
+  }
+  else if (digit_count < 16)
+  {
+    // Split num into 2 8-digit blocks. The leading block is shifted to only keep its least
+    // significant digits
+    const u64 lead_digit_count = digit_count - 8;
+    const u32 lo_block         = (u32)(num % 100000000);
+    const u32 hi_block         = (u32)((num / 100000000) % 100000000);
+
+    *(u64*)dest = dec_8_digits(hi_block) >> ((8 - lead_digit_count) * 8);
+    dest += lead_digit_count;
+
+    *(u64*)dest = dec_8_digits(lo_block);
+  }
+  else
+  {
+    // u64 values have at most 20 digits, anything requested beyond 24 digits can only be a '0'
+    while (digit_count > 24)
+    {
+      *dest = '0';
+      dest        += 1;
+      digit_count -= 1;
+    }
+
+    // The 16 least significant digits are converted at once with SSE2, the 0 to 8 leading digits
+    // are written first
+    const u64 lead_digit_count = digit_count - 16;
+    const u32 lead_block       = (u32)(num / 10000000000000000ull); // in [0; 1844]
+    if (lead_digit_count > 4)
+    {
+      *(u64*)dest = dec_8_digits(lead_block) >> ((8 - lead_digit_count) * 8);
+      dest += lead_digit_count;
+    }
+    else if (lead_digit_count != 0)
+    {
+      *(u32*)dest = (u32)(dec_4_digits(lead_block) >> ((4 - lead_digit_count) * 8));
+      dest += lead_digit_count;
+    }
+
+    _mm_storeu_si128((__m128i*)dest, dec_16_digits_sse2(num % 10000000000000000ull));
+  }
+}
+
+
+static inline u32 open_file_output_ascii(const char* file_path)
+{
+#if defined(LOGS_OS_WINDOWS)
+  const u32 SHARE_RDWR = FILE_SHARE_READ | FILE_SHARE_WRITE;
+  HANDLE output = CreateFileA(file_path,        // lpFileName
+                              FILE_APPEND_DATA, // dwDesiredAccess
+                              SHARE_RDWR,       // dwShareMode
+                              0,                // lpSecurityAttributes
+                              OPEN_ALWAYS,      // dwCreationDisposition
+                              0,                // dwFlagsAndAttributes
+                              0);               // hTemplateFile
+  return (u32)(u64)output;
+#elif defined(LOGS_OS_LINUX)
+  // TODO: O_ASYNC?
+  #define O_RDWR	          00000002
+  #define O_CREAT           00000100
+  #define O_APPEND          00002000
+  #define CREAT_PERMISSIONS 00000775
+  
+  const u64 flags = O_RDWR | O_CREAT | O_APPEND; 
+  register u64         open_syscall_rax __asm__("rax") = 2;
+  register const char* file_path_rdi    __asm__("rdi") = file_path;
+  register u64         flags_rsi        __asm__("rsi") = flags;
+  register u64         mode_rdx         __asm__("rdx") = CREAT_PERMISSIONS;
+  s64 output;
+  __asm__ __volatile__ ("syscall" :
+                        "=a"(output) :
+                        "r"(open_syscall_rax), "r"(file_path_rdi), "r"(flags_rsi), "r"(mode_rdx) :
+                        "rcx", "r11", "memory");
+  return (u32)(s32)output;
+#endif
+}
+
+
+#if defined(LOGS_OS_LINUX) && ((defined(LOGS_MMAP_FILE) && (LOGS_MMAP_FILE != 0)) || \
+                               (defined(LOGS_FILE_ROTATION) && (LOGS_FILE_ROTATION != 0)))
+#  define LSEEK_SYSCALL     8
+#  define FTRUNCATE_SYSCALL 77
+#  define FALLOCATE_SYSCALL 285
+#  define SEEK_END          2
+
+// Syscall managing the file output, with up to 6 arguments. Errors are returned as -errno
+static inline s64 file_syscall(u64 number, u64 arg_0, u64 arg_1, u64 arg_2, u64 arg_3, u64 arg_4,
+                               u64 arg_5)
+{
+  register u64 number_rax __asm__("rax") = number;
+  register u64 arg_0_rdi  __asm__("rdi") = arg_0;
+  register u64 arg_1_rsi  __asm__("rsi") = arg_1;
+  register u64 arg_2_rdx  __asm__("rdx") = arg_2;
+  register u64 arg_3_r10  __asm__("r10") = arg_3;
+  register u64 arg_4_r8   __asm__("r8")  = arg_4;
+  register u64 arg_5_r9   __asm__("r9")  = arg_5;
+  s64 result;
+  __asm__ __volatile__ ("syscall" :
+                        "=a"(result) :
+                        "r"(number_rax), "r"(arg_0_rdi), "r"(arg_1_rsi), "r"(arg_2_rdx),
+                        "r"(arg_3_r10), "r"(arg_4_r8), "r"(arg_5_r9) :
+                        "rcx", "r11", "memory");
+  return result;
+}
+#endif
+
+
+#if defined(LOGS_OS_LINUX) && defined(LOGS_MMAP_FILE) && (LOGS_MMAP_FILE != 0)
+// Memory-mapped file output. A window of LOGS_MMAP_FILE_EXTENT_SIZE bytes of the file, starting at
+// a multiple of that size, is mapped, and logs are copied to it at the end of the logs written so
+// far. The file is grown by whole extents before their window is mapped, and truncated to the size
+// of its logs when closed
+#  define MMAP_FILE_SYSCALL 9
+#  define MUNMAP_SYSCALL    11
+#  define PROT_READ_WRITE   0x3
+#  define MAP_SHARED        0x01
+#  define EOPNOTSUPP        95
+
+#  if (LOGS_MMAP_FILE_EXTENT_SIZE % 4096) != 0
+#    error "LOGS_MMAP_FILE_EXTENT_SIZE must be a multiple of the page size (4096 bytes)"
+#  endif
+
+static struct
+{
+  // Window of the file, or 0 if the file output isn't mapped
+  u8* window;
+  u64 window_offset;
+
+  // Size of the logs in the file, and size of the file including the extents not filled yet
+  u64 size;
+  u64 allocated_size;
+
+  u32 fd;
+} mapped_file;
+
+
+// Map the window of the file starting at offset, growing the file first if needed. Returns 0 on
+// failure, after which the file isn't mapped anymore
+static u64 map_file_window(u64 offset)
+{
+  if (mapped_file.window != 0)
+  {
+    file_syscall(MUNMAP_SYSCALL, (u64)mapped_file.window, LOGS_MMAP_FILE_EXTENT_SIZE, 0, 0, 0, 0);
+    mapped_file.window = 0;
+  }
+
+  const u64 window_end = offset + LOGS_MMAP_FILE_EXTENT_SIZE;
+  if (mapped_file.allocated_size < window_end)
+  {
+    // fallocate reserves the extent's blocks at once, ftruncate only grows the file where it isn't
+    // supported (e.g. on some network file systems). Any other error, such as a full disk, leaves
+    // the file unmapped: a sparse extent would raise SIGBUS on the first store with no block left
+    const u64 extent_size = window_end - mapped_file.allocated_size;
+    const s64 result      = file_syscall(FALLOCATE_SYSCALL, mapped_file.fd, 0,
+                                         mapped_file.allocated_size, extent_size, 0, 0);
+    if (result == -EOPNOTSUPP)
+    {
+      if (file_syscall(FTRUNCATE_SYSCALL, mapped_file.fd, window_end, 0, 0, 0, 0) != 0)
+      {
+        return 0;
+      }
+    }
+    else if (result != 0)
+    {
+      return 0;
+    }
+    mapped_file.allocated_size = window_end;
+  }
+
+  const s64 window = file_syscall(MMAP_FILE_SYSCALL, 0, LOGS_MMAP_FILE_EXTENT_SIZE, PROT_READ_WRITE,
+                                  MAP_SHARED, mapped_file.fd, offset);
+
+  // Errors are returned as -errno, in [-4095; -1]
+  if ((u64)window > (u64)-4096)
+  {
+    return 0;
+  }
+
+  mapped_file.window        = (u8*)window;
+  mapped_file.window_offset = offset;
+  return 1;
+}
+
+
+// Map the file output once opened, past its current content. The file is left unmapped, and
+// written with write syscalls, if it can't be
+static void map_file_output(u32 fd)
+{
+  const s64 size = file_syscall(LSEEK_SYSCALL, fd, 0, SEEK_END, 0, 0, 0);
+  if (size < 0)
+  {
+    return;
+  }
+
+  mapped_file.fd             = fd;
+  mapped_file.size           = (u64)size;
+  mapped_file.allocated_size = (u64)size;
+  if (!map_file_window((u64)size - ((u64)size % LOGS_MMAP_FILE_EXTENT_SIZE)))
+  {
+    file_syscall(FTRUNCATE_SYSCALL, fd, mapped_file.size, 0, 0, 0, 0);
+  }
+}
+
+
+// Unmap the file output before it is closed, and truncate it to the size of its logs
+static void unmap_file_output(void)
+{
+  if (mapped_file.window != 0)
+  {
+    file_syscall(MUNMAP_SYSCALL, (u64)mapped_file.window, LOGS_MMAP_FILE_EXTENT_SIZE, 0, 0, 0, 0);
+    mapped_file.window = 0;
+    file_syscall(FTRUNCATE_SYSCALL, mapped_file.fd, mapped_file.size, 0, 0, 0, 0);
+  }
+}
+
+
+// Returns the count of bytes appended, less than data_size if the next window can't be mapped
+static u64 append_to_mapped_file(const u8* data, u64 data_size)
+{
+  u64 appended_size = 0;
+  while (appended_size != data_size)
+  {
+    u64 window_idx = mapped_file.size - mapped_file.window_offset;
+    if (window_idx == LOGS_MMAP_FILE_EXTENT_SIZE)
+    {
+      if (!map_file_window(mapped_file.window_offset + LOGS_MMAP_FILE_EXTENT_SIZE))
+      {
+        // The rest is appended by write syscalls, after the logs already in the file
+        file_syscall(FTRUNCATE_SYSCALL, mapped_file.fd, mapped_file.size, 0, 0, 0, 0);
+        break;
+      }
+      window_idx = 0;
+    }
+
+    const u64 window_room = LOGS_MMAP_FILE_EXTENT_SIZE - window_idx;
+    const u64 data_left   = data_size - appended_size;
+    const u64 chunk_size  = (data_left < window_room) ? data_left : window_room;
+    copy_bytes(mapped_file.window + window_idx, data + appended_size, chunk_size);
+
+    mapped_file.size += chunk_size;
+    appended_size    += chunk_size;
+  }
+
+  return appended_size;
+}
+#endif
+
+
+#if defined(LOGS_OS_LINUX) && defined(LOGS_FILE_ROTATION) && (LOGS_FILE_ROTATION != 0)
+// File output rotation (see rotate_file_output_if_due()). The file output's descriptor never
+// changes, the next file is swapped in its place. Only the thread writing to the file output uses
+// this state: the flushing one, or the writer thread with LOGS_ASYNC_FLUSH
+#  define ROTATED_FILE_MAX_SUFFIX_SIZE 21 // ".next", or '.' and up to 20 digits
+
+static struct
+{
+  // Size of the file output, and count of flushes to it, since it was opened or rotated
+  u64 size;
+  u64 flush_count;
+
+  // 0 while the file output is closed, or if its path is too long to build the rotated names
+  u32 fd;
+
+  // Next file, opened and preallocated in advance under path.next, or 0 if it couldn't be
+  u32 spare_fd;
+
+  char path[LOGS_FILE_ROTATION_MAX_PATH_SIZE];
+  u64  path_size;
+  char names[2][LOGS_FILE_ROTATION_MAX_PATH_SIZE + ROTATED_FILE_MAX_SUFFIX_SIZE];
+} file_rotation;
+#endif
+
+
+static inline void write_to_output(u32 output, const u8* data, u64 data_size)
+{
+#if defined(LOGS_OS_LINUX) && defined(LOGS_MMAP_FILE) && (LOGS_MMAP_FILE != 0)
+  if ((mapped_file.window != 0) && (output == mapped_file.fd))
+  {
+    const u64 appended_size = append_to_mapped_file(data, data_size);
+    if (appended_size == data_size)
+    {
+      return;
+    }
+
+    data      += appended_size;
+    data_size -= appended_size;
+  }
+#endif
+
+#if defined(LOGS_OS_WINDOWS)
+  HANDLE handle = (HANDLE)(u64)output;
+  WriteFile(handle, data, (u32)data_size, 0, 0);
+#elif defined(LOGS_OS_LINUX)
+  register u64       write_syscall_rax __asm__("rax") = 1;
+  register u32       output_rdi        __asm__("rdi") = output;
+  register const u8* data_rsi          __asm__("rsi") = data;
+  register u64       data_size_rdx     __asm__("rdx") = data_size;
+  __asm__ __volatile__ ("syscall" :
+                        "+r"(write_syscall_rax) :
+                        "r"(output_rdi), "r"(data_rsi), "r"(data_size_rdx) :
+                        "rcx", "r11", "memory");
+#endif
+
+#if defined(LOGS_OS_LINUX) && defined(LOGS_FILE_ROTATION) && (LOGS_FILE_ROTATION != 0)
+  file_rotation.size += (output == file_rotation.fd) ? data_size : 0;
+#endif
+}
+
+
+#if defined(LOGS_OS_LINUX) && ((defined(LOGS_SHARED_RING) && (LOGS_SHARED_RING != 0)) || \
+                               (defined(LOGS_ZERO_COPY) && (LOGS_ZERO_COPY != 0))     || \
+                               (defined(LOGS_OUTPUT_LEVELS) && (LOGS_OUTPUT_LEVELS != 0)))
+#  define WRITEV_SYSCALL 20
+
+// struct iovec of <sys/uio.h>
+struct linux_iovec
+{
+  const u8* base;
+  u64       size;
+};
+
+
+static inline s64 writev_syscall(u32 output, const struct linux_iovec* iovecs, u64 iovec_count)
+{
+  register u64                       writev_syscall_rax __asm__("rax") = WRITEV_SYSCALL;
+  register u32                       output_rdi         __asm__("rdi") = output;
+  register const struct linux_iovec* iovecs_rsi         __asm__("rsi") = iovecs;
+  register u64                       iovec_count_rdx    __asm__("rdx") = iovec_count;
+  s64 result;
+  __asm__ __volatile__ ("syscall" :
+                        "=a"(result) :
+                        "r"(writev_syscall_rax), "r"(output_rdi), "r"(iovecs_rsi),
+                        "r"(iovec_count_rdx) :
+                        "rcx", "r11", "memory");
+  return result;
+}
+
+static inline s64 write_syscall(u32 output, const u8* data, u64 data_size)
+{
+  register u64       write_syscall_rax __asm__("rax") = 1;
+  register u32       output_rdi        __asm__("rdi") = output;
+  register const u8* data_rsi          __asm__("rsi") = data;
+  register u64       data_size_rdx     __asm__("rdx") = data_size;
+  s64 result;
+  __asm__ __volatile__ ("syscall" :
+                        "=a"(result) :
+                        "r"(write_syscall_rax), "r"(output_rdi), "r"(data_rsi), "r"(data_size_rdx) :
+                        "rcx", "r11", "memory");
+  return result;
+}
+
+
+// Write scattered data to an output with a single writev syscall, unless it writes less: writing
+// then resumes after the last byte written, until all the data is written or an error occurs
+static inline void writev_to_output(u32 output, const struct linux_iovec* iovecs, u64 iovec_count)
+{
+#  if defined(LOGS_MMAP_FILE) && (LOGS_MMAP_FILE != 0)
+  if ((mapped_file.window != 0) && (output == mapped_file.fd))
+  {
+    for (u64 i = 0; i < iovec_count; i++)
+    {
+      write_to_output(output, iovecs[i].base, iovecs[i].size);
+    }
+    return;
+  }
+#  endif
+
+  for (u64 iovec_idx = 0; iovec_idx < iovec_count;)
+  {
+    s64 result = writev_syscall(output, iovecs + iovec_idx, iovec_count - iovec_idx);
+    if (result <= 0)
+    {
+      break;
+    }
+
+    u64 written_size = (u64)result;
+    for (; (iovec_idx < iovec_count) && (written_size >= iovecs[iovec_idx].size); iovec_idx++)
+    {
+      written_size -= iovecs[iovec_idx].size;
+    }
+
+    if (written_size != 0)
+    {
+      // The rest of a partially written buffer is written on its own
+      while ((result > 0) && (written_size < iovecs[iovec_idx].size))
+      {
+        result = write_syscall(output, iovecs[iovec_idx].base + written_size,
+                               iovecs[iovec_idx].size - written_size);
+        written_size += (result > 0) ? (u64)result : 0;
+      }
+
+      if (result <= 0)
+      {
+        break;
+      }
+
+      iovec_idx++;
+    }
+  }
+
+#  if defined(LOGS_FILE_ROTATION) && (LOGS_FILE_ROTATION != 0)
+  if (output == file_rotation.fd)
+  {
+    for (u64 i = 0; i < iovec_count; i++)
+    {
+      file_rotation.size += iovecs[i].size;
+    }
+  }
+#  endif
+}
+#endif
+
+
+#if defined(LOGS_OS_LINUX) && defined(LOGS_IO_URING) && (LOGS_IO_URING != 0)
+// io_uring flush backend. Writes to all outputs are queued in a ring shared with the kernel, and
+// submitted with a single io_uring_enter syscall. Structures and constants below are those of
+// <linux/io_uring.h>, which isn't included to keep away from the C standard library headers
+#  define IO_URING_SETUP_SYSCALL   425
+#  define IO_URING_ENTER_SYSCALL   426
+#  define MMAP_SYSCALL             9
+#  define MUNMAP_SYSCALL           11
+#  define CLOSE_SYSCALL            3
+#  define IORING_OFF_SQ_RING       0x0ull
+#  define IORING_OFF_CQ_RING       0x8000000ull
+#  define IORING_OFF_SQES          0x10000000ull
+#  define IORING_FEAT_SINGLE_MMAP  0x1
+#  define IORING_OP_WRITE          23
+#  define IOSQE_ASYNC              0x10
+#  define IORING_ENTER_GETEVENTS   0x1
+#  define PROT_READ_WRITE          0x3
+#  define MAP_SHARED_POPULATE      0x8001
+#  define EINTR                    4
+
+struct io_sqring_offsets
+{
+  u32 head;
+  u32 tail;
+  u32 ring_mask;
+  u32 ring_entries;
+  u32 flags;
+  u32 dropped;
+  u32 array;
+  u32 resv1;
+  u64 user_addr;
+};
+
+struct io_cqring_offsets
+{
+  u32 head;
+  u32 tail;
+  u32 ring_mask;
+  u32 ring_entries;
+  u32 overflow;
+  u32 cqes;
+  u32 flags;
+  u32 resv1;
+  u64 user_addr;
+};
+
+struct io_uring_params
+{
+  u32                      sq_entries;
+  u32                      cq_entries;
+  u32                      flags;
+  u32                      sq_thread_cpu;
+  u32                      sq_thread_idle;
+  u32                      features;
+  u32                      wq_fd;
+  u32                      resv[3];
+  struct io_sqring_offsets sq_off;
+  struct io_cqring_offsets cq_off;
+};
+
+// Submission queue entry, only with the fields used by IORING_OP_WRITE
+struct io_uring_sqe
+{
+  u8  opcode;
+  u8  flags;
+  u16 ioprio;
+  s32 fd;
+  u64 off;
+  u64 addr;
+  u32 len;
+  u32 rw_flags;
+  u64 user_data;
+  u64 pad[3];
+};
+
+// Completion queue entry
+struct io_uring_cqe
+{
+  u64 user_data;
+  s32 res;
+  u32 flags;
+};
+
+enum io_uring_state
+{
+  IO_URING_NOT_SET_UP = 0,
+  IO_URING_READY      = 1,
+  IO_URING_FAILED     = 2 // flushes fall back to write syscalls
+};
+
+static struct
+{
+  u32                  state;
+  s32                  fd;
+  logs_flush_mode      flush_mode;
+
+  // Submission queue
+  u32*                 sq_tail;
+  u32*                 sq_array;
+  u32                  sq_mask;
+  struct io_uring_sqe* sqes;
+
+  // Completion queue
+  u32*                 cq_head;
+  u32*                 cq_tail;
+  u32                  cq_mask;
+  struct io_uring_cqe* cqes;
+
+  // Writes submitted but not reaped yet (LOGS_FLUSH_IO_URING_ASYNC only), and the data they write
+  u32                  pending_write_count;
+  const u8*            pending_data;
+  u64                  pending_data_size;
+} io_uring =
+{
+  .flush_mode = LOGS_FLUSH_IO_URING
+};
+
+// Asynchronous writes read from this copy of the logs buffer, which the next log_* calls don't
+// modify
+static u8 io_uring_write_buffer[LOGS_BUFFER_SIZE];
+
+
+static inline s64 io_uring_setup(u32 entry_count, struct io_uring_params* params)
+{
+  register u64                     setup_syscall_rax __asm__("rax") = IO_URING_SETUP_SYSCALL;
+  register u64                     entry_count_rdi   __asm__("rdi") = entry_count;
+  register struct io_uring_params* params_rsi        __asm__("rsi") = params;
+  s64 result;
+  __asm__ __volatile__ ("syscall" :
+                        "=a"(result) :
+                        "r"(setup_syscall_rax), "r"(entry_count_rdi), "r"(params_rsi) :
+                        "rcx", "r11", "memory");
+  return result;
+}
+
+static inline s64 io_uring_enter(u32 to_submit, u32 min_complete, u32 flags)
+{
+  register u64 enter_syscall_rax __asm__("rax") = IO_URING_ENTER_SYSCALL;
+  register u64 fd_rdi            __asm__("rdi") = (u64)io_uring.fd;
+  register u64 to_submit_rsi     __asm__("rsi") = to_submit;
+  register u64 min_complete_rdx  __asm__("rdx") = min_complete;
+  register u64 flags_r10         __asm__("r10") = flags;
+  register u64 sig_r8            __asm__("r8")  = 0;
+  register u64 sig_size_r9       __asm__("r9")  = 0;
+  s64 result;
+  __asm__ __volatile__ ("syscall" :
+                        "=a"(result) :
+                        "r"(enter_syscall_rax), "r"(fd_rdi), "r"(to_submit_rsi),
+                        "r"(min_complete_rdx), "r"(flags_r10), "r"(sig_r8), "r"(sig_size_r9) :
+                        "rcx", "r11", "memory");
+  return result;
+}
+
+// Map a ring of the io_uring instance. Returns 0 on failure
+static inline u8* io_uring_mmap(u64 size, u64 offset)
+{
+  register u64 mmap_syscall_rax __asm__("rax") = MMAP_SYSCALL;
+  register u64 addr_rdi         __asm__("rdi") = 0;
+  register u64 size_rsi         __asm__("rsi") = size;
+  register u64 prot_rdx         __asm__("rdx") = PROT_READ_WRITE;
+  register u64 flags_r10        __asm__("r10") = MAP_SHARED_POPULATE;
+  register u64 fd_r8            __asm__("r8")  = (u64)io_uring.fd;
+  register u64 offset_r9        __asm__("r9")  = offset;
+  s64 result;
+  __asm__ __volatile__ ("syscall" :
+                        "=a"(result) :
+                        "r"(mmap_syscall_rax), "r"(addr_rdi), "r"(size_rsi), "r"(prot_rdx),
+                        "r"(flags_r10), "r"(fd_r8), "r"(offset_r9) :
+                        "rcx", "r11", "memory");
+
+  // Errors are returned as -errno, in [-4095; -1]
+  return ((u64)result > (u64)-4096) ? 0 : (u8*)result;
+}
+
+static inline void io_uring_munmap(u8* ring, u64 size)
+{
+  register u64 munmap_syscall_rax __asm__("rax") = MUNMAP_SYSCALL;
+  register u8* addr_rdi           __asm__("rdi") = ring;
+  register u64 size_rsi           __asm__("rsi") = size;
+  __asm__ __volatile__ ("syscall" :
+                        "+r"(munmap_syscall_rax) :
+                        "r"(addr_rdi), "r"(size_rsi) :
+                        "rcx", "r11", "memory");
+}
+
+static inline void io_uring_close(void)
+{
+  register u64 close_syscall_rax __asm__("rax") = CLOSE_SYSCALL;
+  register u64 fd_rdi            __asm__("rdi") = (u64)io_uring.fd;
+  __asm__ __volatile__ ("syscall" :
+                        "+r"(close_syscall_rax) :
+                        "r"(fd_rdi) :
+                        "rcx", "r11", "memory");
+}
+
+static void setup_io_uring(void)
+{
+  // Static to stay clear of the stack, which _start leaves misaligned for SSE stores
+  static struct io_uring_params params;
+
+  io_uring.state = IO_URING_FAILED;
+  const s64 fd   = io_uring_setup(LOGS_OUTPUT_COUNT, &params);
+  if (fd < 0)
+  {
+    return;
+  }
+
+  io_uring.fd = (s32)fd;
+
+  // Since Linux 5.4, both queues share a single mapping
+  const u64 sq_ring_size = params.sq_off.array + (params.sq_entries * sizeof(u32));
+  const u64 cq_ring_size = params.cq_off.cqes  + (params.cq_entries * sizeof(struct io_uring_cqe));
+  const u64 is_single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+  const u64 sq_map_size    = (is_single_mmap && (cq_ring_size > sq_ring_size)) ? cq_ring_size :
+                                                                                 sq_ring_size;
+  const u64 sqes_size      = params.sq_entries * sizeof(struct io_uring_sqe);
+  u8* const sq_ring        = io_uring_mmap(sq_map_size, IORING_OFF_SQ_RING);
+  u8* const cq_ring        = is_single_mmap ? sq_ring :
+                                              io_uring_mmap(cq_ring_size, IORING_OFF_CQ_RING);
+  u8* const sqes           = io_uring_mmap(sqes_size, IORING_OFF_SQES);
+  if ((sq_ring == 0) || (cq_ring == 0) || (sqes == 0))
+  {
+    // Release what was set up, flushes fall back to write syscalls
+    if (sq_ring != 0)
+    {
+      io_uring_munmap(sq_ring, sq_map_size);
+    }
+
+    if ((cq_ring != 0) && !is_single_mmap)
+    {
+      io_uring_munmap(cq_ring, cq_ring_size);
+    }
+
+    if (sqes != 0)
+    {
+      io_uring_munmap(sqes, sqes_size);
+    }
+
+    io_uring_close();
+    return;
+  }
+
+  io_uring.sq_tail  = (u32*)(sq_ring + params.sq_off.tail);
+  io_uring.sq_array = (u32*)(sq_ring + params.sq_off.array);
+  io_uring.sq_mask  = *(u32*)(sq_ring + params.sq_off.ring_mask);
+  io_uring.sqes     = (struct io_uring_sqe*)sqes;
+  io_uring.cq_head  = (u32*)(cq_ring + params.cq_off.head);
+  io_uring.cq_tail  = (u32*)(cq_ring + params.cq_off.tail);
+  io_uring.cq_mask  = *(u32*)(cq_ring + params.cq_off.ring_mask);
+  io_uring.cqes     = (struct io_uring_cqe*)(cq_ring + params.cq_off.cqes);
+  io_uring.state    = IO_URING_READY;
+}
+
+// Wait for the pending writes to complete and consume their completion entries. Writes that failed
+// or were cut short are finished with write syscalls. If waiting fails, io_uring isn't used for
+// later flushes
+static void reap_io_uring_writes(void)
+{
+  const u32 pending_write_count = io_uring.pending_write_count;
+  if (pending_write_count == 0)
+  {
+    return;
+  }
+
+  u32 cq_head = *io_uring.cq_head;
+  u32 cq_tail = __atomic_load_n(io_uring.cq_tail, __ATOMIC_ACQUIRE);
+  while ((cq_tail - cq_head) < pending_write_count)
+  {
+    const s64 result = io_uring_enter(0, pending_write_count, IORING_ENTER_GETEVENTS);
+    if ((result < 0) && (result != -EINTR))
+    {
+      // Completions can't be waited for anymore. Only those already posted are consumed, the other
+      // writes are reaped by later calls if they complete, while flushes use write syscalls
+      io_uring.state = IO_URING_FAILED;
+      break;
+    }
+
+    cq_tail = __atomic_load_n(io_uring.cq_tail, __ATOMIC_ACQUIRE);
+  }
+
+  const u32 posted_count    = cq_tail - cq_head;
+  const u32 completed_count = (posted_count < pending_write_count) ? posted_count :
+                                                                     pending_write_count;
+  for (u32 i = 0; i < completed_count; i++)
+  {
+    const struct io_uring_cqe* cqe = io_uring.cqes + (cq_head & io_uring.cq_mask);
+    const u64 written_size = (cqe->res > 0) ? (u64)cqe->res : 0;
+    if (written_size < io_uring.pending_data_size)
+    {
+      write_to_output((u32)cqe->user_data,
+                      io_uring.pending_data + written_size,
+                      io_uring.pending_data_size - written_size);
+    }
+
+    cq_head += 1;
+  }
+
+  __atomic_store_n(io_uring.cq_head, cq_head, __ATOMIC_RELEASE);
+  io_uring.pending_write_count = pending_write_count - completed_count;
+}
+
+// Write the logs buffer to the open outputs in [first_output_idx; end_output_idx[ with a single
+// io_uring_enter syscall. In LOGS_FLUSH_IO_URING mode, it waits for the writes to complete. In
+// LOGS_FLUSH_IO_URING_ASYNC mode, the buffer is copied and the writes are only waited for by the
+// next flush
+static void flush_with_io_uring(u64 first_output_idx, u64 end_output_idx)
+{
+  if (io_uring.state == IO_URING_NOT_SET_UP)
+  {
+    setup_io_uring();
+  }
+
+  reap_io_uring_writes();
+
+  if (io_uring.state != IO_URING_READY)
+  {
+    for (u64 i = first_output_idx; i < end_output_idx; i++)
+    {
+      u32 output = logs.outputs[i];
+      if (output != 0)
+      {
+        write_to_output(output, logs.buffer, logs.buffer_end_idx);
+      }
+    }
+
+    return;
+  }
+
+  const u64 is_async  = io_uring.flush_mode == LOGS_FLUSH_IO_URING_ASYNC;
+  const u8* data      = logs.buffer;
+  const u64 data_size = logs.buffer_end_idx;
+  if (is_async)
+  {
+    copy_bytes(io_uring_write_buffer, logs.buffer, data_size);
+    data = io_uring_write_buffer;
+  }
+
+  // Without IOSQE_ASYNC, the kernel first attempts writes from the submitting thread, which for
+  // regular files means copying to the page cache before io_uring_enter returns. Asynchronous
+  // writes are handed to kernel worker threads instead
+  const u8 sqe_flags   = is_async ? IOSQE_ASYNC : 0;
+  u32      sq_tail     = *io_uring.sq_tail;
+  u32      write_count = 0;
+  for (u64 i = first_output_idx; i < end_output_idx; i++)
+  {
+    u32 output = logs.outputs[i];
+    if (output != 0)
+    {
+      const u32            sqe_idx = sq_tail & io_uring.sq_mask;
+      struct io_uring_sqe* sqe     = io_uring.sqes + sqe_idx;
+      sqe->opcode    = IORING_OP_WRITE;
+      sqe->flags     = sqe_flags;
+      sqe->ioprio    = 0;
+      sqe->fd        = (s32)output;
+      sqe->off       = (u64)-1; // at the current file position
+      sqe->addr      = (u64)data;
+      sqe->len       = (u32)data_size;
+      sqe->rw_flags  = 0;
+      sqe->user_data = output;
+
+      io_uring.sq_array[sqe_idx] = sqe_idx;
+      sq_tail     += 1;
+      write_count += 1;
+    }
+  }
+
+  if (write_count == 0)
+  {
+    return;
+  }
+
+  __atomic_store_n(io_uring.sq_tail, sq_tail, __ATOMIC_RELEASE);
+  io_uring.pending_write_count = write_count;
+  io_uring.pending_data        = data;
+  io_uring.pending_data_size   = data_size;
+
+  const u32 min_complete = is_async ? 0 : write_count;
+  const u32 flags        = is_async ? 0 : IORING_ENTER_GETEVENTS;
+  const s64 result       = io_uring_enter(write_count, min_complete, flags);
+  if (result < 0)
+  {
+    // Nothing was submitted. Stop using io_uring rather than leaving the entries in the ring
+    io_uring.state               = IO_URING_FAILED;
+    io_uring.pending_write_count = 0;
+    for (u64 i = first_output_idx; i < end_output_idx; i++)
+    {
+      u32 output = logs.outputs[i];
+      if (output != 0)
+      {
+        write_to_output(output, data, data_size);
+      }
+    }
+  }
+  else if (!is_async)
+  {
+    reap_io_uring_writes();
+  }
+}
+#endif
+
+
+#if defined(LOGS_OS_LINUX) && defined(LOGS_PER_THREAD) && (LOGS_PER_THREAD != 0)
+#  define ARCH_PRCTL_SYSCALL 158
+#  define ARCH_SET_GS        0x1001
+#  define ARCH_GET_GS        0x1004
+#endif
+
+
+#if defined(LOGS_OS_LINUX) && defined(LOGS_PER_THREAD) && (LOGS_PER_THREAD != 0) && \
+    (!defined(LOGS_SHARED_RING) || (LOGS_SHARED_RING == 0))
+// Incomplete last lines up to this size are kept in the buffer by flushes. Longer ones are flushed
+// as is, so that they can't crowd the buffer out
+#  define MAX_KEPT_LINE_SIZE (LOGS_BUFFER_SIZE / 2)
+
+// Size of the complete lines at the start of the buffer, up to its last line feed. The whole buffer
+// if the last line is longer than MAX_KEPT_LINE_SIZE
+static inline u64 complete_lines_size(void)
+{
+  const u8* buffer     = logs.buffer;
+  const u64 size       = logs.buffer_end_idx;
+  const u64 search_end = (size > MAX_KEPT_LINE_SIZE) ? (size - MAX_KEPT_LINE_SIZE) : 0;
+  for (u64 i = size; i != search_end; i--)
+  {
+    if (buffer[i - 1] == '\n')
+    {
+      return i;
+    }
+  }
+
+  return (search_end != 0) ? size : 0;
+}
+
+
+// Write the first byte_count bytes of the calling thread's buffer to the open outputs in
+// [first_output_idx; end_output_idx[, each with a single write syscall, and move the bytes left
+// to the start of the buffer
+static void flush_thread_buffer(u64 first_output_idx, u64 end_output_idx, u64 byte_count)
+{
+  logs_thread* thread_logs = &logs;
+  for (u64 i = first_output_idx; i < end_output_idx; i++)
+  {
+    u32 output = thread_logs->outputs[i];
+    if ((output != 0) && (byte_count != 0))
+    {
+      write_to_output(output, thread_logs->buffer, byte_count);
+    }
+  }
+
+  // copy_bytes() copies forward, and its small sizes load all bytes before storing them, so the
+  // kept bytes can be moved to the start of the buffer even if both ranges overlap
+  const u64 kept_size = thread_logs->buffer_end_idx - byte_count;
+  copy_bytes(thread_logs->buffer, thread_logs->buffer + byte_count, kept_size);
+
+  thread_logs->buffer_end_idx = kept_size;
+}
+#endif
+
+
+#if defined(LOGS_OS_LINUX) && defined(LOGS_SHARED_RING) && (LOGS_SHARED_RING != 0)
+// Lock-free ring shared by all threads. Positions in the ring only grow: a record at position p is
+// stored at ring_storage[p % LOGS_BUFFER_SIZE], possibly past LOGS_BUFFER_SIZE so that it remains
+// contiguous. Positions [drained_position; reserved_position[ hold records being formatted or not
+// yet written, and span at most LOGS_BUFFER_SIZE bytes. Records start with a header, whose
+// position is stored last to commit them: stale headers from the previous turns of the ring hold
+// other positions, and zeroed ones none, as committed positions are stored plus 1. Flushing
+// threads claim batches of records under consumer_lock, then write them without holding it.
+// In LOGS_PER_CPU mode, there is one such ring per CPU, whose reserved_position is only advanced
+// by restartable sequences running on that CPU, followed by the shared ring
+#  if defined(LOGS_PER_CPU) && (LOGS_PER_CPU != 0) && (LOGS_PER_CPU_TIMESTAMPS != 0)
+#    define RING_HEADER_SIZE       24
+#  else
+#    define RING_HEADER_SIZE       16
+#  endif
+#  define RING_MAX_RECORD_SPAN     ((RING_HEADER_SIZE + LOGS_SHARED_RING_MAX_RECORD_SIZE + \
+                                     LOGS_BUFFER_PADDING + 7) & ~7ull)
+#  define RING_RECORDS_PER_WRITEV  64
+#  define RING_BATCH_COUNT         4
+#  define SCHED_YIELD_SYSCALL      24
+#  define RING_SPIN_COUNT          128
+#  if defined(LOGS_PER_CPU) && (LOGS_PER_CPU != 0)
+#    define RING_COUNT             (LOGS_PER_CPU_MAX_CPU_COUNT + 1)
+#  else
+#    define RING_COUNT             1
+#  endif
+#  define SHARED_RING_IDX          (RING_COUNT - 1)
+
+#  if (LOGS_BUFFER_SIZE % 8) != 0
+#    error "LOGS_SHARED_RING requires LOGS_BUFFER_SIZE to be a multiple of 8"
+#  endif
+#  if LOGS_BUFFER_SIZE < RING_MAX_RECORD_SPAN
+#    error "LOGS_BUFFER_SIZE must hold a record of LOGS_SHARED_RING_MAX_RECORD_SIZE bytes"
+#  endif
+#  if LOGS_SHARED_RING_MAX_RECORD_SIZE < F64_MAX_SIZED_DEC_STR_SIZE
+#    error "LOGS_SHARED_RING_MAX_RECORD_SIZE must leave room for the largest formatted number"
+#  endif
+
+// record_size of a thread's struct logs while appends still go to its record
+#  define RING_RECORD_NOT_FULL     (~0ull)
+
+struct ring_header
+{
+  // Position of the record plus 1 once committed
+  u64 committed_position;
+
+  // Size of the record, header and padding included, and size of its logs
+  u32 span;
+  u32 size;
+
+#  if defined(LOGS_PER_CPU) && (LOGS_PER_CPU != 0) && (LOGS_PER_CPU_TIMESTAMPS != 0)
+  // Time-stamp counter when the record was reserved, which orders the records of all rings
+  u64 timestamp;
+#  endif
+};
+
+static _Alignas(64) u8 ring_storage[RING_COUNT][LOGS_BUFFER_SIZE + RING_MAX_RECORD_SPAN];
+
+static struct
+{
+  // Claimed by producers with atomic operations, or by restartable sequences on per-CPU rings
+  _Alignas(64) u64 reserved_position;
+
+  // Advanced by the thread releasing a batch of records, once they are written
+  _Alignas(64) u64 drained_position;
+
+  // Advanced by the thread holding consumer_lock, when it claims a batch of records
+  u64 claimed_position;
+} rings[RING_COUNT];
+
+// Records claimed by a flushing thread, which it writes and releases without holding consumer_lock
+struct ring_batch
+{
+  struct linux_iovec iovecs[RING_RECORDS_PER_WRITEV];
+  u64                iovec_count;
+  u64                record_count;
+
+  // Positions following the claimed records in each ring
+  u64                positions[RING_COUNT];
+
+  // Number of the batch among the claimed ones
+  u64                idx;
+};
+
+static struct
+{
+  u32 consumer_lock;
+  u64 dropped_byte_count;
+
+  // Batches of records claimed with consumer_lock held, and released since in the same order. The
+  // batch numbered n is stored in batches[n % RING_BATCH_COUNT] until it is released
+  u64                            claimed_batch_count;
+  _Alignas(64) u64               released_batch_count;
+  _Alignas(64) struct ring_batch batches[RING_BATCH_COUNT];
+} ring;
+
+
+static inline struct ring_header* ring_header_at(u64 ring_idx, u64 position)
+{
+  return (struct ring_header*)(ring_storage[ring_idx] + (position % LOGS_BUFFER_SIZE));
+}
+
+// Whether the positions up to end_position are free, i.e. were drained on the previous turn. The
+// difference is signed, as threads which failed to reserve a record in a per-CPU ring wait for
+// room without holding positions, which may thus be drained past meanwhile
+static inline u64 ring_has_room_until(u64 ring_idx, u64 end_position)
+{
+  u64 drained_position = __atomic_load_n(&rings[ring_idx].drained_position, __ATOMIC_ACQUIRE);
+  return (s64)(end_position - drained_position) <= LOGS_BUFFER_SIZE;
+}
+
+// The header of the record at position if it is committed, 0 otherwise
+static inline struct ring_header* committed_ring_record(u64 ring_idx, u64 position)
+{
+  struct ring_header* header = ring_header_at(ring_idx, position);
+  return (__atomic_load_n(&header->committed_position, __ATOMIC_ACQUIRE) == (position + 1)) ?
+         header : 0;
+}
+
+// Pause a waiting thread, which yields its CPU after RING_SPIN_COUNT attempts, in case the thread
+// it waits for was preempted
+static inline void wait_for_ring_progress(u64 attempt)
+{
+  if (attempt < RING_SPIN_COUNT)
+  {
+    _mm_pause();
+  }
+  else
+  {
+    register u64 sched_yield_syscall_rax __asm__("rax") = SCHED_YIELD_SYSCALL;
+    __asm__ __volatile__ ("syscall" :
+                          "+r"(sched_yield_syscall_rax) : :
+                          "rcx", "r11", "memory");
+  }
+}
+
+// Take consumer_lock if it is free and a batch can be claimed, i.e. its slot was released.
+// consumer_lock is only held to claim records, never across syscalls
+static inline u64 try_lock_ring_consumer(void)
+{
+  if (__atomic_exchange_n(&ring.consumer_lock, 1, __ATOMIC_ACQUIRE) != 0)
+  {
+    return 0;
+  }
+
+  if ((ring.claimed_batch_count - __atomic_load_n(&ring.released_batch_count, __ATOMIC_ACQUIRE)) ==
+      RING_BATCH_COUNT)
+  {
+    __atomic_store_n(&ring.consumer_lock, 0, __ATOMIC_RELEASE);
+    return 0;
+  }
+
+  return 1;
+}
+
+static inline void lock_ring_consumer(void)
+{
+  for (u64 attempt = 0; !try_lock_ring_consumer(); attempt++)
+  {
+    wait_for_ring_progress(attempt);
+  }
+}
+
+static inline void unlock_ring_consumer(void)
+{
+  __atomic_store_n(&ring.consumer_lock, 0, __ATOMIC_RELEASE);
+}
+
+
+// Start the next batch at the claimed_position of each ring. Called with consumer_lock held
+static inline struct ring_batch* begin_ring_batch(void)
+{
+  struct ring_batch* batch = &ring.batches[ring.claimed_batch_count % RING_BATCH_COUNT];
+  batch->iovec_count  = 0;
+  batch->record_count = 0;
+  for (u64 i = 0; i < RING_COUNT; i++)
+  {
+    batch->positions[i] = rings[i].claimed_position;
+  }
+
+  return batch;
+}
+
+
+// Claim the records added to a batch, even if there are none so that it is released in turn.
+// Called with consumer_lock held
+static inline void end_ring_batch(struct ring_batch* batch)
+{
+  for (u64 i = 0; i < RING_COUNT; i++)
+  {
+    rings[i].claimed_position = batch->positions[i];
+  }
+
+  batch->idx = ring.claimed_batch_count;
+  ring.claimed_batch_count++;
+}
+
+
+#  if defined(LOGS_PER_CPU) && (LOGS_PER_CPU != 0) && (LOGS_PER_CPU_TIMESTAMPS != 0)
+// Records are merged in the order of their timestamps, among the first committed one of each ring,
+// which a min-heap of ring indices keeps sorted. A ring leaves the heap at its first record which
+// isn't committed. Only used by the thread holding consumer_lock
+static struct
+{
+  struct ring_header* heads[RING_COUNT];
+  u32                 ring_idxs[RING_COUNT];
+  u64                 count;
+} ring_merge;
+
+
+// Move the ring at heap_idx down the merge heap, until the timestamps of its children's heads are
+// at least the timestamp of its head
+static void sift_down_ring_merge(u64 heap_idx)
+{
+  const u32 ring_idx  = ring_merge.ring_idxs[heap_idx];
+  const u64 timestamp = ring_merge.heads[ring_idx]->timestamp;
+  for (;;)
+  {
+    u64 child_idx = (2 * heap_idx) + 1;
+    if (child_idx >= ring_merge.count)
+    {
+      break;
+    }
+
+    if (((child_idx + 1) < ring_merge.count) &&
+        (ring_merge.heads[ring_merge.ring_idxs[child_idx + 1]]->timestamp <
+         ring_merge.heads[ring_merge.ring_idxs[child_idx]]->timestamp))
+    {
+      child_idx++;
+    }
+
+    if (ring_merge.heads[ring_merge.ring_idxs[child_idx]]->timestamp >= timestamp)
+    {
+      break;
+    }
+
+    ring_merge.ring_idxs[heap_idx] = ring_merge.ring_idxs[child_idx];
+    heap_idx                       = child_idx;
+  }
+
+  ring_merge.ring_idxs[heap_idx] = ring_idx;
+}
+
+
+// Build the merge heap from the rings whose record at the batch's position is committed
+static void init_ring_merge(const struct ring_batch* batch)
+{
+  ring_merge.count = 0;
+  for (u64 i = 0; i < RING_COUNT; i++)
+  {
+    ring_merge.heads[i] = committed_ring_record(i, batch->positions[i]);
+    if (ring_merge.heads[i] != 0)
+    {
+      ring_merge.ring_idxs[ring_merge.count] = (u32)i;
+      ring_merge.count++;
+    }
+  }
+
+  for (u64 heap_idx = ring_merge.count / 2; heap_idx != 0; heap_idx--)
+  {
+    sift_down_ring_merge(heap_idx - 1);
+  }
+}
+
+
+// Replace the head of the ring at the top of the merge heap by its record at position, or remove
+// the ring from the heap if that record isn't committed
+static void advance_ring_merge(u64 ring_idx, u64 position)
+{
+  ring_merge.heads[ring_idx] = committed_ring_record(ring_idx, position);
+  if (ring_merge.heads[ring_idx] == 0)
+  {
+    ring_merge.count--;
+    ring_merge.ring_idxs[0] = ring_merge.ring_idxs[ring_merge.count];
+  }
+
+  if (ring_merge.count != 0)
+  {
+    sift_down_ring_merge(0);
+  }
+}
+#  endif
+
+
+// Add up to RING_RECORDS_PER_WRITEV committed records following the claimed_position of each ring
+// to the next batch, and claim them. Called with consumer_lock held
+static struct ring_batch* claim_ring_records(void)
+{
+  struct ring_batch* batch = begin_ring_batch();
+
+#  if defined(LOGS_PER_CPU) && (LOGS_PER_CPU != 0) && (LOGS_PER_CPU_TIMESTAMPS != 0)
+  init_ring_merge(batch);
+#  endif
+
+  u64 ring_idx = 0;
+  for (; batch->record_count < RING_RECORDS_PER_WRITEV; batch->record_count++)
+  {
+    struct ring_header* header = 0;
+#  if defined(LOGS_PER_CPU) && (LOGS_PER_CPU != 0) && (LOGS_PER_CPU_TIMESTAMPS != 0)
+    if (ring_merge.count != 0)
+    {
+      ring_idx = ring_merge.ring_idxs[0];
+      header   = ring_merge.heads[ring_idx];
+    }
+#  else
+    // Rings are written one after the other
+    for (; ring_idx < RING_COUNT; ring_idx++)
+    {
+      header = committed_ring_record(ring_idx, batch->positions[ring_idx]);
+      if (header != 0)
+      {
+        break;
+      }
+    }
+#  endif
+    if (header == 0)
+    {
+      break;
+    }
+
+    if (header->size != 0)
+    {
+      batch->iovecs[batch->iovec_count].base = (const u8*)(header + 1);
+      batch->iovecs[batch->iovec_count].size = header->size;
+      batch->iovec_count++;
+    }
+
+    batch->positions[ring_idx] += header->span;
+#  if defined(LOGS_PER_CPU) && (LOGS_PER_CPU != 0) && (LOGS_PER_CPU_TIMESTAMPS != 0)
+    advance_ring_merge(ring_idx, batch->positions[ring_idx]);
+#  endif
+  }
+
+  end_ring_batch(batch);
+  return batch;
+}
+
+
+// Wait for the batches claimed before this one to be released, write its records to the open
+// outputs in [first_output_idx; end_output_idx[, then release their space and the batch. Batches
+// are thus written in the order they were claimed, while consumer_lock is free for the next
+// claims. Returns the count of records of the batch
+static u64 release_ring_batch(struct ring_batch* batch, u64 first_output_idx, u64 end_output_idx)
+{
+  for (u64 attempt = 0;
+       __atomic_load_n(&ring.released_batch_count, __ATOMIC_ACQUIRE) != batch->idx;
+       attempt++)
+  {
+    wait_for_ring_progress(attempt);
+  }
+
+  for (u64 i = first_output_idx; (i < end_output_idx) && (batch->iovec_count != 0); i++)
+  {
+    u32 output = logs.outputs[i];
+    if (output != 0)
+    {
+      writev_to_output(output, batch->iovecs, batch->iovec_count);
+    }
+  }
+
+  // Only the rings which were drained are stored to, as producers read their drained_position
+  for (u64 i = 0; i < RING_COUNT; i++)
+  {
+    if (batch->positions[i] != rings[i].drained_position)
+    {
+      __atomic_store_n(&rings[i].drained_position, batch->positions[i], __ATOMIC_RELEASE);
+    }
+  }
+
+  // The slot may be claimed again as soon as the batch is released
+  const u64 record_count = batch->record_count;
+  __atomic_store_n(&ring.released_batch_count, batch->idx + 1, __ATOMIC_RELEASE);
+  return record_count;
+}
+
+
+// Write the committed records of all rings to the open outputs in [first_output_idx;
+// end_output_idx[, after the records other threads claimed before them, one batch at a time
+static void flush_ring(u64 first_output_idx, u64 end_output_idx)
+{
+  struct ring_batch* batch;
+  do
+  {
+    lock_ring_consumer();
+    batch = claim_ring_records();
+    unlock_ring_consumer();
+  } while (release_ring_batch(batch, first_output_idx, end_output_idx) ==
+           RING_RECORDS_PER_WRITEV);
+}
+
+
+#  if LOGS_SHARED_RING_OVERWRITE != 0
+// Claim the oldest committed records of a ring in the next batch until its positions up to
+// end_position are free, or a record isn't committed, to discard them. Called with consumer_lock
+// held
+static struct ring_batch* discard_ring_records(u64 ring_idx, u64 end_position)
+{
+  struct ring_batch* batch    = begin_ring_batch();
+  u64* const         position = &batch->positions[ring_idx];
+  while ((s64)(end_position - *position) > LOGS_BUFFER_SIZE)
+  {
+    struct ring_header* header = committed_ring_record(ring_idx, *position);
+    if (header == 0)
+    {
+      break;
+    }
+
+    __atomic_add_fetch(&ring.dropped_byte_count, header->size, __ATOMIC_RELAXED);
+    *position += header->span;
+    batch->record_count++;
+  }
+
+  end_ring_batch(batch);
+  return batch;
+}
+
+
+// Wait until the positions of a ring up to end_position are free. Meanwhile, the waiting thread
+// claims the oldest records of the ring to discard them whenever consumer_lock is available
+static void wait_for_ring_room(u64 ring_idx, u64 end_position)
+{
+  for (u64 attempt = 0; !ring_has_room_until(ring_idx, end_position); attempt++)
+  {
+    if (try_lock_ring_consumer())
+    {
+      struct ring_batch* batch = discard_ring_records(ring_idx, end_position);
+      unlock_ring_consumer();
+
+      release_ring_batch(batch, 0, 0);
+    }
+
+    wait_for_ring_progress(attempt);
+  }
+}
+#  endif
+
+
+#  if defined(LOGS_PER_CPU) && (LOGS_PER_CPU != 0)
+#    define RSEQ_SYSCALL             334
+#    define RSEQ_SIGNATURE           0x53053053
+#    define RSEQ_CPU_ID_UNREGISTERED 0xFFFFFFFFu
+
+enum cpu_ring_reservation
+{
+  CPU_RING_RESERVED = 0,
+  CPU_RING_FULL     = 1,
+  CPU_RING_ABORTED  = 2
+};
+
+// Claim span bytes at the end of the ring of CPU cpu_idx with a restartable sequence, which only
+// stores the new reserved_position if the thread still runs on that CPU and wasn't preempted nor
+// signaled meanwhile. Otherwise, the kernel resumes the thread at the abort handler, preceded by
+// RSEQ_SIGNATURE. The sequence is described in the __rseq_cs section (struct rseq_cs in
+// linux/rseq.h: version, flags, start_ip, post_commit_offset, abort_ip).
+// Stores the position of the record to *position, or that of the end of the ring if it is full
+static inline u64 reserve_in_cpu_ring(struct logs_rseq* rseq, u32 cpu_idx, u64 span, u64* position)
+{
+  u64 status;
+  u64 record_position;
+  u64 scratch;
+  __asm__ __volatile__ (".pushsection __rseq_cs, \"aw\"\n\t"
+                        ".balign 32\n\t"
+                        "3:\n\t"
+                        ".long 0, 0\n\t"
+                        ".quad 1f, (2f - 1f), 4f\n\t"
+                        ".popsection\n\t"
+                        "leaq 3b(%%rip), %[scratch]\n\t"
+                        "movq %[scratch], 8(%[rseq])\n\t"
+                        "1:\n\t"
+                        "cmpl %[cpu_idx], 4(%[rseq])\n\t"
+                        "jnz 4f\n\t"
+                        "movq (%[reserved]), %[position]\n\t"
+                        "leaq (%[position], %[span]), %[scratch]\n\t"
+                        "subq (%[drained]), %[scratch]\n\t"
+                        "cmpq %[capacity], %[scratch]\n\t"
+                        "ja 5f\n\t"
+                        "leaq (%[position], %[span]), %[scratch]\n\t"
+                        "movq %[scratch], (%[reserved])\n\t"
+                        "2:\n\t"
+                        "xorl %k[status], %k[status]\n\t"
+                        "jmp 6f\n\t"
+                        ".pushsection __rseq_failure, \"ax\"\n\t"
+                        ".long %c[signature]\n\t"
+                        "4:\n\t"
+                        "movl $2, %k[status]\n\t"
+                        "jmp 6f\n\t"
+                        ".popsection\n\t"
+                        "5:\n\t"
+                        "movl $1, %k[status]\n\t"
+                        "6:" :
+                        [status]    "=&r"(status),
+                        [position]  "=&r"(record_position),
+                        [scratch]   "=&r"(scratch) :
+                        [rseq]      "r"(rseq),
+                        [cpu_idx]   "r"(cpu_idx),
+                        [span]      "r"(span),
+                        [reserved]  "r"(&rings[cpu_idx].reserved_position),
+                        [drained]   "r"(&rings[cpu_idx].drained_position),
+                        [capacity]  "er"((u64)LOGS_BUFFER_SIZE),
+                        [signature] "i"(RSEQ_SIGNATURE) :
+                        "cc", "memory");
+
+  *position = record_position;
+  return status;
+}
+
+
+// Register the calling thread's rseq area. If this fails, its CPU index remains
+// RSEQ_CPU_ID_UNREGISTERED, which makes the thread reserve records in the shared ring
+static void register_rseq(struct logs_rseq* rseq)
+{
+  rseq->cpu_id_start = RSEQ_CPU_ID_UNREGISTERED;
+  rseq->cpu_id       = RSEQ_CPU_ID_UNREGISTERED;
+  rseq->rseq_cs      = 0;
+  rseq->flags        = 0;
+
+  register u64               rseq_syscall_rax __asm__("rax") = RSEQ_SYSCALL;
+  register struct logs_rseq* rseq_rdi         __asm__("rdi") = rseq;
+  register u64               size_rsi         __asm__("rsi") = sizeof(struct logs_rseq);
+  register u64               flags_rdx        __asm__("rdx") = 0;
+  register u64               signature_r10    __asm__("r10") = RSEQ_SIGNATURE;
+  __asm__ __volatile__ ("syscall" :
+                        "+r"(rseq_syscall_rax) :
+                        "r"(rseq_rdi), "r"(size_rsi), "r"(flags_rdx), "r"(signature_r10) :
+                        "rcx", "r11", "memory");
+}
+#  endif
+#endif
+
+
+#if defined(LOGS_OS_LINUX) && defined(LOGS_BINARY) && (LOGS_BINARY != 0)
+// Binary logs. The linker defines these symbols around the logs_binary_sites section, where
+// log_binary() stores its call sites. They are weak, so that programs without any call site link
+#  define BINARY_DICTIONARY_BUFFER_SIZE 4096
+
+extern const struct logs_binary_site __start_logs_binary_sites[] __attribute__((weak));
+extern const struct logs_binary_site __stop_logs_binary_sites[]  __attribute__((weak));
+
+// Bit i is set once the dictionary was written to output i, and cleared when it is closed
+static u32 binary_dictionary_outputs;
+
+// Where the dictionary is serialized before being written. Only used while flushing
+static struct
+{
+  u8  bytes[BINARY_DICTIONARY_BUFFER_SIZE + LOGS_BUFFER_PADDING];
+  u64 size;
+  u32 output;
+} binary_dictionary;
+
+
+// Write num to dest as a varint: 7 bits per byte from the least significant ones, with the most
+// significant bit of every byte but the last set. Up to 8 bytes are written, and 2 more for values
+// of 2^56 and above
+static inline u64 write_varint(u8* dest, u64 num)
+{
+  const u64 bit_count  = 64 - lzcnt64(num | 1);
+  const u64 byte_count = (bit_count + 6) / 7;
+  if (byte_count <= 8)
+  {
+    // Spread 7-bit groups over bytes, then set the continuation bit of all bytes but the last
+    const u64 groups        = pdep64(num, 0x7F7F7F7F7F7F7F7Full);
+    const u64 continuations = 0x8080808080808080ull & ((1ull << ((byte_count - 1) * 8)) - 1);
+    *(u64*)dest = groups | continuations;
+    return byte_count;
+  }
+
+  *(u64*)dest = pdep64(num, 0x7F7F7F7F7F7F7F7Full) | 0x8080808080808080ull;
+  num >>= 56;
+  dest[8] = (u8)((num & 0x7F) | ((byte_count == 10) ? 0x80 : 0));
+  dest[9] = (u8)(num >> 7);
+  return byte_count;
+}
+
+
+static void stage_binary_dictionary_bytes(const u8* bytes, u64 size)
+{
+  if ((binary_dictionary.size + size) > BINARY_DICTIONARY_BUFFER_SIZE)
+  {
+    write_to_output(binary_dictionary.output, binary_dictionary.bytes, binary_dictionary.size);
+    binary_dictionary.size = 0;
+  }
+
+  if (size > BINARY_DICTIONARY_BUFFER_SIZE)
+  {
+    write_to_output(binary_dictionary.output, bytes, size);
+    return;
+  }
+
+  copy_bytes(binary_dictionary.bytes + binary_dictionary.size, bytes, size);
+  binary_dictionary.size += size;
+}
+
+
+static void stage_binary_dictionary_varint(u64 num)
+{
+  static u8 varint[VARINT_MAX_SIZE + 6];
+  stage_binary_dictionary_bytes(varint, write_varint(varint, num));
+}
+
+
+// Write the dictionary of call sites to an output (see LOGS_BINARY_MAGIC in logs.h)
+static void write_binary_dictionary(u32 output)
+{
+  const struct logs_binary_site* sites      = __start_logs_binary_sites;
+  const u64                      site_count = (u64)(__stop_logs_binary_sites - sites);
+
+  binary_dictionary.size   = 0;
+  binary_dictionary.output = output;
+  stage_binary_dictionary_varint(0);
+  stage_binary_dictionary_bytes((const u8*)LOGS_BINARY_MAGIC, LOGS_BINARY_MAGIC_SIZE);
+  stage_binary_dictionary_varint(site_count);
+  for (u64 i = 0; i < site_count; i++)
+  {
+    const struct logs_binary_site* site = &sites[i];
+    stage_binary_dictionary_bytes(&site->arg_count, 1);
+    stage_binary_dictionary_bytes(site->arg_types, site->arg_count);
+
+    const u64 format_size = utf8_str_length(site->format);
+    stage_binary_dictionary_varint(format_size);
+    stage_binary_dictionary_bytes((const u8*)site->format, format_size);
+  }
+
+  write_to_output(output, binary_dictionary.bytes, binary_dictionary.size);
+}
+
+
+// Write the dictionary to the open outputs in [first_output_idx; end_output_idx[ which didn't get it
+// since they were opened
+static inline void write_binary_dictionaries(u64 first_output_idx, u64 end_output_idx)
+{
+  for (u64 i = first_output_idx; i < end_output_idx; i++)
+  {
+    const u32 output = logs.outputs[i];
+    if ((output != 0) && ((binary_dictionary_outputs & (1u << i)) == 0))
+    {
+      write_binary_dictionary(output);
+      binary_dictionary_outputs |= 1u << i;
+    }
+  }
+}
+#endif
+
+
+#if defined(LOGS_OS_LINUX) && defined(LOGS_FILE_ROTATION) && (LOGS_FILE_ROTATION != 0)
+#  define CLOSE_SYSCALL       3
+#  define DUP2_SYSCALL        33
+#  define RENAME_SYSCALL      82
+#  define UNLINK_SYSCALL      87
+#  define FALLOC_FL_KEEP_SIZE 0x1
+
+
+// Build the name of the spare file (path.next) if number is 0, or of a rotated file (path.number)
+// otherwise, in one of the 2 name buffers
+static const char* rotated_file_name(u64 name_idx, u64 number)
+{
+  char* const name = file_rotation.names[name_idx];
+  copy_bytes((u8*)name, (const u8*)file_rotation.path, file_rotation.path_size);
+
+  char* suffix = name + file_rotation.path_size;
+  if (number == 0)
+  {
+    copy_bytes((u8*)suffix, (const u8*)".next", sizeof(".next"));
+    return name;
+  }
+
+  char digits[20];
+  u64  digit_count = 0;
+  do
+  {
+    digits[digit_count++] = (char)('0' + (number % 10));
+    number /= 10;
+  } while (number != 0);
+
+  *suffix++ = '.';
+  while (digit_count != 0)
+  {
+    *suffix++ = digits[--digit_count];
+  }
+  *suffix = 0;
+  return name;
+}
+
+
+// Reserve the blocks of LOGS_FILE_ROTATION_SIZE bytes of a file from offset on, without changing
+// its size: appends then fill blocks which are already allocated
+static inline void preallocate_file(u32 fd, u64 offset)
+{
+  if (offset < LOGS_FILE_ROTATION_SIZE)
+  {
+    file_syscall(FALLOCATE_SYSCALL, fd, FALLOC_FL_KEEP_SIZE, offset, LOGS_FILE_ROTATION_SIZE - offset,
+                 0, 0);
+  }
+}
+
+
+// Free the blocks preallocated past the end of a file, which truncating it to its size does
+static inline void release_preallocated_blocks(u32 fd)
+{
+  const s64 size = file_syscall(LSEEK_SYSCALL, fd, 0, SEEK_END, 0, 0, 0);
+  if (size >= 0)
+  {
+    file_syscall(FTRUNCATE_SYSCALL, fd, (u64)size, 0, 0, 0, 0);
+  }
+}
+
+
+// Open and preallocate the next file, so that rotations only rename files
+static void open_spare_file(void)
+{
+  const s32 spare_fd = (s32)open_file_output_ascii(rotated_file_name(0, 0));
+  file_rotation.spare_fd = (spare_fd > 0) ? (u32)spare_fd : 0;
+  if (spare_fd > 0)
+  {
+    preallocate_file((u32)spare_fd, 0);
+  }
+}
+
+
+static void start_file_rotation(const char* file_path, u32 fd)
+{
+  u64 path_size = 0;
+  while ((path_size < LOGS_FILE_ROTATION_MAX_PATH_SIZE) && (file_path[path_size] != 0))
+  {
+    path_size++;
+  }
+
+  if ((path_size == LOGS_FILE_ROTATION_MAX_PATH_SIZE) || ((s32)fd <= 0))
+  {
+    return;
+  }
+
+  copy_bytes((u8*)file_rotation.path, (const u8*)file_path, path_size + 1);
+  file_rotation.path_size = path_size;
+
+  const s64 size = file_syscall(LSEEK_SYSCALL, fd, 0, SEEK_END, 0, 0, 0);
+  file_rotation.size        = (size > 0) ? (u64)size : 0;
+  file_rotation.flush_count = 0;
+  file_rotation.fd          = fd;
+  preallocate_file(fd, file_rotation.size);
+  open_spare_file();
+}
+
+
+// Release the blocks preallocated for the file output and remove the spare file, before the file
+// output is closed
+static void stop_file_rotation(void)
+{
+  if (file_rotation.fd == 0)
+  {
+    return;
+  }
+
+  release_preallocated_blocks(file_rotation.fd);
+  if (file_rotation.spare_fd != 0)
+  {
+    file_syscall(CLOSE_SYSCALL, file_rotation.spare_fd, 0, 0, 0, 0, 0);
+    file_syscall(UNLINK_SYSCALL, (u64)rotated_file_name(0, 0), 0, 0, 0, 0, 0);
+    file_rotation.spare_fd = 0;
+  }
+
+  file_rotation.fd = 0;
+}
+
+
+// Called before each flush to the file output, which it counts. Once the file output holds
+// LOGS_FILE_ROTATION_SIZE bytes, or got LOGS_FILE_ROTATION_FLUSH_COUNT flushes, path.N-1 is renamed
+// to path.N, ..., path to path.1, and the spare file to path. dup2 then makes the file output's
+// descriptor refer to the spare file, and a new spare file is prepared. If the spare file couldn't
+// be opened, path is opened again instead
+static void rotate_file_output_if_due(void)
+{
+  if (file_rotation.fd == 0)
+  {
+    return;
+  }
+
+  const u64 is_full = (file_rotation.size >= LOGS_FILE_ROTATION_SIZE);
+#  if LOGS_FILE_ROTATION_FLUSH_COUNT != 0
+  const u64 is_due  = is_full || (file_rotation.flush_count >= LOGS_FILE_ROTATION_FLUSH_COUNT);
+#  else
+  const u64 is_due  = is_full;
+#  endif
+  if (!is_due)
+  {
+    file_rotation.flush_count++;
+    return;
+  }
+
+  if (!is_full)
+  {
+    release_preallocated_blocks(file_rotation.fd);
+  }
+
+  for (u64 number = LOGS_FILE_ROTATION_FILE_COUNT; number > 1; number--)
+  {
+    file_syscall(RENAME_SYSCALL, (u64)rotated_file_name(0, number - 1),
+                 (u64)rotated_file_name(1, number), 0, 0, 0, 0);
+  }
+
+  if (LOGS_FILE_ROTATION_FILE_COUNT != 0)
+  {
+    file_syscall(RENAME_SYSCALL, (u64)file_rotation.path, (u64)rotated_file_name(1, 1), 0, 0, 0, 0);
+  }
+  else
+  {
+    file_syscall(UNLINK_SYSCALL, (u64)file_rotation.path, 0, 0, 0, 0, 0);
+  }
+
+  u32 next_fd = file_rotation.spare_fd;
+  if (next_fd != 0)
+  {
+    file_syscall(RENAME_SYSCALL, (u64)rotated_file_name(0, 0), (u64)file_rotation.path, 0, 0, 0, 0);
+  }
+  else
+  {
+    const s32 fd = (s32)open_file_output_ascii(file_rotation.path);
+    if (fd > 0)
+    {
+      next_fd = (u32)fd;
+      preallocate_file(next_fd, 0);
+    }
+  }
+
+  // Without a next file, logs keep going to the renamed file
+  if (next_fd != 0)
+  {
+    file_syscall(DUP2_SYSCALL, next_fd, file_rotation.fd, 0, 0, 0, 0);
+    file_syscall(CLOSE_SYSCALL, next_fd, 0, 0, 0, 0, 0);
+    file_rotation.size = 0;
+  }
+
+  file_rotation.flush_count = 1;
+#  if defined(LOGS_BINARY) && (LOGS_BINARY != 0)
+  // The dictionary is written again to the new file, by the flush which follows
+  binary_dictionary_outputs &= ~(1u << LOGS_OUTPUT_FILE);
+#  endif
+
+  open_spare_file();
+}
+#endif
+
+
+#if defined(LOGS_OS_LINUX) && defined(LOGS_ASYNC_FLUSH) && (LOGS_ASYNC_FLUSH != 0)
+// Asynchronous flushes. Buffers are filled and written in a round-robin order: flushed_count and
+// written_count count the buffers handed over to the writer thread and written by it. Buffers
+// [written_count; flushed_count[ (modulo LOGS_ASYNC_FLUSH_BUFFER_COUNT) are being written, the
+// one at flushed_count is being filled
+#  define CLONE_SYSCALL        56
+#  define FUTEX_SYSCALL        202
+#  define FUTEX_WAIT_PRIVATE   128
+#  define FUTEX_WAKE_PRIVATE   129
+#  define CLONE_THREAD_FLAGS   0x50F00 // CLONE_VM | CLONE_FS | CLONE_FILES | CLONE_SIGHAND |
+                                       // CLONE_THREAD | CLONE_SYSVSEM
+#  define WRITER_STACK_SIZE    (16 * 1024)
+#  define FREE_BUFFER_SPIN_COUNT 256
+
+static _Alignas(64) u8 async_buffers[LOGS_ASYNC_FLUSH_BUFFER_COUNT][LOGS_BUFFER_SIZE + LOGS_BUFFER_PADDING];
+static _Alignas(16) u8 writer_stack[WRITER_STACK_SIZE];
+
+static struct
+{
+  // Written by the logging thread
+  _Alignas(64) u32 flushed_count;
+  u32              writer_started;
+  u32              flusher_is_waiting;
+  u64              sizes[LOGS_ASYNC_FLUSH_BUFFER_COUNT];
+  u32              outputs[LOGS_ASYNC_FLUSH_BUFFER_COUNT][LOGS_OUTPUT_COUNT];
+
+  // Written by the writer thread, on another cache line
+  _Alignas(64) u32 written_count;
+  u32              writer_is_waiting;
+} async_flush;
+
+static const struct linux_timespec flush_max_wait =
+{
+  .sec  = LOGS_ASYNC_FLUSH_MAX_WAIT_NS / 1000000000ull,
+  .nsec = LOGS_ASYNC_FLUSH_MAX_WAIT_NS % 1000000000ull
+};
+
+#if LOGS_ASYNC_FLUSH_WRITER_POLL_NS != 0
+static const struct linux_timespec writer_poll_period =
+{
+  .sec  = LOGS_ASYNC_FLUSH_WRITER_POLL_NS / 1000000000ull,
+  .nsec = LOGS_ASYNC_FLUSH_WRITER_POLL_NS % 1000000000ull
+};
+#endif
+
+// Wait while *address equals expected, for at most timeout if it isn't null
+static inline void futex_wait(u32* address, u32 expected, const struct linux_timespec* timeout)
+{
+  register u64                          futex_syscall_rax __asm__("rax") = FUTEX_SYSCALL;
+  register u32*                         address_rdi       __asm__("rdi") = address;
+  register u64                          op_rsi            __asm__("rsi") = FUTEX_WAIT_PRIVATE;
+  register u64                          expected_rdx      __asm__("rdx") = expected;
+  register const struct linux_timespec* timeout_r10       __asm__("r10") = timeout;
+  __asm__ __volatile__ ("syscall" : "+r"(futex_syscall_rax) :
+                        "r"(address_rdi), "r"(op_rsi), "r"(expected_rdx), "r"(timeout_r10) :
+                        "rcx", "r11", "memory");
+}
+
+static inline void futex_wake(u32* address)
+{
+  register u64  futex_syscall_rax __asm__("rax") = FUTEX_SYSCALL;
+  register u32* address_rdi       __asm__("rdi") = address;
+  register u64  op_rsi            __asm__("rsi") = FUTEX_WAKE_PRIVATE;
+  register u64  count_rdx         __asm__("rdx") = 1;
+  __asm__ __volatile__ ("syscall" : "+r"(futex_syscall_rax) :
+                        "r"(address_rdi), "r"(op_rsi), "r"(count_rdx) :
+                        "rcx", "r11", "memory");
+}
+
+// Writer thread entry point, never returns
+static void write_flushed_buffers(void)
+{
+  u32 written_count = async_flush.written_count;
+  for (;;)
+  {
+    u32 flushed_count = __atomic_load_n(&async_flush.flushed_count, __ATOMIC_ACQUIRE);
+#if LOGS_ASYNC_FLUSH_WRITER_POLL_NS != 0
+    // Check for flushed buffers periodically, flushes never wake this thread up
+    while (flushed_count == written_count)
+    {
+      futex_wait(&async_flush.flushed_count, written_count, &writer_poll_period);
+      flushed_count = __atomic_load_n(&async_flush.flushed_count, __ATOMIC_ACQUIRE);
+    }
+#else
+    // Sleep until a buffer is flushed. writer_is_waiting is set before flushed_count is checked
+    // again, so that either the flush sees it and wakes this thread up, or this check sees the
+    // flush
+    while (flushed_count == written_count)
+    {
+      __atomic_store_n(&async_flush.writer_is_waiting, 1, __ATOMIC_SEQ_CST);
+      flushed_count = __atomic_load_n(&async_flush.flushed_count, __ATOMIC_SEQ_CST);
+      if (flushed_count == written_count)
+      {
+        futex_wait(&async_flush.flushed_count, written_count, 0);
+        flushed_count = __atomic_load_n(&async_flush.flushed_count, __ATOMIC_ACQUIRE);
+      }
+
+      __atomic_store_n(&async_flush.writer_is_waiting, 0, __ATOMIC_RELAXED);
+    }
+#endif
+
+    for (; written_count != flushed_count; written_count++)
+    {
+      const u64 buffer_idx = written_count % LOGS_ASYNC_FLUSH_BUFFER_COUNT;
+#  if defined(LOGS_FILE_ROTATION) && (LOGS_FILE_ROTATION != 0)
+      // Files are rotated by this thread, so that flushes don't wait for it
+      if (async_flush.outputs[buffer_idx][LOGS_OUTPUT_FILE] != 0)
+      {
+        rotate_file_output_if_due();
+      }
+#  endif
+
+      for (u64 i = 0; i < LOGS_OUTPUT_COUNT; i++)
+      {
+        u32 output = async_flush.outputs[buffer_idx][i];
+        if (output != 0)
+        {
+          write_to_output(output, async_buffers[buffer_idx], async_flush.sizes[buffer_idx]);
+        }
+      }
+
+      __atomic_store_n(&async_flush.written_count, written_count + 1, __ATOMIC_SEQ_CST);
+      if (__atomic_load_n(&async_flush.flusher_is_waiting, __ATOMIC_SEQ_CST))
+      {
+        futex_wake(&async_flush.written_count);
+      }
+    }
+  }
+}
+
+// Create the writer thread with a raw clone syscall. The child thread starts on writer_stack,
+// where there is no frame to return to, and directly calls write_flushed_buffers()
+static void start_writer_thread(void)
+{
+  register u64 clone_syscall_rax __asm__("rax") = CLONE_SYSCALL;
+  register u64 flags_rdi         __asm__("rdi") = CLONE_THREAD_FLAGS;
+  register u8* stack_rsi         __asm__("rsi") = writer_stack + WRITER_STACK_SIZE;
+  register u64 parent_tid_rdx    __asm__("rdx") = 0;
+  register u64 child_tid_r10     __asm__("r10") = 0;
+  register u64 tls_r8            __asm__("r8")  = 0;
+  register void (*entry_r12)(void) __asm__("r12") = write_flushed_buffers;
+  __asm__ __volatile__ ("syscall\n\t"
+                        "testq %%rax, %%rax\n\t"
+                        "jnz 1f\n\t"
+                        "xorl %%ebp, %%ebp\n\t"
+                        "callq *%%r12\n\t"
+                        "ud2\n\t"
+                        "1:" :
+                        "+r"(clone_syscall_rax) :
+                        "r"(flags_rdi), "r"(stack_rsi), "r"(parent_tid_rdx), "r"(child_tid_r10),
+                        "r"(tls_r8), "r"(entry_r12) :
+                        "rcx", "r11", "memory");
+
+  async_flush.writer_started = 1;
+}
+
+// Wait until written_count reaches at least min_written_count, spinning shortly before sleeping.
+// Returns 0 if max_wait (unless it is null) elapsed first, 1 otherwise
+static u64 wait_for_written_buffers(u32 min_written_count, const struct linux_timespec* max_wait)
+{
+  for (u64 i = 0; i < FREE_BUFFER_SPIN_COUNT; i++)
+  {
+    if ((s32)(__atomic_load_n(&async_flush.written_count, __ATOMIC_ACQUIRE) - min_written_count) >= 0)
+    {
+      return 1;
+    }
+
+    _mm_pause();
+  }
+
+#if LOGS_ASYNC_FLUSH_WRITER_POLL_NS != 0
+  // Don't wait for the writer thread's next poll
+  futex_wake(&async_flush.flushed_count);
+#endif
+
+  for (;;)
+  {
+    __atomic_store_n(&async_flush.flusher_is_waiting, 1, __ATOMIC_SEQ_CST);
+    const u32 written_count = __atomic_load_n(&async_flush.written_count, __ATOMIC_SEQ_CST);
+    if ((s32)(written_count - min_written_count) >= 0)
+    {
+      break;
+    }
+
+    futex_wait(&async_flush.written_count, written_count, max_wait);
+    if ((max_wait != 0) &&
+        ((s32)(__atomic_load_n(&async_flush.written_count, __ATOMIC_ACQUIRE) - min_written_count) < 0))
+    {
+      __atomic_store_n(&async_flush.flusher_is_waiting, 0, __ATOMIC_RELAXED);
+      return 0;
+    }
+  }
+
+  __atomic_store_n(&async_flush.flusher_is_waiting, 0, __ATOMIC_RELAXED);
+  return 1;
+}
+
+// Hand the buffer over to the writer thread for the outputs in [first_output_idx; end_output_idx[,
+// and continue logging in the next buffer
+static void flush_async(u64 first_output_idx, u64 end_output_idx)
+{
+  if (async_flush.writer_started == 0)
+  {
+    start_writer_thread();
+  }
+
+  // After this flush, the next buffer must be free: at most LOGS_ASYNC_FLUSH_BUFFER_COUNT - 1
+  // buffers may be in the writer thread's hands
+  const u32 flushed_count = async_flush.flushed_count;
+  const u32 min_written   = flushed_count + 2 - LOGS_ASYNC_FLUSH_BUFFER_COUNT;
+  const struct linux_timespec* max_wait = (LOGS_ASYNC_FLUSH_MAX_WAIT_NS != 0) ? &flush_max_wait : 0;
+  if (!wait_for_written_buffers(min_written, max_wait))
+  {
+    logs.dropped_byte_count += logs.buffer_end_idx;
+    return;
+  }
+
+  const u64 buffer_idx = flushed_count % LOGS_ASYNC_FLUSH_BUFFER_COUNT;
+  for (u64 i = 0; i < LOGS_OUTPUT_COUNT; i++)
+  {
+    const u64 is_flushed_to = (i >= first_output_idx) && (i < end_output_idx);
+    async_flush.outputs[buffer_idx][i] = is_flushed_to ? logs.outputs[i] : 0;
+  }
+
+  async_flush.sizes[buffer_idx] = logs.buffer_end_idx;
+  __atomic_store_n(&async_flush.flushed_count, flushed_count + 1, __ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&async_flush.writer_is_waiting, __ATOMIC_SEQ_CST))
+  {
+    futex_wake(&async_flush.flushed_count);
+  }
+
+  logs.buffer = async_buffers[(flushed_count + 1) % LOGS_ASYNC_FLUSH_BUFFER_COUNT];
+}
+#endif
+
+
+#if defined(LOGS_DEFERRED_FORMATTING) && (LOGS_DEFERRED_FORMATTING != 0)
+// Deferred formatting. Records are made of DEFERRED_RECORD_MARKER, a deferred_formatting value, the
+// u64 size argument, then the raw bits of the number (see LOGS_DEFERRED_FORMATTING in logs.h)
+#  define DEFERRED_RECORD_MARKER 0xFF
+
+// Room left in the logs buffer before formatting any record
+#  define DEFERRED_RECORD_MAX_STR_SIZE F64_MAX_SIZED_DEC_STR_SIZE
+
+#  if defined(LOGS_AUTO_FLUSH) && (LOGS_AUTO_FLUSH != 0)
+#    define DEFERRED_FORMATTING_END_IDX LOGS_AUTO_FLUSH_WATERMARK
+#  else
+#    define DEFERRED_FORMATTING_END_IDX LOGS_BUFFER_SIZE
+#  endif
+
+enum deferred_formatting
+{
+  DEFERRED_SIZED_BIN_U64,
+  DEFERRED_SIZED_DEC_U64,
+  DEFERRED_SIZED_DEC_S64,
+  DEFERRED_DEC_S32,
+  DEFERRED_DEC_S64,
+  DEFERRED_SIZED_HEX_U64,
+  DEFERRED_SIZED_HEX_LOWER_U64,
+  DEFERRED_DEC_F32_NAN_OR_INF,
+  DEFERRED_DEC_F32_NUMBER,
+  DEFERRED_DEC_F64_NAN_OR_INF,
+  DEFERRED_DEC_F64_NUMBER,
+  DEFERRED_SIZED_DEC_F32_NUMBER,
+  DEFERRED_SIZED_DEC_F64_NUMBER,
+  DEFERRED_SCI_F32_NUMBER,
+  DEFERRED_SCI_F64_NUMBER,
+  DEFERRED_SIZED_SCI_F32_NUMBER,
+  DEFERRED_SIZED_SCI_F64_NUMBER
+};
+
+static struct
+{
+  // Records being formatted, moved out of the logs buffer which receives their formatted text
+  u8  records[LOGS_BUFFER_SIZE + LOGS_BUFFER_PADDING];
+
+  // Set while records are formatted: formatting functions then format instead of recording, and
+  // the flushes called to make room only write the logs buffer
+  u32 is_formatting;
+} deferred;
+
+// Called first by every deferred formatting function, which returns right after recording itself
+#  define DEFER_FORMATTING(formatting, bits, size)    \
+  if (!deferred.is_formatting)                        \
+  {                                                   \
+    append_deferred_record(formatting, bits, size);   \
+    return;                                           \
+  }
+
+
+static void format_deferred_record(const u8* record)
+{
+  const u64 size    = *(const u64*)(record + 2);
+  const u64 bits    = *(const u64*)(record + 10);
+  const u32 bits_32 = (u32)bits;
+
+  switch ((enum deferred_formatting)record[1])
+  {
+    case DEFERRED_SIZED_BIN_U64:        log_sized_bin_u64(bits, size);                  break;
+    case DEFERRED_SIZED_DEC_U64:        log_sized_dec_u64(bits, size);                  break;
+    case DEFERRED_SIZED_DEC_S64:        log_sized_dec_s64((s64)bits, size);             break;
+    case DEFERRED_DEC_S32:              log_dec_s32((s32)bits);                         break;
+    case DEFERRED_DEC_S64:              log_dec_s64((s64)bits);                         break;
+    case DEFERRED_SIZED_HEX_U64:        log_sized_hex_u64(bits, size);                  break;
+    case DEFERRED_SIZED_HEX_LOWER_U64:  log_sized_hex_lower_u64(bits, size);            break;
+    case DEFERRED_DEC_F32_NAN_OR_INF:   log_dec_f32_nan_or_inf(*(f32*)&bits_32);        break;
+    case DEFERRED_DEC_F32_NUMBER:       log_dec_f32_number(*(f32*)&bits_32);            break;
+    case DEFERRED_DEC_F64_NAN_OR_INF:   log_dec_f64_nan_or_inf(*(f64*)&bits);           break;
+    case DEFERRED_DEC_F64_NUMBER:       log_dec_f64_number(*(f64*)&bits);               break;
+    case DEFERRED_SIZED_DEC_F32_NUMBER: log_sized_dec_f32_number(*(f32*)&bits_32, size); break;
+    case DEFERRED_SIZED_DEC_F64_NUMBER: log_sized_dec_f64_number(*(f64*)&bits, size);   break;
+    case DEFERRED_SCI_F32_NUMBER:       log_sci_f32_number(*(f32*)&bits_32);            break;
+    case DEFERRED_SCI_F64_NUMBER:       log_sci_f64_number(*(f64*)&bits);               break;
+    case DEFERRED_SIZED_SCI_F32_NUMBER: log_sized_sci_f32_number(*(f32*)&bits_32, size); break;
+    case DEFERRED_SIZED_SCI_F64_NUMBER: log_sized_sci_f64_number(*(f64*)&bits, size);   break;
+  }
+}
+
+
+// Index of the first record marker in records[start_idx; end_idx[, or end_idx. Blocks of 16 bytes
+// are searched at once, the padding after records making loads past end_idx safe
+static inline u64 find_deferred_record(const u8* records, u64 start_idx, u64 end_idx)
+{
+  const __m128i markers = _mm_set1_epi8((char)DEFERRED_RECORD_MARKER);
+  for (u64 idx = start_idx; idx < end_idx; idx += 16)
+  {
+    const __m128i block       = _mm_loadu_si128((const __m128i*)(records + idx));
+    const u32     marker_mask = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(block, markers));
+    if (marker_mask != 0)
+    {
+      const u64 marker_idx = idx + tzcnt32(marker_mask);
+      return (marker_idx < end_idx) ? marker_idx : end_idx;
+    }
+  }
+
+  return end_idx;
+}
+
+
+// Write the logs buffer to the outputs in [first_output_idx; end_output_idx[, to make room for
+// more formatted records
+static inline void flush_formatted_records(u64 first_output_idx, u64 end_output_idx)
+{
+  if ((end_output_idx - first_output_idx) == 1)
+  {
+    logs_flush_to((logs_output_idx)first_output_idx);
+  }
+  else
+  {
+    logs_flush();
+  }
+}
+
+
+// Replace the records in the logs buffer by their formatted text, writing it to the outputs in
+// [first_output_idx; end_output_idx[ whenever the buffer fills up. Records are dropped unformatted
+// if all of these outputs are closed
+static void format_deferred_records(u64 first_output_idx, u64 end_output_idx)
+{
+  if (deferred.is_formatting)
+  {
+    return;
+  }
+
+  u64 has_open_output = 0;
+  for (u64 i = first_output_idx; i < end_output_idx; i++)
+  {
+    has_open_output |= (logs.outputs[i] != 0);
+  }
+
+  const u64 records_size = logs.buffer_end_idx;
+  logs.buffer_end_idx = 0;
+  if (!has_open_output)
+  {
+    return;
+  }
+
+  copy_bytes(deferred.records, logs.buffer, records_size);
+  deferred.is_formatting = 1;
+
+  u64 idx = 0;
+  while (idx < records_size)
+  {
+    // Characters and strings appended between records are copied back as they are
+    const u64 text_end_idx = find_deferred_record(deferred.records, idx, records_size);
+    while (idx < text_end_idx)
+    {
+      if (logs.buffer_end_idx == DEFERRED_FORMATTING_END_IDX)
+      {
+        flush_formatted_records(first_output_idx, end_output_idx);
+      }
+
+      const u64 room      = DEFERRED_FORMATTING_END_IDX - logs.buffer_end_idx;
+      const u64 text_size = ((text_end_idx - idx) < room) ? (text_end_idx - idx) : room;
+      copy_bytes(logs.buffer + logs.buffer_end_idx, deferred.records + idx, text_size);
+      logs.buffer_end_idx += text_size;
+      idx                 += text_size;
+    }
+
+    if (idx < records_size)
+    {
+      // Sized integers may be padded with more zeros than DEFERRED_RECORD_MAX_STR_SIZE, plus a sign
+      const u64 sized_str_size  = *(const u64*)(deferred.records + idx + 2) + 1;
+      const u64 record_str_size = (sized_str_size > DEFERRED_RECORD_MAX_STR_SIZE) ?
+                                  sized_str_size : DEFERRED_RECORD_MAX_STR_SIZE;
+      if ((DEFERRED_FORMATTING_END_IDX - logs.buffer_end_idx) < record_str_size)
+      {
+        flush_formatted_records(first_output_idx, end_output_idx);
+      }
+
+      format_deferred_record(deferred.records + idx);
+      idx += LOGS_DEFERRED_RECORD_SIZE;
+    }
+  }
+
+  deferred.is_formatting = 0;
+}
+#else
+#  define DEFER_FORMATTING(formatting, bits, size)
+#endif
+
+
+#if defined(LOGS_OS_LINUX) && defined(LOGS_ZERO_COPY) && (LOGS_ZERO_COPY != 0)
+// Zero-copy strings, referenced by log_sized_utf8_str_ref() until the next flush
+static struct
+{
+  struct
+  {
+    // logs.buffer_end_idx when the string was referenced, where it is written
+    u64       buffer_idx;
+    const u8* str;
+    u64       size;
+  } refs[LOGS_ZERO_COPY_MAX_REF_COUNT];
+  u64 ref_count;
+
+  // Buffered logs and referenced strings, interleaved
+  struct linux_iovec iovecs[(2 * LOGS_ZERO_COPY_MAX_REF_COUNT) + 1];
+} zero_copy;
+
+
+// Write the log buffer and the referenced strings to the open outputs in
+// [first_output_idx; end_output_idx[, with a single writev syscall per output unless it is short
+static void flush_with_refs(u64 first_output_idx, u64 end_output_idx)
+{
+#  if defined(LOGS_IO_URING) && (LOGS_IO_URING != 0)
+  // Asynchronous writes of previous flushes come first
+  reap_io_uring_writes();
+#  endif
+
+  u64 iovec_count = 0;
+  u64 buffer_idx  = 0;
+  for (u64 i = 0; i < zero_copy.ref_count; i++)
+  {
+    if (zero_copy.refs[i].buffer_idx != buffer_idx)
+    {
+      zero_copy.iovecs[iovec_count].base = logs.buffer + buffer_idx;
+      zero_copy.iovecs[iovec_count].size = zero_copy.refs[i].buffer_idx - buffer_idx;
+      iovec_count++;
+      buffer_idx = zero_copy.refs[i].buffer_idx;
+    }
+
+    zero_copy.iovecs[iovec_count].base = zero_copy.refs[i].str;
+    zero_copy.iovecs[iovec_count].size = zero_copy.refs[i].size;
+    iovec_count++;
+  }
+
+  if (logs.buffer_end_idx != buffer_idx)
+  {
+    zero_copy.iovecs[iovec_count].base = logs.buffer + buffer_idx;
+    zero_copy.iovecs[iovec_count].size = logs.buffer_end_idx - buffer_idx;
+    iovec_count++;
+  }
+
+  for (u64 i = first_output_idx; i < end_output_idx; i++)
+  {
+    u32 output = logs.outputs[i];
+    if (output != 0)
+    {
+      writev_to_output(output, zero_copy.iovecs, iovec_count);
+    }
+  }
+
+  zero_copy.ref_count = 0;
+  logs.buffer_end_idx = 0;
+}
+#endif
+
+
+#if defined(LOGS_OUTPUT_LEVELS) && (LOGS_OUTPUT_LEVELS != 0)
+// Segments of the log buffer started by logs_route_to_outputs() since the last flush. The last one
+// isn't recorded until flushes end it with the buffer
+static struct
+{
+  struct
+  {
+    // logs.buffer_end_idx when the segment ended
+    u64 end_idx;
+
+    // Outputs the segment goes to (see logs.routed_output_mask)
+    u32 output_mask;
+  } segments[LOGS_OUTPUT_LEVELS_MAX_SEGMENT_COUNT + 1];
+  u64 segment_count;
+
+#  if defined(LOGS_OS_LINUX)
+  // Runs of adjacent segments going to the output being written to
+  struct linux_iovec iovecs[LOGS_OUTPUT_LEVELS_MAX_SEGMENT_COUNT + 1];
+#  endif
+} routing;
+
+
+// Write the log buffer to the open outputs in [first_output_idx; end_output_idx[, each of them
+// being written only the segments going to it, with a single writev syscall per output on Linux
+static void flush_routed_segments(u64 first_output_idx, u64 end_output_idx)
+{
+  routing.segments[routing.segment_count].end_idx     = logs.buffer_end_idx;
+  routing.segments[routing.segment_count].output_mask = logs.routed_output_mask;
+
+  for (u64 i = first_output_idx; i < end_output_idx; i++)
+  {
+    u32 output = logs.outputs[i];
+    if (output != 0)
+    {
+      // Adjacent segments going to the output are written as a single run
+      u64 run_count     = 0;
+      u64 run_start_idx = 0;
+      u64 run_end_idx   = 0;
+      u64 start_idx     = 0;
+      for (u64 j = 0; j <= routing.segment_count; j++)
+      {
+        const u64 end_idx = routing.segments[j].end_idx;
+        if ((routing.segments[j].output_mask & (1u << i)) != 0)
+        {
+          if ((start_idx != run_end_idx) && (run_end_idx != run_start_idx))
+          {
+#  if defined(LOGS_OS_LINUX)
+            routing.iovecs[run_count].base = logs.buffer + run_start_idx;
+            routing.iovecs[run_count].size = run_end_idx - run_start_idx;
+#  else
+            write_to_output(output, logs.buffer + run_start_idx, run_end_idx - run_start_idx);
+#  endif
+            run_count++;
+          }
+          if (start_idx != run_end_idx)
+          {
+            run_start_idx = start_idx;
+          }
+          run_end_idx = end_idx;
+        }
+        start_idx = end_idx;
+      }
+
+      if (run_end_idx != run_start_idx)
+      {
+#  if defined(LOGS_OS_LINUX)
+        routing.iovecs[run_count].base = logs.buffer + run_start_idx;
+        routing.iovecs[run_count].size = run_end_idx - run_start_idx;
+        run_count++;
+#  else
+        write_to_output(output, logs.buffer + run_start_idx, run_end_idx - run_start_idx);
+#  endif
+      }
+
+#  if defined(LOGS_OS_LINUX)
+      if (run_count != 0)
+      {
+        writev_to_output(output, routing.iovecs, run_count);
+      }
+#  else
+      (void)run_count;
+#  endif
+    }
+  }
+
+  routing.segment_count = 0;
+  logs.buffer_end_idx   = 0;
+}
+#endif
+
+
+static inline void logs_close_output(logs_output_idx output_idx)
+{
+#if defined(LOGS_OS_LINUX) && defined(LOGS_ASYNC_FLUSH) && (LOGS_ASYNC_FLUSH != 0)
+  // Flushed buffers may still have to be written to this output
+  wait_for_written_buffers(async_flush.flushed_count, 0);
+#endif
+
+#if defined(LOGS_OS_LINUX) && defined(LOGS_IO_URING) && (LOGS_IO_URING != 0)
+  // Pending writes may target this output
+  reap_io_uring_writes();
+#endif
+
+#if defined(LOGS_OS_LINUX) && defined(LOGS_MMAP_FILE) && (LOGS_MMAP_FILE != 0)
+  if (output_idx == LOGS_OUTPUT_FILE)
+  {
+    unmap_file_output();
+  }
+#endif
+
+#if defined(LOGS_OS_LINUX) && defined(LOGS_FILE_ROTATION) && (LOGS_FILE_ROTATION != 0)
+  if (output_idx == LOGS_OUTPUT_FILE)
+  {
+    stop_file_rotation();
+  }
+#endif
+
+#if defined(LOGS_OS_WINDOWS)
+  u32 output = logs.outputs[output_idx];
+  CloseHandle((HANDLE)(u64)output);
+#elif defined(LOGS_OS_LINUX)
+  register u64 close_syscall_rax __asm__("rax") = 3;
+  register u64 output_rdi        __asm__("rdi") = logs.outputs[output_idx];
+  __asm__ __volatile__ ("syscall" :
+                        "+r"(close_syscall_rax) :
+                        "r"(output_rdi) :
+                        "rcx", "r11", "memory");
+#endif
+
+  logs.outputs[output_idx] = 0;
+#if defined(LOGS_OS_LINUX) && defined(LOGS_BINARY) && (LOGS_BINARY != 0)
+  binary_dictionary_outputs &= ~(1u << output_idx);
+#endif
+}
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//// Global
+// No second is cached yet. Only the digits of date_time are formatted, around these separators
+#define TIMESTAMP_CACHE_INIT {.second = ~0ull, .day = ~0ull, .date_time = "0000-00-00T00:00:00"}
+
+#if defined(LOGS_OS_LINUX) && defined(LOGS_PER_THREAD) && (LOGS_PER_THREAD != 0)
+// Output handles of all threads. stdout is opened by default
+static u32 shared_outputs[LOGS_OUTPUT_COUNT] =
+{
+  [LOGS_OUTPUT_CONSOLE] = STDOUT_FD,
+  [LOGS_OUTPUT_FILE]    = 0
+};
+
+
+void logs_attach_thread(logs_thread* thread_logs)
+{
+  thread_logs->self           = thread_logs;
+  thread_logs->outputs        = shared_outputs;
+  thread_logs->buffer_end_idx = 0;
+  thread_logs->timestamp_cache = (struct logs_timestamp_cache)TIMESTAMP_CACHE_INIT;
+#  if defined(LOGS_SHARED_RING) && (LOGS_SHARED_RING != 0)
+  thread_logs->buffer          = thread_logs->discarded_logs;
+  thread_logs->record_position = 0;
+  thread_logs->record_max_size = 0;
+  thread_logs->record_logs     = 0;
+  thread_logs->record_size     = RING_RECORD_NOT_FULL;
+#  endif
+#  if defined(LOGS_PER_CPU) && (LOGS_PER_CPU != 0)
+  register_rseq(&thread_logs->rseq);
+#  endif
+
+  register u64          arch_prctl_syscall_rax __asm__("rax") = ARCH_PRCTL_SYSCALL;
+  register u64          code_rdi               __asm__("rdi") = ARCH_SET_GS;
+  register logs_thread* address_rsi            __asm__("rsi") = thread_logs;
+  __asm__ __volatile__ ("syscall" :
+                        "+r"(arch_prctl_syscall_rax) :
+                        "r"(code_rdi), "r"(address_rsi) :
+                        "rcx", "r11", "memory");
+}
+
+
+#  if defined(LOGS_PER_THREAD_CHECKS) && (LOGS_PER_THREAD_CHECKS != 0)
+void logs_check_thread_attached(void)
+{
+  u64 gs_base = 0;
+  register u64  arch_prctl_syscall_rax __asm__("rax") = ARCH_PRCTL_SYSCALL;
+  register u64  code_rdi               __asm__("rdi") = ARCH_GET_GS;
+  register u64* address_rsi            __asm__("rsi") = &gs_base;
+  __asm__ __volatile__ ("syscall" :
+                        "+r"(arch_prctl_syscall_rax) :
+                        "r"(code_rdi), "r"(address_rsi) :
+                        "rcx", "r11", "memory");
+
+  if (gs_base == 0)
+  {
+    static const char message[] = "logs: logs_attach_thread() wasn't called by this thread\n";
+    write_to_output(STDERR_FD, (const u8*)message, sizeof(message) - 1);
+
+    // exit_group
+    __asm__ __volatile__ ("syscall" : : "a"(231), "D"(1) : "rcx", "r11", "memory");
+  }
+}
+#  endif
+#else
+struct logs logs =
+{
+#if defined(LOGS_OS_LINUX) && defined(LOGS_ASYNC_FLUSH) && (LOGS_ASYNC_FLUSH != 0)
+  .buffer = async_buffers[0],
+  .dropped_byte_count = 0,
+#else
+  .buffer = {0},
+#endif
+  .outputs =
+  {
+#if defined(LOGS_OS_LINUX)
+    // stdout is opened by default
+    [LOGS_OUTPUT_CONSOLE] = STDOUT_FD,
+#else
+    [LOGS_OUTPUT_CONSOLE] = 0,
+#endif
+    [LOGS_OUTPUT_FILE]    = 0
+  },
+  .buffer_end_idx = 0,
+#if defined(LOGS_OUTPUT_LEVELS) && (LOGS_OUTPUT_LEVELS != 0)
+  .routed_output_mask = (1u << LOGS_OUTPUT_COUNT) - 1,
+#endif
+  .timestamp_cache = TIMESTAMP_CACHE_INIT
+};
+#endif
+
+// All levels go to all outputs by default
+u32 logs_level_mask = (1u << (LOGS_LEVEL_COUNT * LOGS_OUTPUT_COUNT)) - 1;
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//// Output management
+// Console output
+void logs_open_console_output(void)
+{
+  if (logs.outputs[LOGS_OUTPUT_CONSOLE] == 0)
+  {
+#if defined(LOGS_OS_WINDOWS)
+    const BOOL success    = AttachConsole(ATTACH_PARENT_PROCESS);
+    const u32  last_error = GetLastError();
+    if ((success == 0) && (last_error != ERROR_ACCESS_DENIED))
+    {
+      // There is no console to borrow, or something went wrong. Create a new console
+      AllocConsole();
+      SetConsoleTitleA("Logs");
+
+      logs.console_original_output_code_page = 0;
+    }
+    else
+    {
+      // An existing console is attached
+      logs.console_original_output_code_page = GetConsoleOutputCP();
+    }
+
+    SetConsoleOutputCP(CP_UTF8);
+
+    const u32 SHARE_MODE = FILE_SHARE_READ | FILE_SHARE_WRITE;
+    HANDLE output = CreateFileA("\\\\?\\CONOUT$", // lpFileName
+                                GENERIC_WRITE,    // dwDesiredAccess
+                                SHARE_MODE,       // dwShareMode
+                                0,                // lpSecurityAttributes
+                                OPEN_EXISTING,    // dwCreationDisposition
+                                0,                // dwFlagsAndAttributes
+                                0);               // hTemplateFile
+    logs.outputs[LOGS_OUTPUT_CONSOLE] = (u32)(u64)output;
+
+#elif defined(LOGS_OS_LINUX)
+    // Since stdout is not opened nor handled by this process, its file descriptor is set and unset
+    // to indicate whether it should be used or not, but it is otherwise left opened and never
+    // closed nor re-opened
+    logs.outputs[LOGS_OUTPUT_CONSOLE] = STDOUT_FD;
+#endif
+  }
+}
+
+
+// NOTE (Sami): this breaks Windows Terminal (the default Windows 11 console)
+void logs_close_console_output(void)
+{
+  if (logs.outputs[LOGS_OUTPUT_CONSOLE] != 0)
+  {
+#if defined(LOGS_OS_WINDOWS)
+    logs_close_output(LOGS_OUTPUT_CONSOLE);
+    if (logs.console_original_output_code_page != 0)
+    {
+      SetConsoleOutputCP(logs.console_original_output_code_page);
+    }
+    
+    // Free the console of this process
+    FreeConsole();
+#elif defined(LOGS_OS_LINUX)
+    // stdout file descriptor is removed to indicate it should not be used, but it is never closed
+    logs.outputs[LOGS_OUTPUT_CONSOLE] = 0;
+#endif
+  }
+}
+
+
+// Index of the variant of line prefixes stamped by log_prefix(): 1 for the one with ANSI escape
+// sequences
+static u64 ansi_escape_sequences_enabled;
+
+void logs_enable_console_ansi_escape_sequence(void)
+{
+#if defined(LOGS_OS_WINDOWS)
+#  if !defined(ENABLE_VIRTUAL_TERMINAL_PROCESSING)
+#    define ENABLE_VIRTUAL_TERMINAL_PROCESSING 0x0004
+#  endif
+  // Consoles only interpret escape sequences in virtual terminal mode, which fails to be set
+  // before Windows 10
+  HANDLE console = (HANDLE)(u64)logs.outputs[LOGS_OUTPUT_CONSOLE];
+  DWORD  mode;
+  if ((console != 0) && GetConsoleMode(console, &mode))
+  {
+    SetConsoleMode(console, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+  }
+#endif
+
+  ansi_escape_sequences_enabled = 1;
+}
+
+
+void logs_disable_console_ansi_escape_sequence(void)
+{
+#if defined(LOGS_OS_WINDOWS)
+  HANDLE console = (HANDLE)(u64)logs.outputs[LOGS_OUTPUT_CONSOLE];
+  DWORD  mode;
+  if ((console != 0) && GetConsoleMode(console, &mode))
+  {
+    SetConsoleMode(console, mode & ~ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+  }
+#endif
+
+  ansi_escape_sequences_enabled = 0;
+}
+
+
+// File output
+void logs_open_file_output_ascii(const char* file_path)
+{
+  if (logs.outputs[LOGS_OUTPUT_FILE] == 0)
+  {
+    u32 output = open_file_output_ascii(file_path);
+    logs.outputs[LOGS_OUTPUT_FILE] = output;
+#if defined(LOGS_OS_LINUX) && defined(LOGS_MMAP_FILE) && (LOGS_MMAP_FILE != 0)
+    map_file_output(output);
+#endif
+#if defined(LOGS_OS_LINUX) && defined(LOGS_FILE_ROTATION) && (LOGS_FILE_ROTATION != 0)
+    start_file_rotation(file_path, output);
+#endif
+  }
+}
+
+
+void logs_open_file_output_utf16(const char16* file_path)
+{
+  if (logs.outputs[LOGS_OUTPUT_FILE] == 0)
+  {
+#if defined(LOGS_OS_WINDOWS)
+    const u32 SHARE_MODE = FILE_SHARE_READ | FILE_SHARE_WRITE;
+    HANDLE output = CreateFileW(file_path,        // lpFileName
+                                FILE_APPEND_DATA, // dwDesiredAccess
+                                SHARE_MODE,       // dwShareMode
+                                0,                // lpSecurityAttributes
+                                OPEN_ALWAYS,      // dwCreationDisposition
+                                0,                // dwFlagsAndAttributes
+                                0);               // hTemplateFile
+    logs.outputs[LOGS_OUTPUT_FILE] = (u32)(u64)output;
+#elif defined(LOGS_OS_LINUX)
+    u32 output = open_file_output_ascii((char*)file_path);
+    logs.outputs[LOGS_OUTPUT_FILE] = output;
+#  if defined(LOGS_MMAP_FILE) && (LOGS_MMAP_FILE != 0)
+    map_file_output(output);
+#  endif
+#  if defined(LOGS_FILE_ROTATION) && (LOGS_FILE_ROTATION != 0)
+    start_file_rotation((char*)file_path, output);
+#  endif
+#endif
+  }
+}
+
+
+void logs_close_file_output(void)
+{
+  if (logs.outputs[LOGS_OUTPUT_FILE] != 0)
+  {
+    logs_close_output(LOGS_OUTPUT_FILE);
+  }
+}
+
+
+// All outputs
+void logs_flush(void)
+{
+#if defined(LOGS_OS_LINUX) && defined(LOGS_FILE_ROTATION) && (LOGS_FILE_ROTATION != 0) && \
+    (!defined(LOGS_ASYNC_FLUSH) || (LOGS_ASYNC_FLUSH == 0))
+  if (logs.outputs[LOGS_OUTPUT_FILE] != 0)
+  {
+    rotate_file_output_if_due();
+  }
+#endif
+
+#if defined(LOGS_DEFERRED_FORMATTING) && (LOGS_DEFERRED_FORMATTING != 0)
+  format_deferred_records(0, LOGS_OUTPUT_COUNT);
+#endif
+
+#if defined(LOGS_OS_LINUX) && defined(LOGS_BINARY) && (LOGS_BINARY != 0)
+  write_binary_dictionaries(0, LOGS_OUTPUT_COUNT);
+#endif
+
+#if defined(LOGS_OS_LINUX) && defined(LOGS_ZERO_COPY) && (LOGS_ZERO_COPY != 0)
+  if (zero_copy.ref_count != 0)
+  {
+    flush_with_refs(0, LOGS_OUTPUT_COUNT);
+    return;
+  }
+#endif
+
+#if defined(LOGS_OS_LINUX) && defined(LOGS_SHARED_RING) && (LOGS_SHARED_RING != 0)
+  flush_ring(0, LOGS_OUTPUT_COUNT);
+  return;
+#elif defined(LOGS_OS_LINUX) && defined(LOGS_PER_THREAD) && (LOGS_PER_THREAD != 0)
+  flush_thread_buffer(0, LOGS_OUTPUT_COUNT, complete_lines_size());
+  return;
+#endif
+
+#if defined(LOGS_OS_LINUX) && defined(LOGS_ASYNC_FLUSH) && (LOGS_ASYNC_FLUSH != 0)
+  flush_async(0, LOGS_OUTPUT_COUNT);
+  logs.buffer_end_idx = 0;
+  return;
+#endif
+
+#if defined(LOGS_OS_LINUX) && defined(LOGS_IO_URING) && (LOGS_IO_URING != 0)
+  if (io_uring.flush_mode != LOGS_FLUSH_WRITE)
+  {
+    flush_with_io_uring(0, LOGS_OUTPUT_COUNT);
+    logs.buffer_end_idx = 0;
+    return;
+  }
+#endif
+
+#if defined(LOGS_OUTPUT_LEVELS) && (LOGS_OUTPUT_LEVELS != 0)
+  if ((routing.segment_count != 0) || (logs.routed_output_mask != ((1u << LOGS_OUTPUT_COUNT) - 1)))
+  {
+    flush_routed_segments(0, LOGS_OUTPUT_COUNT);
+    return;
+  }
+#endif
+
+  // Trust that the caller knows the log buffer is not empty
+  for (u64 i = 0; i < LOGS_OUTPUT_COUNT; i++)
+  {
+    u32 output = logs.outputs[i];
+    if (output != 0)
+    {
+      write_to_output(output, logs.buffer, logs.buffer_end_idx);
+    }
+  }
+
+  logs.buffer_end_idx = 0;
+}
+
+
+void logs_flush_to(logs_output_idx output_idx)
+{
+#if defined(LOGS_OS_LINUX) && defined(LOGS_FILE_ROTATION) && (LOGS_FILE_ROTATION != 0) && \
+    (!defined(LOGS_ASYNC_FLUSH) || (LOGS_ASYNC_FLUSH == 0))
+  if ((output_idx == LOGS_OUTPUT_FILE) && (logs.outputs[LOGS_OUTPUT_FILE] != 0))
+  {
+    rotate_file_output_if_due();
+  }
+#endif
+
+#if defined(LOGS_DEFERRED_FORMATTING) && (LOGS_DEFERRED_FORMATTING != 0)
+  format_deferred_records(output_idx, output_idx + 1);
+#endif
+
+#if defined(LOGS_OS_LINUX) && defined(LOGS_BINARY) && (LOGS_BINARY != 0)
+  write_binary_dictionaries(output_idx, output_idx + 1);
+#endif
+
+#if defined(LOGS_OS_LINUX) && defined(LOGS_ZERO_COPY) && (LOGS_ZERO_COPY != 0)
+  if (zero_copy.ref_count != 0)
+  {
+    flush_with_refs(output_idx, output_idx + 1);
+    return;
+  }
+#endif
+
+#if defined(LOGS_OS_LINUX) && defined(LOGS_SHARED_RING) && (LOGS_SHARED_RING != 0)
+  flush_ring(output_idx, output_idx + 1);
+  return;
+#elif defined(LOGS_OS_LINUX) && defined(LOGS_PER_THREAD) && (LOGS_PER_THREAD != 0)
+  flush_thread_buffer(output_idx, output_idx + 1, complete_lines_size());
+  return;
+#endif
+
+#if defined(LOGS_OS_LINUX) && defined(LOGS_ASYNC_FLUSH) && (LOGS_ASYNC_FLUSH != 0)
+  flush_async(output_idx, output_idx + 1);
+  logs.buffer_end_idx = 0;
+  return;
+#endif
+
+#if defined(LOGS_OS_LINUX) && defined(LOGS_IO_URING) && (LOGS_IO_URING != 0)
+  if (io_uring.flush_mode != LOGS_FLUSH_WRITE)
+  {
+    flush_with_io_uring(output_idx, output_idx + 1);
+    logs.buffer_end_idx = 0;
+    return;
+  }
+#endif
+
+#if defined(LOGS_OUTPUT_LEVELS) && (LOGS_OUTPUT_LEVELS != 0)
+  if ((routing.segment_count != 0) || (logs.routed_output_mask != ((1u << LOGS_OUTPUT_COUNT) - 1)))
+  {
+    flush_routed_segments(output_idx, output_idx + 1);
+    return;
+  }
+#endif
+
+  u32 output = logs.outputs[output_idx];
+  if (output != 0)
+  {
+    write_to_output(output, logs.buffer, logs.buffer_end_idx);
+  }
+
+  logs.buffer_end_idx = 0;
+}
+
+
+#if defined(LOGS_OS_LINUX) && defined(LOGS_IO_URING) && (LOGS_IO_URING != 0)
+void logs_set_flush_mode(logs_flush_mode flush_mode)
+{
+  // Asynchronous writes are completed before flushes stop waiting for them
+  reap_io_uring_writes();
+  io_uring.flush_mode = flush_mode;
+}
+
+
+void logs_wait_for_flush(void)
+{
+  reap_io_uring_writes();
+}
+#endif
+
+
+#if defined(LOGS_OS_LINUX) && defined(LOGS_ASYNC_FLUSH) && (LOGS_ASYNC_FLUSH != 0)
+void logs_wait_for_flush(void)
+{
+  wait_for_written_buffers(async_flush.flushed_count, 0);
+}
+#endif
+
+
+#if defined(LOGS_OS_LINUX) && defined(LOGS_SHARED_RING) && (LOGS_SHARED_RING != 0)
+// Reserve span bytes in the ring of the calling thread's CPU in LOGS_PER_CPU mode, or else in the
+// shared ring. Returns the header of the record, stored at *position, or 0 if it is dropped
+static struct ring_header* reserve_ring_record(logs_thread* thread_logs, u64 span, u64* position)
+{
+#  if defined(LOGS_PER_CPU) && (LOGS_PER_CPU != 0)
+#    if LOGS_SHARED_RING_OVERWRITE == 0
+  u64 wrote_records = 0;
+#    endif
+  for (u32 cpu_idx; (cpu_idx = __atomic_load_n(&thread_logs->rseq.cpu_id_start, __ATOMIC_RELAXED)) <
+                    LOGS_PER_CPU_MAX_CPU_COUNT;)
+  {
+    const u64 reservation = reserve_in_cpu_ring(&thread_logs->rseq, cpu_idx, span, position);
+    if (reservation == CPU_RING_RESERVED)
+    {
+      return ring_header_at(cpu_idx, *position);
+    }
+
+    if (reservation == CPU_RING_FULL)
+    {
+#    if LOGS_SHARED_RING_OVERWRITE != 0
+      wait_for_ring_room(cpu_idx, *position + span);
+#    else
+      // The committed records are written once, then the record is dropped if the ring is still
+      // full. Nothing is reserved for a dropped record
+      if (wrote_records)
+      {
+        return 0;
+      }
+
+      flush_ring(0, LOGS_OUTPUT_COUNT);
+      wrote_records = 1;
+#    endif
+    }
+  }
+#  else
+  (void)thread_logs;
+#  endif
+
+#  if LOGS_SHARED_RING_OVERWRITE != 0
+  *position = __atomic_fetch_add(&rings[SHARED_RING_IDX].reserved_position, span, __ATOMIC_RELAXED);
+  wait_for_ring_room(SHARED_RING_IDX, *position + span);
+#  else
+  // A record is dropped without reserving any position when the ring is full, so that producers
+  // never wait for flushes. Its bytes are counted by logs_commit()
+  u64 reserved_position = __atomic_load_n(&rings[SHARED_RING_IDX].reserved_position,
+                                          __ATOMIC_RELAXED);
+  do
+  {
+    if (!ring_has_room_until(SHARED_RING_IDX, reserved_position + span))
+    {
+      return 0;
+    }
+  } while (!__atomic_compare_exchange_n(&rings[SHARED_RING_IDX].reserved_position,
+                                        &reserved_position, reserved_position + span, 1,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+  *position = reserved_position;
+#  endif
+
+  return ring_header_at(SHARED_RING_IDX, *position);
+}
+
+
+void logs_reserve(u64 max_byte_count)
+{
+  logs_thread* thread_logs = &logs;
+  const u64 max_size = (max_byte_count < LOGS_SHARED_RING_MAX_RECORD_SIZE) ?
+                       max_byte_count : LOGS_SHARED_RING_MAX_RECORD_SIZE;
+  const u64 span     = (RING_HEADER_SIZE + max_size + LOGS_BUFFER_PADDING + 7) & ~7ull;
+
+  thread_logs->record_max_size = max_size;
+  thread_logs->record_size     = RING_RECORD_NOT_FULL;
+  thread_logs->buffer_end_idx  = 0;
+
+  u64 position;
+  struct ring_header* header = reserve_ring_record(thread_logs, span, &position);
+  if (header == 0)
+  {
+    thread_logs->buffer      = thread_logs->discarded_logs;
+    thread_logs->record_logs = 0;
+    return;
+  }
+
+  header->span = (u32)span;
+#  if defined(LOGS_PER_CPU) && (LOGS_PER_CPU != 0) && (LOGS_PER_CPU_TIMESTAMPS != 0)
+  header->timestamp = __rdtsc();
+#  endif
+  thread_logs->record_position = position;
+  thread_logs->record_logs     = (u8*)(header + 1);
+  thread_logs->buffer          = thread_logs->record_logs;
+}
+
+
+void logs_commit(void)
+{
+  logs_thread* thread_logs = &logs;
+  if (thread_logs->record_max_size == 0)
+  {
+    // Logs appended without a reserved record are discarded
+    thread_logs->buffer_end_idx = 0;
+    return;
+  }
+
+  const u64 size = (thread_logs->record_size != RING_RECORD_NOT_FULL) ? thread_logs->record_size :
+                                                                        thread_logs->buffer_end_idx;
+  if (thread_logs->record_logs == 0)
+  {
+    __atomic_add_fetch(&ring.dropped_byte_count, size, __ATOMIC_RELAXED);
+  }
+  else
+  {
+    // The record's header precedes its logs, in whichever ring it was reserved
+    struct ring_header* header = (struct ring_header*)thread_logs->record_logs - 1;
+    header->size = (u32)size;
+    __atomic_store_n(&header->committed_position, thread_logs->record_position + 1,
+                     __ATOMIC_RELEASE);
+  }
+
+  thread_logs->buffer          = thread_logs->discarded_logs;
+  thread_logs->buffer_end_idx  = 0;
+  thread_logs->record_max_size = 0;
+  thread_logs->record_logs     = 0;
+  thread_logs->record_size     = RING_RECORD_NOT_FULL;
+}
+
+
+// Room left in the record reserved by this thread, 0 once an append didn't fit in it
+static inline u64 ring_record_remaining_bytes(void)
+{
+  logs_thread* thread_logs = &logs;
+  const u64 is_open = (thread_logs->record_size == RING_RECORD_NOT_FULL) &&
+                      (thread_logs->buffer_end_idx < thread_logs->record_max_size);
+  return is_open ? (thread_logs->record_max_size - thread_logs->buffer_end_idx) : 0;
+}
+
+
+// End the appends to the record reserved by this thread, whose logs keep their current size. The
+// next appends go to discarded_logs, from its start every time one may not fit
+static void end_ring_record(void)
+{
+  logs_thread* thread_logs = &logs;
+  if (thread_logs->record_size == RING_RECORD_NOT_FULL)
+  {
+    thread_logs->record_size = thread_logs->buffer_end_idx;
+    thread_logs->buffer      = thread_logs->discarded_logs;
+  }
+
+  thread_logs->buffer_end_idx = 0;
+}
+
+
+u64 logs_ring_dropped_byte_count(void)
+{
+  return __atomic_load_n(&ring.dropped_byte_count, __ATOMIC_RELAXED);
+}
+#endif
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//// Memory
+u64 logs_buffer_remaining_bytes(void)
+{
+#if defined(LOGS_OS_LINUX) && defined(LOGS_SHARED_RING) && (LOGS_SHARED_RING != 0)
+  return ring_record_remaining_bytes();
+#else
+  s64 difference      = LOGS_BUFFER_SIZE - logs.buffer_end_idx;
+  u64 remaining_bytes = (difference > 0ll) ? difference : 0ll;
+
+  return remaining_bytes;
+#endif
+}
+
+
+#if defined(LOGS_AUTO_FLUSH) && (LOGS_AUTO_FLUSH != 0)
+#  if (LOGS_AUTO_FLUSH_WATERMARK > LOGS_BUFFER_SIZE)
+#    error "LOGS_AUTO_FLUSH_WATERMARK must not be greater than LOGS_BUFFER_SIZE"
+#  endif
+#  if (LOGS_AUTO_FLUSH_WATERMARK < F64_MAX_SIZED_DEC_STR_SIZE)
+#    error "LOGS_AUTO_FLUSH_WATERMARK must leave room for the largest formatted number"
+#  endif
+#endif
+
+#if defined(LOGS_AUTO_FLUSH) && (LOGS_AUTO_FLUSH != 0)
+// Flush the whole buffer, for callers which need it empty. In LOGS_PER_THREAD mode, this includes
+// the incomplete last line
+static inline void flush_full_buffer(void)
+{
+#  if defined(LOGS_OS_LINUX) && defined(LOGS_PER_THREAD) && (LOGS_PER_THREAD != 0)
+  flush_thread_buffer(0, LOGS_OUTPUT_COUNT, logs.buffer_end_idx);
+#  else
+  logs_flush();
+#  endif
+}
+#endif
+
+// In LOGS_AUTO_FLUSH mode, flush the buffer if appending max_byte_count bytes could take it past
+// LOGS_AUTO_FLUSH_WATERMARK. max_byte_count is a constant everywhere this is called, which reduces
+// the check to a single compare. In LOGS_SHARED_RING mode, end the thread's record if they may not
+// fit in it. Does nothing otherwise
+static inline void reserve_bytes(u64 max_byte_count)
+{
+#if defined(LOGS_AUTO_FLUSH) && (LOGS_AUTO_FLUSH != 0)
+  if (logs.buffer_end_idx > (LOGS_AUTO_FLUSH_WATERMARK - max_byte_count))
+  {
+    logs_flush();
+
+#  if defined(LOGS_OS_LINUX) && defined(LOGS_PER_THREAD) && (LOGS_PER_THREAD != 0)
+    // The incomplete last line kept by the flush may still leave too little room
+    if (logs.buffer_end_idx > (LOGS_AUTO_FLUSH_WATERMARK - max_byte_count))
+    {
+      flush_full_buffer();
+    }
+#  endif
+  }
+#elif defined(LOGS_OS_LINUX) && defined(LOGS_SHARED_RING) && (LOGS_SHARED_RING != 0)
+  if ((logs.buffer_end_idx + max_byte_count) > logs.record_max_size)
+  {
+    end_ring_record();
+  }
+#else
+  (void)max_byte_count;
+#endif
+}
+
+
+#if defined(LOGS_DEFERRED_FORMATTING) && (LOGS_DEFERRED_FORMATTING != 0)
+static inline void append_deferred_record(enum deferred_formatting formatting, u64 bits, u64 size)
+{
+  reserve_bytes(LOGS_DEFERRED_RECORD_SIZE);
+
+  u8* const record = logs.buffer + logs.buffer_end_idx;
+  record[0]            = DEFERRED_RECORD_MARKER;
+  record[1]            = (u8)formatting;
+  *(u64*)(record + 2)  = size;
+  *(u64*)(record + 10) = bits;
+
+  logs.buffer_end_idx += LOGS_DEFERRED_RECORD_SIZE;
+}
+#endif
+
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//// Log levels
+void logs_set_level(u32 min_level)
+{
+  const u32 all_levels_mask = (1u << (LOGS_LEVEL_COUNT * LOGS_OUTPUT_COUNT)) - 1;
+  logs_level_mask = (all_levels_mask << (min_level * LOGS_OUTPUT_COUNT)) & all_levels_mask;
+}
+
+
+#if defined(LOGS_OUTPUT_LEVELS) && (LOGS_OUTPUT_LEVELS != 0)
+void logs_set_output_level(logs_output_idx output_idx, u32 min_level)
+{
+  for (u32 level = 0; level < LOGS_LEVEL_COUNT; level++)
+  {
+    const u32 level_bit = 1u << ((level * LOGS_OUTPUT_COUNT) + output_idx);
+    logs_level_mask = (level >= min_level) ? (logs_level_mask | level_bit) :
+                                             (logs_level_mask & ~level_bit);
+  }
+}
+
+
+void logs_route_to_outputs(u32 output_mask)
+{
+  const u64 segment_start_idx = (routing.segment_count != 0) ?
+                                routing.segments[routing.segment_count - 1].end_idx : 0;
+  // Empty segments are only rerouted
+  if (logs.buffer_end_idx != segment_start_idx)
+  {
+    if (routing.segment_count == LOGS_OUTPUT_LEVELS_MAX_SEGMENT_COUNT)
+    {
+      logs_flush();
+    }
+    else
+    {
+      routing.segments[routing.segment_count].end_idx     = logs.buffer_end_idx;
+      routing.segments[routing.segment_count].output_mask = logs.routed_output_mask;
+      routing.segment_count++;
+    }
+  }
+
+  logs.routed_output_mask = output_mask;
+}
+#endif
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//// Timestamps
+#if defined(LOGS_OS_LINUX)
+#  define CLOCK_GETTIME_SYSCALL 228
+#  define NANOSLEEP_SYSCALL     35
+#  define CLOCK_REALTIME        0
+#  define CLOCK_MONOTONIC       1
+#endif
+
+// Conversion of TSC values to timestamps: base_ns + (((tsc - base_tsc) * ns_per_tick) >> 32)
+static struct
+{
+  u64 base_tsc;
+  u64 base_ns;
+  u64 ns_per_tick; // 32.32 fixed point
+
+  // Taken by the first calibration, which the later ones measure the TSC frequency from
+  u64 first_tsc;
+  u64 first_monotonic_ns;
+
+  u32 is_calibrated;
+  u32 uses_tsc;
+} tsc_clock;
+
+
+// Whether the TSC is invariant, i.e. runs at a constant rate in all power states (CPUID leaf
+// 0x80000007, EDX bit 8)
+static u64 has_invariant_tsc(void)
+{
+  u32 regs[4];
+#if defined(_MSC_VER)
+  __cpuid((int*)regs, 0x80000000);
+  const u32 max_leaf = regs[0];
+  __cpuid((int*)regs, 0x80000007);
+#elif defined(__clang__) || defined(__GNUC__)
+  __asm__ ("cpuid" : "=a"(regs[0]), "=b"(regs[1]), "=c"(regs[2]), "=d"(regs[3]) : "a"(0x80000000), "c"(0));
+  const u32 max_leaf = regs[0];
+  __asm__ ("cpuid" : "=a"(regs[0]), "=b"(regs[1]), "=c"(regs[2]), "=d"(regs[3]) : "a"(0x80000007), "c"(0));
+#endif
+
+  return (max_leaf >= 0x80000007) && ((regs[3] >> 8) & 1);
+}
+
+
+// Read the OS's wall clock, or its monotonic clock, in nanoseconds. tsc is set to the TSC value
+// halfway through the read
+static u64 read_os_clock_ns(u64 is_monotonic, u64* tsc)
+{
+  const u64 tsc_before = __rdtsc();
+#if defined(LOGS_OS_WINDOWS)
+  u64 ns;
+  if (is_monotonic)
+  {
+    LARGE_INTEGER counter;
+    LARGE_INTEGER frequency;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    const u64 ticks = (u64)counter.QuadPart;
+    const u64 freq  = (u64)frequency.QuadPart;
+    ns = ((ticks / freq) * 1000000000ull) + (((ticks % freq) * 1000000000ull) / freq);
+  }
+  else
+  {
+    // In 100 ns intervals since 1601-01-01
+    FILETIME time;
+    GetSystemTimeAsFileTime(&time);
+    const u64 intervals = ((u64)time.dwHighDateTime << 32) | time.dwLowDateTime;
+    ns = (intervals - 116444736000000000ull) * 100;
+  }
+#elif defined(LOGS_OS_LINUX)
+  struct linux_timespec time;
+  const u64 clock_id = is_monotonic ? CLOCK_MONOTONIC : CLOCK_REALTIME;
+  register u64                    clock_gettime_syscall_rax __asm__("rax") = CLOCK_GETTIME_SYSCALL;
+  register u64                    clock_id_rdi              __asm__("rdi") = clock_id;
+  register struct linux_timespec* time_rsi                  __asm__("rsi") = &time;
+  __asm__ __volatile__ ("syscall" :
+                        "+r"(clock_gettime_syscall_rax) :
+                        "r"(clock_id_rdi), "r"(time_rsi) :
+                        "rcx", "r11", "memory");
+  const u64 ns = ((u64)time.sec * 1000000000ull) + (u64)time.nsec;
+#endif
+
+  *tsc = tsc_before + ((__rdtsc() - tsc_before) / 2);
+  return ns;
+}
+
+
+#if defined(LOGS_OS_LINUX)
+static const struct linux_timespec calibration_duration =
+{
+  .sec  = LOGS_CLOCK_CALIBRATION_MS / 1000,
+  .nsec = (LOGS_CLOCK_CALIBRATION_MS % 1000) * 1000000
+};
+#endif
+
+// Let the TSC and the OS's clocks run for LOGS_CLOCK_CALIBRATION_MS milliseconds
+static void wait_for_calibration(void)
+{
+#if defined(LOGS_OS_WINDOWS)
+  Sleep(LOGS_CLOCK_CALIBRATION_MS);
+#elif defined(LOGS_OS_LINUX)
+  register u64                          nanosleep_syscall_rax __asm__("rax") = NANOSLEEP_SYSCALL;
+  register const struct linux_timespec* duration_rdi          __asm__("rdi") = &calibration_duration;
+  register u64                          remaining_rsi         __asm__("rsi") = 0;
+  __asm__ __volatile__ ("syscall" :
+                        "+r"(nanosleep_syscall_rax) :
+                        "r"(duration_rdi), "r"(remaining_rsi) :
+                        "rcx", "r11", "memory");
+#endif
+}
+
+
+void logs_calibrate_clock(void)
+{
+  if (!tsc_clock.is_calibrated)
+  {
+    tsc_clock.uses_tsc           = (u32)has_invariant_tsc();
+    tsc_clock.first_monotonic_ns = read_os_clock_ns(1, &tsc_clock.first_tsc);
+    wait_for_calibration();
+  }
+
+  // The TSC frequency is measured against the monotonic clock, which the wall clock may jump away
+  // from, but not drift from. Rate limits rely on it even if timestamps don't use the TSC
+  u64 tsc;
+  const u64 monotonic_ns  = read_os_clock_ns(1, &tsc);
+  const f64 elapsed_ns    = (f64)(monotonic_ns - tsc_clock.first_monotonic_ns);
+  const f64 elapsed_ticks = (f64)(tsc - tsc_clock.first_tsc);
+  tsc_clock.ns_per_tick   = (u64)((elapsed_ns / elapsed_ticks) * 4294967296.0);
+  if (tsc_clock.uses_tsc)
+  {
+    tsc_clock.base_ns = read_os_clock_ns(0, &tsc_clock.base_tsc);
+  }
+
+  tsc_clock.is_calibrated = 1;
+}
+
+
+// Calibrate the clock if it never was, which the first timestamp or rate-limited message waits for
+// unless logs_calibrate_clock() was called before
+static void calibrate_clock_once(void)
+{
+  if (!tsc_clock.is_calibrated)
+  {
+    logs_calibrate_clock();
+  }
+}
+
+
+u64 logs_timestamp_ns(void)
+{
+  calibrate_clock_once();
+
+  if (tsc_clock.uses_tsc)
+  {
+    // TSC values read on other CPUs may be a few ticks behind base_tsc
+    const s64 ticks = (s64)(__rdtsc() - tsc_clock.base_tsc);
+    u64       ns_hi;
+    const u64 ns_lo = umul128((ticks > 0) ? (u64)ticks : 0, tsc_clock.ns_per_tick, &ns_hi);
+    return tsc_clock.base_ns + ((ns_hi << 32) | (ns_lo >> 32));
+  }
+
+  u64 tsc;
+  return read_os_clock_ns(0, &tsc);
+}
+
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//// Rate limiting & sampling
+void logs_pass_rate_limit(struct logs_site* site, u64 tsc, u32 max_per_second, u32 burst)
+{
+  if (site->interval_ticks == 0)
+  {
+    calibrate_clock_once();
+
+    const u64 ticks_per_second = (u64)(4294967296e9 / (f64)tsc_clock.ns_per_tick);
+    const u64 interval_ticks   = ticks_per_second / ((max_per_second != 0) ? max_per_second : 1);
+    site->interval_ticks = (interval_ticks != 0) ? interval_ticks : 1;
+    site->burst_ticks    = site->interval_ticks * ((burst != 0) ? (burst - 1) : 0);
+  }
+
+  // site->next + burst_ticks is the theoretical arrival time of the next message at the sustained
+  // rate, which moves forward by interval_ticks per logged message, and never lags behind the TSC
+  const u64 arrival_tsc = site->next + site->burst_ticks;
+  site->next = ((arrival_tsc > tsc) ? arrival_tsc : tsc) + site->interval_ticks - site->burst_ticks;
+
+  if (site->suppressed_count != 0)
+  {
+#if defined(LOGS_OS_LINUX) && defined(LOGS_BINARY) && (LOGS_BINARY != 0)
+    log_binary("suppressed {} messages from {}:{}\n", site->suppressed_count, site->file,
+               site->line);
+#else
+    log_literal_str("suppressed ");
+    log_dec_u64(site->suppressed_count);
+    log_literal_str(" messages from ");
+    log_null_terminated_utf8_str(site->file);
+    log_character(':');
+    log_dec_u64(site->line);
+    log_character('\n');
+#endif
+    site->suppressed_count = 0;
+  }
+}
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//// Characters & strings logging
+void log_utf8_character(char character)
+{
+  reserve_bytes(1);
+  logs.buffer[logs.buffer_end_idx] = character;
+  logs.buffer_end_idx += 1;
+}
+
+
+void log_utf16_character(char16 character)
+{
+  log_sized_utf16_str(&character, 1);
+}
+
+
+#if defined(LOGS_AUTO_FLUSH) && (LOGS_AUTO_FLUSH != 0)
+// Fill the buffer with as many characters of str as it can take, flush it, and repeat until all
+// characters were appended
+static void log_sized_utf8_str_in_chunks(const char* str, u64 char_count)
+{
+  u64 chunk_size = LOGS_AUTO_FLUSH_WATERMARK - logs.buffer_end_idx;
+  while (char_count > chunk_size)
+  {
+    copy_bytes(logs.buffer + logs.buffer_end_idx, (const u8*)str, chunk_size);
+    logs.buffer_end_idx += chunk_size;
+    flush_full_buffer();
+
+    str        += chunk_size;
+    char_count -= chunk_size;
+    chunk_size  = LOGS_AUTO_FLUSH_WATERMARK;
+  }
+
+  copy_bytes(logs.buffer + logs.buffer_end_idx, (const u8*)str, char_count);
+  logs.buffer_end_idx += char_count;
+}
+#endif
+
+
+void log_sized_utf8_str(const char* str, u64 char_count)
+{
+#if defined(LOGS_AUTO_FLUSH) && (LOGS_AUTO_FLUSH != 0)
+  if ((logs.buffer_end_idx + char_count) > LOGS_AUTO_FLUSH_WATERMARK)
+  {
+    log_sized_utf8_str_in_chunks(str, char_count);
+    return;
+  }
+#elif defined(LOGS_OS_LINUX) && defined(LOGS_SHARED_RING) && (LOGS_SHARED_RING != 0)
+  const u64 remaining_bytes = ring_record_remaining_bytes();
+  if (char_count > remaining_bytes)
+  {
+    // The record ends with the characters that fit in it
+    copy_bytes(logs.buffer + logs.buffer_end_idx, (const u8*)str, remaining_bytes);
+    logs.buffer_end_idx += remaining_bytes;
+    end_ring_record();
+    return;
+  }
+#endif
+
+  copy_bytes(logs.buffer + logs.buffer_end_idx, (const u8*)str, char_count);
+  logs.buffer_end_idx += char_count;
+}
+
+
+#if defined(LOGS_OS_LINUX) && defined(LOGS_ZERO_COPY) && (LOGS_ZERO_COPY != 0)
+void log_sized_utf8_str_ref(const char* str, u64 char_count)
+{
+  if (char_count < LOGS_ZERO_COPY_MIN_SIZE)
+  {
+    log_sized_utf8_str(str, char_count);
+    return;
+  }
+
+  if (zero_copy.ref_count == LOGS_ZERO_COPY_MAX_REF_COUNT)
+  {
+    logs_flush();
+  }
+
+  zero_copy.refs[zero_copy.ref_count].buffer_idx = logs.buffer_end_idx;
+  zero_copy.refs[zero_copy.ref_count].str        = (const u8*)str;
+  zero_copy.refs[zero_copy.ref_count].size       = char_count;
+  zero_copy.ref_count++;
+}
+#endif
+
+
+// Whether all the UTF-16 code units of units are ASCII characters
+static inline u64 utf16_units_are_ascii(__m128i units)
+{
+  const __m128i non_ascii_bits = _mm_and_si128(units, _mm_set1_epi16((s16)0xFF80));
+  return _mm_movemask_epi8(_mm_cmpeq_epi16(non_ascii_bits, _mm_setzero_si128())) == 0xFFFF;
+}
+
+
+// Whether some UTF-16 code units of units are surrogates (in [0xD800; 0xDFFF])
+static inline u64 utf16_units_have_surrogates(__m128i units)
+{
+  const __m128i surrogate_bits = _mm_and_si128(units, _mm_set1_epi16((s16)0xF800));
+  return _mm_movemask_epi8(_mm_cmpeq_epi16(surrogate_bits, _mm_set1_epi16((s16)0xD800))) != 0;
+}
+
+
+// Store the 2 UTF-8 encoded code points of encoded_pair (one per 32-bit half) one after the other,
+// their sizes being the 2 low bytes of sizes. Returns the end of the written bytes
+static inline u8* write_utf8_pair(u8* dest, u64 encoded_pair, u64 sizes)
+{
+  *(u32*)dest  = (u32)encoded_pair;
+  dest        += sizes & 0xFF;
+  *(u32*)dest  = (u32)(encoded_pair >> 32);
+  dest        += (sizes >> 8) & 0xFF;
+
+  return dest;
+}
+
+
+// Write the UTF-8 encoding of 8 UTF-16 code units without surrogates to dest. Each code unit is
+// encoded in a 32-bit lane, then the lanes are stored one after the other, each one overwriting
+// the unused bytes of the previous one. Returns the count of bytes written, up to 4 bytes past it
+// may be overwritten
+static inline u64 write_utf16_units_as_utf8(u8* dest, __m128i units)
+{
+  // Unicode          | byte_count | UTF-8
+  // -----------------|------------|---------------------------
+  // [0x0000; 0x007F] | 1          | 0wwwwwww
+  // [0x0080; 0x07FF] | 2          | 110xxxxx 10wwwwww
+  // [0x0800; 0xFFFF] | 3          | 1110yyyy 10xxxxxx 10wwwwww
+  const __m128i is_1_byte  = _mm_cmpeq_epi16(_mm_and_si128(units, _mm_set1_epi16((s16)0xFF80)),
+                                             _mm_setzero_si128());
+  const __m128i is_2_bytes = _mm_cmpeq_epi16(_mm_and_si128(units, _mm_set1_epi16((s16)0xF800)),
+                                             _mm_setzero_si128()); // also set for 1 byte
+  const __m128i low_6_bits = _mm_set1_epi16(0x3F);
+  const __m128i cont_w     = _mm_or_si128(_mm_and_si128(units, low_6_bits), _mm_set1_epi16(0x80));
+  const __m128i cont_x     = _mm_or_si128(_mm_and_si128(_mm_srli_epi16(units, 6), low_6_bits),
+                                          _mm_set1_epi16(0x80));
+  const __m128i lead_2     = _mm_or_si128(_mm_srli_epi16(units, 6),  _mm_set1_epi16(0xC0));
+  const __m128i lead_3     = _mm_or_si128(_mm_srli_epi16(units, 12), _mm_set1_epi16(0xE0));
+
+  // First and second bytes in the low 16 bits of each lane, third byte in the high 16 bits
+  const __m128i lead   = _mm_or_si128(_mm_and_si128(is_1_byte, units),
+                                      _mm_andnot_si128(is_1_byte,
+                                                       _mm_or_si128(_mm_and_si128(is_2_bytes, lead_2),
+                                                                    _mm_andnot_si128(is_2_bytes, lead_3))));
+  const __m128i second = _mm_or_si128(_mm_and_si128(is_2_bytes, cont_w),
+                                      _mm_andnot_si128(is_2_bytes, cont_x));
+  const __m128i first_two = _mm_or_si128(lead, _mm_slli_epi16(second, 8));
+
+  // 3 - 1 - 1 for 1 byte, 3 - 1 for 2 bytes, 3 for 3 bytes
+  const __m128i byte_counts = _mm_add_epi16(_mm_set1_epi16(3), _mm_add_epi16(is_1_byte, is_2_bytes));
+
+  const __m128i encoded_lo    = _mm_unpacklo_epi16(first_two, cont_w);
+  const __m128i encoded_hi    = _mm_unpackhi_epi16(first_two, cont_w);
+  const u64     encoded_sizes = (u64)_mm_cvtsi128_si64(_mm_packus_epi16(byte_counts, byte_counts));
+
+  u8* const str_start = dest;
+  dest = write_utf8_pair(dest, (u64)_mm_cvtsi128_si64(encoded_lo),                    encoded_sizes);
+  dest = write_utf8_pair(dest, (u64)_mm_cvtsi128_si64(_mm_srli_si128(encoded_lo, 8)), encoded_sizes >> 16);
+  dest = write_utf8_pair(dest, (u64)_mm_cvtsi128_si64(encoded_hi),                    encoded_sizes >> 32);
+  dest = write_utf8_pair(dest, (u64)_mm_cvtsi128_si64(_mm_srli_si128(encoded_hi, 8)), encoded_sizes >> 48);
+
+  return (u64)(dest - str_start);
+}
+
+
+// Write the UTF-8 encoding of the code points of str until at least str_end is reached, one code
+// point at a time. Returns the end of the written bytes, and the end of the read code units in
+// str_read_end
+static inline u8* write_utf16_code_points_as_utf8(u8* dest, const char16* str, const char16* str_end,
+                                                  const char16** str_read_end)
+{
+  while (str < str_end)
+  {
+    u32 unicode;
+    u64 char16_read        = utf16_code_point_to_unicode(str, &unicode);
+    u64 written_byte_count = unicode_to_utf8_code_point(unicode, dest);
+
+    str  += char16_read;
+    dest += written_byte_count;
+  }
+
+  *str_read_end = str;
+  return dest;
+}
+
+
+// Get the count of UTF-16 code units before the null terminator of str (which must be 2-byte
+// aligned). It is read with aligned 16-byte loads, which never cross a page boundary, and thus
+// never fault even though they may read past the null terminator
+static inline u64 utf16_str_length(const char16* str)
+{
+  const u64      misalignment = (u64)str & 15;
+  const __m128i* block        = (const __m128i*)((u64)str - misalignment);
+
+  // Null code units found before str are ignored
+  u32 null_unit_mask = (u32)_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_load_si128(block), _mm_setzero_si128()));
+  null_unit_mask &= 0xFFFFu << misalignment;
+  while (null_unit_mask == 0)
+  {
+    block          += 1;
+    null_unit_mask  = (u32)_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_load_si128(block), _mm_setzero_si128()));
+  }
+
+  return ((u64)block + tzcnt32(null_unit_mask) - (u64)str) / sizeof(char16);
+}
+
+
+// Transcode char16_count code units of str to UTF-8 and append them to the logs buffer. Returns the
+// count of code units read, which is one more than char16_count if its last code unit starts a
+// surrogate pair
+static inline u64 append_utf16_units(const char16* str, u64 char16_count)
+{
+  const char16* const str_start = str;
+  u8*                 dest      = logs.buffer + logs.buffer_end_idx;
+  const char16* const str_end = str + char16_count;
+
+  // 16 or 8 code units at a time
+  while ((str_end - str) >= 8)
+  {
+    const __m128i units = _mm_loadu_si128((const __m128i*)str);
+    if ((str_end - str) >= 16)
+    {
+      const __m128i next_units = _mm_loadu_si128((const __m128i*)(str + 8));
+      if (utf16_units_are_ascii(_mm_or_si128(units, next_units)))
+      {
+        _mm_storeu_si128((__m128i*)dest, _mm_packus_epi16(units, next_units));
+        dest += 16;
+        str  += 16;
+        continue;
+      }
+    }
+
+    if (utf16_units_are_ascii(units))
+    {
+      _mm_storel_epi64((__m128i*)dest, _mm_packus_epi16(units, units));
+      dest += 8;
+      str  += 8;
+    }
+    else if (!utf16_units_have_surrogates(units))
+    {
+      dest += write_utf16_units_as_utf8(dest, units);
+      str  += 8;
+    }
+    else
+    {
+      // Surrogate pairs are decoded one code point at a time. The last one may end 1 code unit past
+      // the 8 code units
+      dest = write_utf16_code_points_as_utf8(dest, str, str + 8, &str);
+    }
+  }
+
+  dest = write_utf16_code_points_as_utf8(dest, str, str_end, &str);
+
+  logs.buffer_end_idx = dest - logs.buffer;
+  return str - str_start;
+}
+
+
+#if defined(LOGS_AUTO_FLUSH) && (LOGS_AUTO_FLUSH != 0)
+// Transcode as many code units of str as the buffer can take, flush it, and repeat until all code
+// units were appended. A chunk ending on the first half of a surrogate pair also reads its second
+// half: 1 spare byte is kept for it, as a pair takes 4 bytes instead of 2 * 3
+static void log_sized_utf16_str_in_chunks(const char16* str, u64 char16_count)
+{
+  for (;;)
+  {
+    const u64 remaining_bytes = LOGS_AUTO_FLUSH_WATERMARK - logs.buffer_end_idx;
+    const u64 chunk_size      = (remaining_bytes != 0) ?
+                                ((remaining_bytes - 1) / UTF16_UNIT_MAX_UTF8_SIZE) : 0;
+    if (char16_count <= chunk_size)
+    {
+      append_utf16_units(str, char16_count);
+      return;
+    }
+
+    const u64 char16_read = append_utf16_units(str, chunk_size);
+    flush_full_buffer();
+
+    str          += char16_read;
+    char16_count -= char16_read;
+  }
+}
+#endif
+
+
+void log_sized_utf16_str(const char16* str, u64 char16_count)
+{
+#if defined(LOGS_AUTO_FLUSH) && (LOGS_AUTO_FLUSH != 0)
+  if ((logs.buffer_end_idx + (char16_count * UTF16_UNIT_MAX_UTF8_SIZE)) > LOGS_AUTO_FLUSH_WATERMARK)
+  {
+    log_sized_utf16_str_in_chunks(str, char16_count);
+    return;
+  }
+#elif defined(LOGS_OS_LINUX) && defined(LOGS_SHARED_RING) && (LOGS_SHARED_RING != 0)
+  const u64 remaining_bytes = ring_record_remaining_bytes();
+  if ((char16_count * UTF16_UNIT_MAX_UTF8_SIZE) > remaining_bytes)
+  {
+    // The record ends with the code units that surely fit in it, keeping 1 byte for the second
+    // half of a surrogate pair as in log_sized_utf16_str_in_chunks()
+    append_utf16_units(str, (remaining_bytes != 0) ?
+                            ((remaining_bytes - 1) / UTF16_UNIT_MAX_UTF8_SIZE) : 0);
+    end_ring_record();
+    return;
+  }
+#endif
+
+  append_utf16_units(str, char16_count);
+}
+
+
+// pshufb indices moving the bytes of a 16-byte block n bytes down when loaded from the n-th byte,
+// filling the top n bytes with 0
+static const u8 byte_shift_indices[32] =
+{
+  0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+  0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80
+};
+
+// Copy str to dest up to its null terminator (excluded), 16 bytes at a time. str is read with
+// aligned 16-byte loads, which never cross a page boundary, and thus never fault even though they
+// may read past the null terminator, which is searched for with pcmpeqb. Returns the count of bytes
+// copied. Up to 16 bytes past them may be overwritten
+static inline u64 copy_null_terminated_str(u8* dest, const char* str)
+{
+  // The first block is moved down so that str's first byte is its first byte
+  const u64      misalignment = (u64)str & 15;
+  const __m128i* block        = (const __m128i*)((u64)str - misalignment);
+  const __m128i  first_chars  = _mm_load_si128(block);
+  const __m128i  shift        = _mm_loadu_si128((const __m128i*)(byte_shift_indices + misalignment));
+  _mm_storeu_si128((__m128i*)dest, _mm_shuffle_epi8(first_chars, shift));
+
+  u32 null_char_mask = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(first_chars, _mm_setzero_si128()));
+  null_char_mask >>= misalignment;
+  if (null_char_mask != 0)
+  {
+    return tzcnt32(null_char_mask);
+  }
+
+  u64 copied_byte_count = 16 - misalignment;
+  for (;;)
+  {
+    block += 1;
+    const __m128i chars = _mm_load_si128(block);
+    _mm_storeu_si128((__m128i*)(dest + copied_byte_count), chars);
+
+    null_char_mask = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(chars, _mm_setzero_si128()));
+    if (null_char_mask != 0)
+    {
+      return copied_byte_count + tzcnt32(null_char_mask);
+    }
+
+    copied_byte_count += 16;
+  }
+}
+
+
+void log_null_terminated_utf8_str(const char* str)
+{
+#if (defined(LOGS_AUTO_FLUSH) && (LOGS_AUTO_FLUSH != 0)) || \
+    (defined(LOGS_OS_LINUX) && defined(LOGS_SHARED_RING) && (LOGS_SHARED_RING != 0))
+  // The length of str must be known to reserve space for it
+  log_sized_utf8_str(str, utf8_str_length(str));
+#else
+  logs.buffer_end_idx += copy_null_terminated_str(logs.buffer + logs.buffer_end_idx, str);
+#endif
+}
+
+
+void log_null_terminated_utf16_str(const char16* str)
+{
+  log_sized_utf16_str(str, utf16_str_length(str));
+}
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//// Non-alphanumeric types logging
+static const char* bool_str = "truefalse";
+
+void log_bool(u64 boolean)
+{
+  const u64 is_false = (boolean == 0);
+  const u64 offset   = is_false << 2; // 4 if (boolean == 0), 0 otherwise
+
+  // Starts either at the 't' of "true" or the 'f' of "false"
+  const char* bool_str_start = bool_str + offset;
+
+  // length("true") = 4, length("false") = 5, is_false = 0 or 1
+  const u64 char_count  = 4 + is_false;   
+  reserve_bytes(BOOL_MAX_STR_SIZE);
+  log_sized_utf8_str(bool_str_start, char_count);
+}
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//// Compounds logging
+static const u64 unit_multipliers[] =
+{
+  1ull, // no unit multiplier
+  1000ull, // Kilo (K)
+  1000000ull, // Mega (M)
+  1000000000ull, // Giga (G)
+  1000000000000ull, // Tera (T)
+  1000000000000000ull, // Peta (P)
+  1000000000000000000ull // Exa (E)
+};
+
+static const char unit_prefixes[7] = {0, 'K', 'M', 'G', 'T', 'P', 'E'};
+
+void log_byte_count_dec_unit(u64 byte_count)
+{
+  reserve_bytes(BYTE_COUNT_DEC_UNIT_MAX_STR_SIZE);
+
+  // Log the integer part
+  const u64 digit_count          = u64_digit_count(byte_count); // in [1; 20]
+  const u64 unit_idx             = (digit_count - 1) / 3; // in [0; 6]
+  const u64 unit_mul             = unit_multipliers[unit_idx];
+  const u64 int_byte_count       = byte_count / unit_mul; // has 1 to 3 digits
+  const u64 int_byte_digit_count = digit_count - (unit_idx * 3);
+
+  log_sized_dec_u64(int_byte_count, int_byte_digit_count);
+
+  // Log the fractional part (if necessary)
+  const u32 byte_count_ge_1000 = byte_count >= 1000;
+  if (byte_count_ge_1000)
+  {
+    const u64 byte_count_remainder = byte_count - (int_byte_count * unit_mul);
+    const u64 frac_byte_count      = (BYTE_COUNT_FRAC_DIV * byte_count_remainder) / unit_mul;
+    log_character('.');
+    log_sized_dec_u64(frac_byte_count, BYTE_COUNT_FRAC_SIZE);
+  }
+
+  // Log the unit prefix and the unit itself
+  // ' ' [+ unit prefix] + 'B' = 2 mandatory + 1 optional characters
+  u8* const dest              = logs.buffer + logs.buffer_end_idx;
+  const u64 b_char_idx        = 1 + byte_count_ge_1000;
+  const u64 suffix_char_count = 2 + byte_count_ge_1000;
+
+  dest[0]          = ' ';
+  dest[1]          = unit_prefixes[unit_idx]; // overwritten if unnecessary
+  dest[b_char_idx] = 'B';
+
+  logs.buffer_end_idx += suffix_char_count;
+}
+
+
+void log_byte_count_bin_unit(u64 byte_count)
+{
+  reserve_bytes(BYTE_COUNT_BIN_UNIT_MAX_STR_SIZE);
+
+  // Log the integer part
+  const u64 msb_idx        = get_msb_1_bit_idx_u64(byte_count);
+  const u64 prefix_idx     = msb_idx / 10;
+  const u8  mul_shift      = (u8)(prefix_idx * 10);
+  const u32 int_byte_count = (u32)(byte_count >> mul_shift);
+  log_dec_u32(int_byte_count);
+
+  // Log the fractional part (if necessary)
+  const u32 byte_count_ge_1024 = byte_count >= 1024;
+  if (byte_count_ge_1024)
+  {
+    const u64 byte_count_remainder = byte_count - (int_byte_count << mul_shift);
+    const u64 unit_mul             = 1ull << mul_shift;
+    const u64 frac_byte_count      = (BYTE_COUNT_FRAC_DIV * byte_count_remainder) / unit_mul;
+    log_character('.');
+    log_sized_dec_u64(frac_byte_count, BYTE_COUNT_FRAC_SIZE);
+  }
+
+  // Log the unit prefix and the unit itself
+  // ' ' [+ unit prefix + 'i'] + 'B' = 2 mandatory + 2 optional characters
+  u8* const dest              = logs.buffer + logs.buffer_end_idx;
+  const u64 b_char_offset     = byte_count_ge_1024 * 2;
+  const u64 suffix_char_count = 2 + b_char_offset;
+  const u64 i_char_idx        = 1 + byte_count_ge_1024;
+  const u64 b_char_idx        = 1 + b_char_offset;
+
+  dest[0]          = ' ';
+  dest[1]          = unit_prefixes[prefix_idx]; // overwritten if unnecessary
+  dest[i_char_idx] = 'i'; // overwritten if unnecessary
+  dest[b_char_idx] = 'B';
+
+  logs.buffer_end_idx += suffix_char_count;
+}
+
+
+// The cache is only written and read with copy_bytes(), as wider stores and loads of its characters
+// would break strict aliasing
+static inline void cache_digit_pair(u8* dest, u64 num)
+{
+  const u16 digit_pair = (u16)dec_digit_pair(num);
+  copy_bytes(dest, (const u8*)&digit_pair, 2);
+}
+
+
+// Format second (since the Unix epoch) to the cache, and its date if its day isn't the cached one
+static void cache_timestamp_second(u64 second)
+{
+  struct logs_timestamp_cache* const timestamp_cache = &logs.timestamp_cache;
+
+  const u64 second_of_day = second % 86400;
+  const u64 minute_of_day = second_of_day / 60;
+  u8* const time          = timestamp_cache->date_time + 11;
+  cache_digit_pair(time + 0, minute_of_day / 60);
+  cache_digit_pair(time + 3, minute_of_day % 60);
+  cache_digit_pair(time + 6, second_of_day % 60);
+  timestamp_cache->second = second;
+
+  const u64 day = second / 86400;
+  if (day == timestamp_cache->day)
+  {
+    return;
+  }
+
+  // Civil date of a count of days since 1970-01-01 in the proleptic Gregorian calendar (Howard
+  // Hinnant's civil_from_days()). Years are counted from March 1st, which puts leap days at their
+  // end, in 400-year eras of 146097 days. Months are mapped back to January-based ones with a
+  // compare instead of a branch
+  const u64 days         = day + 719468; // since 0000-03-01
+  const u64 era          = days / 146097;
+  const u64 day_of_era   = days - (era * 146097); // in [0; 146096]
+  const u64 year_of_era  = (day_of_era - (day_of_era / 1460) + (day_of_era / 36524) -
+                            (day_of_era / 146096)) / 365; // in [0; 399]
+  const u64 day_of_year  = day_of_era - ((365 * year_of_era) + (year_of_era / 4) - (year_of_era / 100));
+  const u64 month_idx    = ((5 * day_of_year) + 2) / 153; // in [0; 11], from March
+  const u64 day_of_month = day_of_year - (((153 * month_idx) + 2) / 5) + 1;
+  const u64 is_jan_feb   = month_idx >= 10;
+  const u64 month        = month_idx + 3 - (is_jan_feb * 12);
+  const u64 year         = (era * 400) + year_of_era + is_jan_feb;
+
+  u8* const date = timestamp_cache->date_time;
+  cache_digit_pair(date + 0, year / 100);
+  cache_digit_pair(date + 2, year % 100);
+  cache_digit_pair(date + 5, month);
+  cache_digit_pair(date + 8, day_of_month);
+  timestamp_cache->day = day;
+}
+
+
+// Copy the 19 cached characters of "YYYY-MM-DDTHH:MM:SS" to dest with 2 overlapping 16-byte stores
+static inline void copy_cached_date_time(u8* dest)
+{
+  copy_bytes(dest, logs.timestamp_cache.date_time, 19);
+}
+
+
+// Log "YYYY-MM-DDTHH:MM:SS" of second, then frac with frac_digit_count digits after a '.' (if any)
+// and 'Z'
+static inline void log_iso8601(u64 second, u64 frac, u64 frac_digit_count)
+{
+  if (second != logs.timestamp_cache.second)
+  {
+    cache_timestamp_second(second);
+  }
+
+  u8* const dest = logs.buffer + logs.buffer_end_idx;
+  copy_cached_date_time(dest);
+  dest[19] = '.'; // overwritten if unnecessary
+  logs.buffer_end_idx += 19 + (frac_digit_count != 0);
+
+  log_sized_dec_u64(frac, frac_digit_count);
+  log_character('Z');
+}
+
+
+void log_time_of_day(u64 timestamp_ns)
+{
+  reserve_bytes(TIME_OF_DAY_MAX_STR_SIZE);
+
+  const u64 second = timestamp_ns / 1000000000;
+  if (second != logs.timestamp_cache.second)
+  {
+    cache_timestamp_second(second);
+  }
+
+  u8* const dest = logs.buffer + logs.buffer_end_idx;
+  copy_bytes(dest, logs.timestamp_cache.date_time + 11, 8);
+  dest[8] = '.';
+  logs.buffer_end_idx += 9;
+
+  log_sized_dec_u64(timestamp_ns - (second * 1000000000), 9);
+}
+
+
+// Last second of 9999-12-31, the last day with a 4-digit year. Later timestamps are clamped to it
+// (and to its last fractional digits), nanosecond ones can't exceed it
+#define ISO8601_MAX_SECOND 253402300799ull
+
+void log_iso8601_s(u64 timestamp_s)
+{
+  reserve_bytes(ISO8601_S_MAX_STR_SIZE);
+
+  timestamp_s = (timestamp_s < ISO8601_MAX_SECOND) ? timestamp_s : ISO8601_MAX_SECOND;
+  log_iso8601(timestamp_s, 0, 0);
+}
+
+
+void log_iso8601_ms(u64 timestamp_ms)
+{
+  reserve_bytes(ISO8601_MS_MAX_STR_SIZE);
+
+  const u64 max_timestamp_ms = (ISO8601_MAX_SECOND * 1000) + 999;
+  timestamp_ms = (timestamp_ms < max_timestamp_ms) ? timestamp_ms : max_timestamp_ms;
+
+  const u64 second = timestamp_ms / 1000;
+  log_iso8601(second, timestamp_ms - (second * 1000), 3);
+}
+
+
+void log_iso8601_us(u64 timestamp_us)
+{
+  reserve_bytes(ISO8601_US_MAX_STR_SIZE);
+
+  const u64 max_timestamp_us = (ISO8601_MAX_SECOND * 1000000) + 999999;
+  timestamp_us = (timestamp_us < max_timestamp_us) ? timestamp_us : max_timestamp_us;
+
+  const u64 second = timestamp_us / 1000000;
+  log_iso8601(second, timestamp_us - (second * 1000000), 6);
+}
+
+
+void log_iso8601_ns(u64 timestamp_ns)
+{
+  reserve_bytes(ISO8601_NS_MAX_STR_SIZE);
+
+  const u64 second = timestamp_ns / 1000000000;
+  log_iso8601(second, timestamp_ns - (second * 1000000000), 9);
+}
+
+
+void log_os_api_error(u32 error_code)
+{
+#if defined(LOGS_OS_WINDOWS)
+  const DWORD flags = FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS;
+
+  // Can be obtained either from winnt.h, or through "Windows Language Code Identifier (LCID)
+  // Reference", version 16.0 (23rd April 2024), page 14:
+  // https://winprotocoldoc.z19.web.core.windows.net/MS-LCID/[MS-LCID].pdf#page=14
+  const WORD en_us_lang_id = 0x0409;
+
+  log_literal_str("Windows API error ");
+  log_dec_u32(error_code);
+  log_literal_str(": ");
+
+#if defined(LOGS_AUTO_FLUSH) && (LOGS_AUTO_FLUSH != 0)
+  // Descriptions longer than the space left fail to be formatted, and are replaced by the fallback
+  // below
+  const DWORD max_bytes = (DWORD)(LOGS_AUTO_FLUSH_WATERMARK - logs.buffer_end_idx);
+#else
+  // None of the functions appending content to the logs buffer make sure there is enough space to
+  // write to. Lie about the available space in the logs buffer to remain consistent
+  const DWORD max_bytes = 64000; // maximum allowed by FormatMessage()
+#endif
+
+  char* dest = (char*)(logs.buffer + logs.buffer_end_idx);
+
+  DWORD char_written = FormatMessageA(flags,         // dwFlags
+                                      0,             // lpSource
+                                      error_code,    // dwMessageId
+                                      en_us_lang_id, // dwLanguageId
+                                      dest,          // lpBuffer
+                                      max_bytes,     // nSize
+                                      0);            // Arguments
+  if (char_written == 0)
+  {
+    // Something went wrong, fallback
+    log_literal_str("couldn't get error description)");
+  }
+  else
+  {
+    // Messages finish with a carriage return + linefeed. Both are removed
+    logs.buffer_end_idx += char_written - 2;
+  }
+#elif defined(LOGS_OS_LINUX)
+#  include "linux_errno_to_str.inl"
+  // Error codes unknown to linux_errno_to_str are described the same way as unimplemented ones
+  const u64   errno_count = sizeof(linux_errno_to_str) / sizeof(linux_errno_to_str[0]);
+  const char* error_str   = (error_code < errno_count) ? linux_errno_to_str[error_code] : "?";
+  log_literal_str("Linux API error ");
+  log_dec_u32(error_code);
+  log_literal_str(": ");
+  log_null_terminated_utf8_str(error_str);
+#endif
+}
+
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//// Line prefixes
+// Placeholders of fields, which log_prefix() overwrites
+static const char prefix_placeholder_digits[] = "00000000000000000000";
+static const char prefix_placeholder_date_time[] = "0000-00-00T00:00:00.";
+
+static inline void append_prefix_bytes(logs_prefix* prefix, u64 variant_idx, const char* bytes,
+                                       u64 byte_count)
+{
+  u8* const dest = prefix->bytes[variant_idx] + prefix->sizes[variant_idx];
+  for (u64 i = 0; i < byte_count; i++)
+  {
+    dest[i] = (u8)bytes[i];
+  }
+
+  prefix->sizes[variant_idx] += (u8)byte_count;
+}
+
+
+void logs_prefix_append_str(logs_prefix* prefix, const char* str, u64 char_count)
+{
+  // The variant with escape sequences is the longest
+  if (char_count <= (u64)(LOGS_PREFIX_MAX_SIZE - prefix->sizes[1]))
+  {
+    append_prefix_bytes(prefix, 0, str, char_count);
+    append_prefix_bytes(prefix, 1, str, char_count);
+  }
+}
+
+
+void logs_prefix_append_ansi_str(logs_prefix* prefix, const char* str, u64 char_count)
+{
+  if (char_count <= (u64)(LOGS_PREFIX_MAX_SIZE - prefix->sizes[1]))
+  {
+    append_prefix_bytes(prefix, 1, str, char_count);
+  }
+}
+
+
+void logs_prefix_append_field(logs_prefix* prefix, logs_prefix_field_type field_type,
+                              u64 digit_count)
+{
+  u64 field_size;
+  if (field_type == LOGS_PREFIX_DEC)
+  {
+    digit_count = (digit_count < U64_MAX_DEC_STR_SIZE) ? digit_count : U64_MAX_DEC_STR_SIZE;
+    digit_count = (digit_count != 0) ? digit_count : 1;
+    field_size  = digit_count;
+  }
+  else
+  {
+    // "[YYYY-MM-DDT]HH:MM:SS[.fraction][Z]"
+    digit_count = (digit_count < 9) ? digit_count : 9;
+    field_size  = 8 + (digit_count + (digit_count != 0)) + ((field_type == LOGS_PREFIX_ISO8601) * 12);
+  }
+
+  if ((prefix->field_count == LOGS_PREFIX_MAX_FIELD_COUNT) ||
+      (field_size > (u64)(LOGS_PREFIX_MAX_SIZE - prefix->sizes[1])))
+  {
+    return;
+  }
+
+  struct logs_prefix_field* const field = prefix->fields + prefix->field_count;
+  field->type        = (u8)field_type;
+  field->digit_count = (u8)digit_count;
+  field->offsets[0]  = prefix->sizes[0];
+  field->offsets[1]  = prefix->sizes[1];
+  prefix->field_count += 1;
+
+  for (u64 variant_idx = 0; variant_idx < 2; variant_idx++)
+  {
+    if (field_type == LOGS_PREFIX_DEC)
+    {
+      append_prefix_bytes(prefix, variant_idx, prefix_placeholder_digits, digit_count);
+      continue;
+    }
+
+    const u64 date_size = (field_type == LOGS_PREFIX_ISO8601) ? 11 : 0;
+    append_prefix_bytes(prefix, variant_idx, prefix_placeholder_date_time + 11 - date_size,
+                        date_size + 8 + (digit_count != 0));
+    append_prefix_bytes(prefix, variant_idx, prefix_placeholder_digits, digit_count);
+    if (field_type == LOGS_PREFIX_ISO8601)
+    {
+      append_prefix_bytes(prefix, variant_idx, "Z", 1);
+    }
+  }
+}
+
+
+void log_prefix(const logs_prefix* prefix, const u64* values)
+{
+  reserve_bytes(LOGS_PREFIX_MAX_SIZE);
+
+  const u64       variant_idx = ansi_escape_sequences_enabled;
+  const u8* const bytes       = prefix->bytes[variant_idx];
+  const u64       field_count = prefix->field_count;
+  const u64       size        = prefix->sizes[variant_idx];
+  u8* const       dest        = logs.buffer + logs.buffer_end_idx;
+
+  // Static bytes, whatever their size. The loads are all issued before the stores
+  const __m128i bytes_0 = _mm_load_si128((const __m128i*)(bytes + 0));
+  const __m128i bytes_1 = _mm_load_si128((const __m128i*)(bytes + 16));
+  const __m128i bytes_2 = _mm_load_si128((const __m128i*)(bytes + 32));
+  const __m128i bytes_3 = _mm_load_si128((const __m128i*)(bytes + 48));
+  _mm_storeu_si128((__m128i*)(dest + 0),  bytes_0);
+  _mm_storeu_si128((__m128i*)(dest + 16), bytes_1);
+  _mm_storeu_si128((__m128i*)(dest + 32), bytes_2);
+  _mm_storeu_si128((__m128i*)(dest + 48), bytes_3);
+
+  for (u64 field_idx = 0; field_idx < field_count; field_idx++)
+  {
+    // Copied before storing the field, as stores to the buffer could otherwise alias the prefix
+    const struct logs_prefix_field field = prefix->fields[field_idx];
+    const u64 value       = values[field_idx];
+    const u64 digit_count = field.digit_count;
+    u8* const field_dest  = dest + field.offsets[variant_idx];
+    u8*       digits_end;
+
+    if ((field.type == LOGS_PREFIX_DEC) && (digit_count <= 8))
+    {
+      // Thread ids, line numbers and the like: 8 digits stored at once, shifted to only keep the
+      // least significant ones
+      const u64 digits = dec_8_digits((u32)(value % 100000000));
+      *(u64*)field_dest = digits >> ((8 - digit_count) * 8);
+      digits_end        = field_dest + digit_count;
+    }
+    else if (field.type == LOGS_PREFIX_DEC)
+    {
+      write_dec_u64(field_dest, value, digit_count);
+      digits_end = field_dest + digit_count;
+    }
+    else
+    {
+      const u64 second = value / 1000000000;
+      if (second != logs.timestamp_cache.second)
+      {
+        cache_timestamp_second(second);
+      }
+
+      u8* digits;
+      if (field.type == LOGS_PREFIX_ISO8601)
+      {
+        copy_cached_date_time(field_dest);
+        digits = field_dest + 20;
+      }
+      else
+      {
+        copy_bytes(field_dest, logs.timestamp_cache.date_time + 11, 8);
+        digits = field_dest + 9;
+      }
+
+      if (digit_count == 0)
+      {
+        continue;
+      }
+
+      // All 9 digits of the nanoseconds are written, those past digit_count being restored below
+      const u32 ns = (u32)(value - (second * 1000000000));
+      digits[0]           = (u8)('0' + (ns / 100000000));
+      *(u64*)(digits + 1) = dec_8_digits(ns % 100000000);
+      digits_end          = digits + digit_count;
+    }
+
+    // Bytes overwritten past the digits are copied back from the template. These stores alias the
+    // digits stores
+    _mm_storeu_si128((__m128i*)digits_end,
+                     _mm_loadu_si128((const __m128i*)(bytes + (digits_end - dest))));
+  }
+
+  logs.buffer_end_idx += size;
+}
+
+
+
+
+#if defined(LOGS_OS_LINUX) && defined(LOGS_BINARY) && (LOGS_BINARY != 0)
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//// Binary logging
+void log_binary_site(const struct logs_binary_site* site)
+{
+  // Tags are call site indices plus 1, 0 starting a dictionary
+  const u64 tag = (u64)(site - __start_logs_binary_sites) + 1;
+  reserve_bytes(VARINT_MAX_SIZE);
+  logs.buffer_end_idx += write_varint(logs.buffer + logs.buffer_end_idx, tag);
+}
+
+
+void log_binary_u64(u64 num)
+{
+  reserve_bytes(VARINT_MAX_SIZE);
+  logs.buffer_end_idx += write_varint(logs.buffer + logs.buffer_end_idx, num);
+}
+
+
+void log_binary_s64(s64 num)
+{
+  // Zigzag encoding interleaves positive and negative values, keeping small ones short
+  const u64 zigzag = ((u64)num << 1) ^ (u64)(num >> 63);
+  reserve_bytes(VARINT_MAX_SIZE);
+  logs.buffer_end_idx += write_varint(logs.buffer + logs.buffer_end_idx, zigzag);
+}
+
+
+void log_binary_f32(f32 num)
+{
+  reserve_bytes(sizeof(f32));
+  *(u32*)(logs.buffer + logs.buffer_end_idx) = *(u32*)&num;
+  logs.buffer_end_idx += sizeof(f32);
+}
+
+
+void log_binary_f64(f64 num)
+{
+  reserve_bytes(sizeof(f64));
+  *(u64*)(logs.buffer + logs.buffer_end_idx) = *(u64*)&num;
+  logs.buffer_end_idx += sizeof(f64);
+}
+
+
+void log_binary_str(const char* str)
+{
+  const u64 char_count = utf8_str_length(str);
+  log_binary_u64(char_count);
+  log_sized_utf8_str(str, char_count);
+}
+#endif
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//// Numbers logging
+// Append zero_count (>= 1) '0' characters, 16 at a time. The sized functions use it for the leading
+// zeros requested beyond the digits a u64 can have, so that they only reserve the size of a u64
+static void log_zero_padding(u64 zero_count)
+{
+  do
+  {
+    reserve_bytes(16);
+
+    const u64 chunk_size = (zero_count < 16) ? zero_count : 16;
+    _mm_storeu_si128((__m128i*)(logs.buffer + logs.buffer_end_idx), _mm_set1_epi8('0'));
+    logs.buffer_end_idx += chunk_size;
+    zero_count          -= chunk_size;
+  } while (zero_count != 0);
+}
+
+
+// Binary
+// Write the bit_count (>= 1) least significant bits of num to dest, left-padded with '0'. Up to 7
+// bytes past the last bit may be overwritten
+static inline void write_bin_u64(u8* dest, u64 num, u64 bit_count)
+{
+  // u64 values have 64 bits, anything requested beyond can only be a '0'
+  while (bit_count > 64)
+  {
+    *dest = '0';
+    dest      += 1;
+    bit_count -= 1;
+  }
+
+  // Move the bits to write to the most significant end of num. Whole bytes are converted, the
+  // unwanted bits of the last one end up past the last written character
+  num <<= 64 - bit_count;
+
+  u8* const dest_end = dest + bit_count;
+  do
+  {
+    // Deposit the 8 bits of the most significant byte into the lowest bit of 8 bytes, from bit 0
+    // (last character) to bit 7 (first character), then reverse them and turn 0/1 into '0'/'1'
+    const u64 top_byte  = num >> 56;
+    const u64 deposited = pdep64(top_byte, 0x0101010101010101ull);
+    *(u64*)dest = bswap64(deposited) | 0x3030303030303030ull;
+
+    dest += 8;
+    num <<= 8;
+  } while (dest < dest_end);
+}
+
+
+void log_sized_bin_s8 (s8  num, u64 bit_to_write_count) { log_sized_bin_u64((u64)num, bit_to_write_count); }
+void log_sized_bin_s16(s16 num, u64 bit_to_write_count) { log_sized_bin_u64((u64)num, bit_to_write_count); }
+void log_sized_bin_s32(s32 num, u64 bit_to_write_count) { log_sized_bin_u64((u64)num, bit_to_write_count); }
+void log_sized_bin_s64(s64 num, u64 bit_to_write_count) { log_sized_bin_u64((u64)num, bit_to_write_count); }
+void log_sized_bin_u8 (u8  num, u64 bit_to_write_count) { log_sized_bin_u64(num,      bit_to_write_count); }
+void log_sized_bin_u16(u16 num, u64 bit_to_write_count) { log_sized_bin_u64(num,      bit_to_write_count); }
+void log_sized_bin_u32(u32 num, u64 bit_to_write_count) { log_sized_bin_u64(num,      bit_to_write_count); }
+
+
+void log_sized_bin_u64(u64 num, u64 bit_to_write_count)
+{
+  DEFER_FORMATTING(DEFERRED_SIZED_BIN_U64, num, bit_to_write_count);
+
+  if (bit_to_write_count > U64_MAX_BIN_STR_SIZE)
+  {
+    log_zero_padding(bit_to_write_count - U64_MAX_BIN_STR_SIZE);
+    bit_to_write_count = U64_MAX_BIN_STR_SIZE;
+  }
+
+  reserve_bytes(U64_MAX_BIN_STR_SIZE);
+
+  if (bit_to_write_count != 0)
+  {
+    u8* const dest = logs.buffer + logs.buffer_end_idx;
+    write_bin_u64(dest, num, bit_to_write_count);
+
+    logs.buffer_end_idx += bit_to_write_count;
+  }
+}
+
+
+void log_sized_bin_f32(f32 num, u64 bit_to_write_count) { log_sized_bin_u64(*(u32*)(&num), bit_to_write_count); }
+
+
+void log_bin_s8 (s8  num) { log_sized_bin_u64((u64)num,      u32_bit_count((u32)num));    }
+void log_bin_s16(s16 num) { log_sized_bin_u64((u64)num,      u32_bit_count((u32)num));    }
+void log_bin_s32(s32 num) { log_sized_bin_u64((u64)num,      u32_bit_count((u32)num));    }
+void log_bin_s64(s64 num) { log_sized_bin_u64((u64)num,      u64_bit_count((u64)num));    }
+void log_bin_u8 (u8  num) { log_sized_bin_u64(num,           u32_bit_count(num));         }
+void log_bin_u16(u16 num) { log_sized_bin_u64(num,           u32_bit_count(num));         }
+void log_bin_u32(u32 num) { log_sized_bin_u64(num,           u32_bit_count(num));         }
+void log_bin_u64(u64 num) { log_sized_bin_u64(num,           u64_bit_count(num));         }
+void log_bin_f32(f32 num) { log_sized_bin_u64(*(u32*)(&num), u32_bit_count(*(u32*)&num)); }
+
+
+// Decimal number logging
+void log_sized_dec_s8 (s8  num, u64 digit_to_write_count) { log_sized_dec_u64((u64)num, digit_to_write_count); }
+void log_sized_dec_s16(s16 num, u64 digit_to_write_count) { log_sized_dec_u64((u64)num, digit_to_write_count); }
+void log_sized_dec_s32(s32 num, u64 digit_to_write_count) { log_sized_dec_u64((u64)num, digit_to_write_count); }
+
+
+void log_sized_dec_s64(s64 num, u64 digit_to_write_count)
+{
+  DEFER_FORMATTING(DEFERRED_SIZED_DEC_S64, (u64)num, digit_to_write_count);
+
+  reserve_bytes(1 + U64_MAX_DEC_STR_SIZE);
+
+  u64 is_neg  = num < 0;
+  u64 pos_num = is_neg ? -num : num;
+
+  logs.buffer[logs.buffer_end_idx] = '-'; // overwritten if unnecessary
+  logs.buffer_end_idx += is_neg;
+  
+  log_sized_dec_u64(pos_num, digit_to_write_count);
+}
+
+
+void log_sized_dec_u8 (u8  num, u64 digit_to_write_count) { log_sized_dec_u64(num, digit_to_write_count); }
+void log_sized_dec_u16(u16 num, u64 digit_to_write_count) { log_sized_dec_u64(num, digit_to_write_count); }
+void log_sized_dec_u32(u32 num, u64 digit_to_write_count) { log_sized_dec_u64(num, digit_to_write_count); }
+
+
+void log_sized_dec_u64(u64 num, u64 digit_to_write_count)
+{
+  DEFER_FORMATTING(DEFERRED_SIZED_DEC_U64, num, digit_to_write_count);
+
+  if (digit_to_write_count > U64_MAX_DEC_STR_SIZE)
+  {
+    log_zero_padding(digit_to_write_count - U64_MAX_DEC_STR_SIZE);
+    digit_to_write_count = U64_MAX_DEC_STR_SIZE;
+  }
+
+  reserve_bytes(U64_MAX_DEC_STR_SIZE);
+
+  if (digit_to_write_count != 0)
+  {
+    u8* const dest = logs.buffer + logs.buffer_end_idx;
+    write_dec_u64(dest, num, digit_to_write_count);
+
+    logs.buffer_end_idx += digit_to_write_count;
+  }
+}
+
+
+// Shortest round-trip floating-point formatting, see "The Schubfach way to render doubles" by
+// Raffaello Giulietti (https://drive.google.com/file/d/1gp5xv4CAa78SVgCeWfGqqI4FfYYYuNFb) and
+// https://github.com/abolz/Drachennest/blob/master/src/schubfach_64.cc
+// The f64 table goes beyond Schubfach's needs ([-292; 324]) so that any f32 or f64 can be scaled to
+// 17 significant digits by round_scaled_dec()
+#define F32_POW10_MIN_EXP -31
+#define F32_POW10_MAX_EXP  45
+#define F64_POW10_MIN_EXP -309
+#define F64_POW10_MAX_EXP  341
+#include "pow10_tables.inl"
+
+// floor(log2(10^e))
+static inline s64 floor_log2_pow10(s64 e)
+{
+  return (e * 1741647) >> 19;
+}
+
+
+// floor(log10(2^e))
+static inline s64 floor_log10_pow2(s64 e)
+{
+  return (e * 1262611) >> 22;
+}
+
+
+// floor(log10(3/4 x 2^e))
+static inline s64 floor_log10_three_quarters_pow2(s64 e)
+{
+  return ((e * 1262611) - 524031) >> 22;
+}
+
+
+// Compute g x cp / 2^64 rounded to odd, with g a 64-bit power of 10 from f32_pow10_table and cp a
+// 32-bit value
+static inline u64 round_to_odd_u64(u64 g, u64 cp)
+{
+  u64 product_hi;
+  u64 product_lo = umul128(g, cp, &product_hi);
+
+  return product_hi | ((product_lo >> 32) > 1);
+}
+
+
+// Compute g x cp / 2^128 rounded to odd, with g a 128-bit power of 10 from f64_pow10_table
+static inline u64 round_to_odd_u128(const u64 g[2], u64 cp)
+{
+  u64 lo_product_hi;
+  umul128(g[1], cp, &lo_product_hi);
+
+  u64 product_hi;
+  u64 product_lo = umul128(g[0], cp, &product_hi);
+  product_lo += lo_product_hi;
+  product_hi += product_lo < lo_product_hi;
+
+  return product_hi | (product_lo > 1);
+}
+
+
+// From the value v and its rounding interval bounds, scaled by 4 x 10^-k and rounded to odd, find
+// the decimal with the fewest digits that rounds back to v (or the closest to v if several exist).
+// Its significand is returned and its decimal exponent is written to dec_exp (which holds k)
+static inline u64 select_shortest_dec(u64 vbl, u64 vb, u64 vbr, u64 is_even, s64* dec_exp)
+{
+  // The interval bounds are included when v is even (round half to even)
+  const u64 lower = vbl + !is_even;
+  const u64 upper = vbr - !is_even;
+
+  // Try one digit less first: at most one of s' x 10 and (s' + 1) x 10 is in the interval
+  const u64 s = vb / 4;
+  if (s >= 10)
+  {
+    const u64 sp        = s / 10;
+    const u64 up_inside = lower <= (40 * sp);
+    const u64 wp_inside = ((40 * sp) + 40) <= upper;
+    if (up_inside != wp_inside)
+    {
+      *dec_exp += 1;
+      return sp + wp_inside;
+    }
+  }
+
+  const u64 u_inside = lower <= (4 * s);
+  const u64 w_inside = ((4 * s) + 4) <= upper;
+  if (u_inside != w_inside)
+  {
+    return s + w_inside;
+  }
+
+  // Both s and s + 1 are in the interval, pick the closest one to v (the even one on a tie)
+  const u64 mid      = (4 * s) + 2;
+  const u64 round_up = (vb > mid) || ((vb == mid) && ((s & 1) != 0));
+
+  return s + round_up;
+}
+
+
+// Get the significand of the shortest decimal that rounds back to the non-zero, finite and positive
+// f32 made of exp_bits and frac_bits. Its decimal exponent is written to dec_exp
+static inline u64 f32_shortest_dec(u64 exp_bits, u64 frac_bits, s64* dec_exp)
+{
+  const u64 HIDDEN_BIT = 1ull << 23;
+  const s64 EXP_BIAS   = 127 + 23;
+
+  u64 c;
+  s64 q;
+  if (exp_bits != 0)
+  {
+    c = HIDDEN_BIT | frac_bits;
+    q = (s64)exp_bits - EXP_BIAS;
+
+    // Integers in [1; 2^24] are their own shortest representation
+    if ((q <= 0) && (q > -24) && ((c & ((1ull << -q) - 1)) == 0))
+    {
+      *dec_exp = 0;
+      return c >> -q;
+    }
+  }
+  else
+  {
+    // Subnormal
+    c = frac_bits;
+    q = 1 - EXP_BIAS;
+  }
+
+  // The lower bound of the rounding interval is twice as close to v as the upper bound when v is
+  // a power of 2
+  const u64 lower_is_closer = (frac_bits == 0) && (exp_bits > 1);
+  const u64 cbl             = (4 * c) - 2 + lower_is_closer;
+  const u64 cb              = 4 * c;
+  const u64 cbr             = (4 * c) + 2;
+
+  const s64 k = lower_is_closer ? floor_log10_three_quarters_pow2(q) : floor_log10_pow2(q);
+  const s64 h = q + floor_log2_pow10(-k) + 1;
+  const u64 g = f32_pow10_table[-k - F32_POW10_MIN_EXP];
+
+  const u64 vbl = round_to_odd_u64(g, cbl << h);
+  const u64 vb  = round_to_odd_u64(g, cb  << h);
+  const u64 vbr = round_to_odd_u64(g, cbr << h);
+
+  *dec_exp = k;
+  return select_shortest_dec(vbl, vb, vbr, (c & 1) == 0, dec_exp);
+}
+
+
+// Get the significand of the shortest decimal that rounds back to the non-zero, finite and positive
+// f64 made of exp_bits and frac_bits. Its decimal exponent is written to dec_exp
+static inline u64 f64_shortest_dec(u64 exp_bits, u64 frac_bits, s64* dec_exp)
+{
+  const u64 HIDDEN_BIT = 1ull << 52;
+  const s64 EXP_BIAS   = 1023 + 52;
+
+  u64 c;
+  s64 q;
+  if (exp_bits != 0)
+  {
+    c = HIDDEN_BIT | frac_bits;
+    q = (s64)exp_bits - EXP_BIAS;
+
+    // Integers in [1; 2^53] are their own shortest representation
+    if ((q <= 0) && (q > -53) && ((c & ((1ull << -q) - 1)) == 0))
+    {
+      *dec_exp = 0;
+      return c >> -q;
+    }
+  }
+  else
+  {
+    // Subnormal
+    c = frac_bits;
+    q = 1 - EXP_BIAS;
+  }
+
+  // See f32_shortest_dec()
+  const u64 lower_is_closer = (frac_bits == 0) && (exp_bits > 1);
+  const u64 cbl             = (4 * c) - 2 + lower_is_closer;
+  const u64 cb              = 4 * c;
+  const u64 cbr             = (4 * c) + 2;
+
+  const s64  k = lower_is_closer ? floor_log10_three_quarters_pow2(q) : floor_log10_pow2(q);
+  const s64  h = q + floor_log2_pow10(-k) + 1;
+  const u64* g = f64_pow10_table[-k - F64_POW10_MIN_EXP];
+
+  const u64 vbl = round_to_odd_u128(g, cbl << h);
+  const u64 vb  = round_to_odd_u128(g, cb  << h);
+  const u64 vbr = round_to_odd_u128(g, cbr << h);
+
+  *dec_exp = k;
+  return select_shortest_dec(vbl, vb, vbr, (c & 1) == 0, dec_exp);
+}
+
+
+// Write the decimal exponent of the scientific notation to dest, as 'e', a sign and at least 2
+// digits (e.g. "e+07", "e-308"). Returns the count of characters written
+static inline u64 write_dec_exponent(u8* dest, s64 dec_exp)
+{
+  const u64 is_neg      = dec_exp < 0;
+  const u64 pos_exp     = is_neg ? (u64)-dec_exp : (u64)dec_exp;
+  const u64 digit_count = (pos_exp < 100) ? 2 : 3;
+
+  dest[0] = 'e';
+  dest[1] = is_neg ? '-' : '+';
+  write_dec_u64(dest + 2, pos_exp, digit_count);
+
+  return 2 + digit_count;
+}
+
+
+// Remove the trailing zeros of significand (!= 0), adding their count to dec_exp
+static inline u64 remove_trailing_zeros(u64 significand, s64* dec_exp)
+{
+  while ((significand % 10) == 0)
+  {
+    significand /= 10;
+    *dec_exp    += 1;
+  }
+
+  return significand;
+}
+
+
+// Write significand (digit_count digits, zero-padded on the left) x 10^sci_exp to dest in
+// scientific notation: "d.ddde+xx", or "de+xx" for a single digit. Returns the count of characters
+// written. Up to 17 bytes past the last character may be overwritten
+static inline u64 write_sci_dec(u8* dest, u64 significand, u64 digit_count, s64 sci_exp)
+{
+  // The first digit is moved before the period
+  write_dec_u64(dest + 1, significand, digit_count);
+  dest[0] = dest[1];
+  dest[1] = '.'; // overwritten if unnecessary
+
+  const u64 exponent_idx = digit_count + (digit_count > 1);
+  return exponent_idx + write_dec_exponent(dest + exponent_idx, sci_exp);
+}
+
+
+// Write significand x 10^dec_exp (significand != 0) to dest. Like ECMAScript's Number::toString,
+// values in [10^-6; 10^21[ are written in fixed notation ("0.000123", "123.45", "12300"), others in
+// scientific notation ("1.2345e+21", "1e-07"). Returns the count of characters written. Up to 17
+// bytes past the last character may be overwritten
+static inline u64 write_shortest_dec(u8* dest, u64 significand, s64 dec_exp)
+{
+  significand = remove_trailing_zeros(significand, &dec_exp);
+
+  // Position of the decimal point relative to the first digit
+  const u64 digit_count = u64_digit_count(significand);
+  const s64 point_pos   = (s64)digit_count + dec_exp;
+
+  u64 char_count;
+  if ((point_pos > 21) || (point_pos <= -6))
+  {
+    char_count = write_sci_dec(dest, significand, digit_count, point_pos - 1);
+  }
+  else if (dec_exp >= 0)
+  {
+    // "ddd00"
+    write_dec_u64(dest, significand, digit_count);
+    for (s64 i = 0; i < dec_exp; i += 8)
+    {
+      *(u64*)(dest + digit_count + i) = 0x3030303030303030ull; // "00000000"
+    }
+
+    char_count = (u64)point_pos;
+  }
+  else if (point_pos > 0)
+  {
+    // "ddd.ddd". The fractional digits (at most 16) are moved 1 byte further to insert the period
+    write_dec_u64(dest, significand, digit_count);
+    const __m128i frac_digits = _mm_loadu_si128((const __m128i*)(dest + point_pos));
+    _mm_storeu_si128((__m128i*)(dest + point_pos + 1), frac_digits);
+    dest[point_pos] = '.';
+
+    char_count = digit_count + 1;
+  }
+  else
+  {
+    // "0.000ddd", with up to 5 zeros after the period
+    *(u64*)dest = 0x3030303030302E30ull; // "0.000000"
+    write_dec_u64(dest + 2 - point_pos, significand, digit_count);
+
+    char_count = 2 - point_pos + digit_count;
+  }
+
+  return char_count;
+}
+
+
+// Write "inf", "qnan" or "snan" to dest, preceded by '-' if is_neg is 1. Returns the count of
+// characters written
+static inline u64 write_nan_or_inf(u8* dest, u64 is_neg, u64 is_inf, u64 is_quiet)
+{
+  u8* const str_start = dest;
+  dest[0] = '-'; // overwritten if unnecessary
+  dest += is_neg;
+
+  if (is_inf)
+  {
+    dest[0] = 'i';
+    dest[1] = 'n';
+    dest[2] = 'f';
+    dest += 3;
+  }
+  else
+  {
+    // A nan is a float with all the exponent bits set and at least one fraction bit set.
+    // A quiet nan (qnan) is a nan with the leftmost, highest fraction bit set.
+    // A signaling nan (qnan) is a nan with the leftmost, highest fraction bit clear.
+    // 's' - 'q' is 2, which is a multiple of 2. We can use this to change 's' to a 'q' by
+    // offsetting 's' to 'q' without ifs
+    u8 is_quiet_offset = (u8)(is_quiet << 1);
+
+    dest[0] = 's' - is_quiet_offset;
+    dest[1] = 'n';
+    dest[2] = 'a';
+    dest[3] = 'n';
+    dest += 4;
+  }
+
+  return (u64)(dest - str_start);
+}
+
+
+// 10^e for e in [0; 19]
+static const u64 u64_pow10_table[20] =
+{
+  1ull,
+  10ull,
+  100ull,
+  1000ull,
+  10000ull,
+  100000ull,
+  1000000ull,
+  10000000ull,
+  100000000ull,
+  1000000000ull,
+  10000000000ull,
+  100000000000ull,
+  1000000000000ull,
+  10000000000000ull,
+  100000000000000ull,
+  1000000000000000ull,
+  10000000000000000ull,
+  100000000000000000ull,
+  1000000000000000000ull,
+  10000000000000000000ull
+};
+
+
+// Arbitrary-precision unsigned integers, large enough to hold any f64 multiplied or divided by a
+// power of 10 from f64_pow10_table. They are only used on slow paths: writing integers above 2^64
+// and settling roundings that 128-bit powers of 10 cannot
+#define BIG_UINT_MAX_LIMB_COUNT 40
+
+typedef struct
+{
+  u32 limbs[BIG_UINT_MAX_LIMB_COUNT]; // Least significant first, the most significant is not 0
+  u64 limb_count;
+} big_uint;
+
+
+static inline void big_uint_set_u64(big_uint* num, u64 value)
+{
+  num->limbs[0]   = (u32)value;
+  num->limbs[1]   = (u32)(value >> 32);
+  num->limb_count = ((value >> 32) != 0) ? 2 : (value != 0);
+}
+
+
+static inline void big_uint_mul_u32(big_uint* num, u32 mul)
+{
+  u64 carry = 0;
+  for (u64 i = 0; i < num->limb_count; i++)
+  {
+    const u64 product = ((u64)num->limbs[i] * mul) + carry;
+    num->limbs[i] = (u32)product;
+    carry         = product >> 32;
+  }
+
+  num->limbs[num->limb_count] = (u32)carry;
+  num->limb_count += carry != 0;
+}
+
+
+static inline void big_uint_mul_pow5(big_uint* num, u64 exp)
+{
+  for (; exp >= 13; exp -= 13)
+  {
+    big_uint_mul_u32(num, 1220703125); // 5^13, the largest power of 5 that fits in a u32
+  }
+
+  big_uint_mul_u32(num, (u32)(u64_pow10_table[exp] >> exp));
+}
+
+
+static inline void big_uint_shift_left(big_uint* num, u64 shift)
+{
+  const u64 limb_shift = shift / 32;
+  const u64 bit_shift  = shift % 32;
+  if (num->limb_count == 0)
+  {
+    return;
+  }
+
+  // Each limb is split between 2 destination limbs, starting from the most significant one
+  u64 i = num->limb_count;
+  num->limbs[i + limb_shift] = 0;
+  while (i > 0)
+  {
+    i -= 1;
+    const u64 shifted = (u64)num->limbs[i] << bit_shift;
+    num->limbs[i + limb_shift + 1] |= (u32)(shifted >> 32);
+    num->limbs[i + limb_shift]      = (u32)shifted;
+  }
+
+  for (u64 j = 0; j < limb_shift; j++)
+  {
+    num->limbs[j] = 0;
+  }
+
+  num->limb_count += limb_shift + (num->limbs[num->limb_count + limb_shift] != 0);
+}
+
+
+// Divide num by div and return the remainder
+static inline u32 big_uint_div_u32(big_uint* num, u32 div)
+{
+  u64 remainder = 0;
+  for (u64 i = num->limb_count; i > 0; i--)
+  {
+    const u64 dividend = (remainder << 32) | num->limbs[i - 1];
+    num->limbs[i - 1] = (u32)(dividend / div);
+    remainder         = dividend % div;
+  }
+
+  num->limb_count -= (num->limb_count != 0) && (num->limbs[num->limb_count - 1] == 0);
+  return (u32)remainder;
+}
+
+
+// Returns -1, 0 or 1 if a is respectively lower than, equal to or greater than b
+static inline s64 big_uint_compare(const big_uint* a, const big_uint* b)
+{
+  if (a->limb_count != b->limb_count)
+  {
+    return (a->limb_count > b->limb_count) ? 1 : -1;
+  }
+
+  for (u64 i = a->limb_count; i > 0; i--)
+  {
+    if (a->limbs[i - 1] != b->limbs[i - 1])
+    {
+      return (a->limbs[i - 1] > b->limbs[i - 1]) ? 1 : -1;
+    }
+  }
+
+  return 0;
+}
+
+
+// Exactly compare c x 2^q x 10^-k with n + 1/2. Returns -1, 0 or 1 if it is respectively lower
+// than, equal to or greater than n + 1/2
+static s64 compare_scaled_dec_to_tie(u64 c, s64 q, s64 k, u64 n)
+{
+  // Compare c x 5^-k x 2^(q + 1 - k) with 2n + 1, moving negative exponents to the other side
+  big_uint lhs;
+  big_uint rhs;
+  big_uint_set_u64(&lhs, c);
+  big_uint_set_u64(&rhs, (2 * n) + 1);
+
+  big_uint_mul_pow5((k < 0) ? &lhs : &rhs, (u64)((k < 0) ? -k : k));
+
+  const s64 pow2_exp = q + 1 - k;
+  big_uint_shift_left((pow2_exp > 0) ? &lhs : &rhs, (u64)((pow2_exp > 0) ? pow2_exp : -pow2_exp));
+
+  return big_uint_compare(&lhs, &rhs);
+}
+
+
+// Round c x 2^q x 10^-k to the nearest integer, ties to even, with c x 2^q a finite and positive
+// f32 or f64 (c in [1; 2^53[). The result must be lower than 2^63. This is the digit generation
+// core shared by the fixed-precision and scientific notations: one 192-bit product with a power of
+// 10 from f64_pow10_table decides the rounding, unless the value is too close to a tie to tell
+// from the product's error, which is settled with big_uint arithmetic
+static inline u64 round_scaled_dec(u64 c, s64 q, s64 k)
+{
+  const u64* g = f64_pow10_table[-k - F64_POW10_MIN_EXP];
+
+  // c x g, on 192 bits
+  u64 lo_product_hi;
+  const u64 p0 = umul128(g[1], c, &lo_product_hi);
+  u64 p2;
+  u64 p1 = umul128(g[0], c, &p2);
+  p1 += lo_product_hi;
+  p2 += p1 < lo_product_hi;
+
+  // c x 2^q x 10^-k is c x g / 2^(127 - q - floor(log2(10^-k))). Twice that value is extracted so
+  // that the bit of weight 1/2 is its lowest bit
+  const s64 shift = 126 - q - floor_log2_pow10(-k);
+  if (shift >= 192)
+  {
+    // Lower than 1/2
+    return 0;
+  }
+
+  u64 twice_scaled;
+  u64 middle_bits_are_0; // bits of c x g between 2^64 and the bit of weight 1/2
+  if (shift >= 128)
+  {
+    twice_scaled      = p2 >> (shift - 128);
+    middle_bits_are_0 = (p1 == 0) && ((p2 & ((1ull << (shift - 128)) - 1)) == 0);
+  }
+  else
+  {
+    twice_scaled      = (p1 >> (shift - 64)) | ((p2 << 1) << (127 - shift));
+    middle_bits_are_0 = (p1 & ((1ull << (shift - 64)) - 1)) == 0;
+  }
+
+  // g is greater than the exact power of 10 by at most 1, so c x g is greater than the exact
+  // product by at most c. The value can only be at or below the tie if the 1/2 bit is set and at
+  // most c lies below it
+  const u64 scaled   = twice_scaled >> 1;
+  u64       round_up = twice_scaled & 1;
+  if (round_up && middle_bits_are_0 && (p0 <= c))
+  {
+    const s64 comparison = compare_scaled_dec_to_tie(c, q, k, scaled);
+    round_up = (comparison > 0) || ((comparison == 0) && ((scaled & 1) != 0));
+  }
+
+  return scaled + round_up;
+}
+
+
+// Get c x 2^q (c in [1; 2^53[) correctly rounded to digit_count significant digits (in [1; 17]).
+// The decimal exponent of its last digit is written to dec_exp
+static inline u64 round_to_significant_dec(u64 c, s64 q, u64 digit_count, s64* dec_exp)
+{
+  // floor(log10(c x 2^q)) is either floor(log10(2^msb_exp)) or the next integer. The significand
+  // gets one digit too many in the latter case, or when it is rounded up to 10^digit_count
+  const s64 msb_exp = (s64)get_msb_1_bit_idx_u64(c) + q;
+  s64       k       = floor_log10_pow2(msb_exp) + 1 - (s64)digit_count;
+  u64 significand = round_scaled_dec(c, q, k);
+  if (significand >= u64_pow10_table[digit_count])
+  {
+    k           += 1;
+    significand  = round_scaled_dec(c, q, k);
+  }
+
+  *dec_exp = k;
+  return significand;
+}
+
+
+// Write the integer c x 2^q (greater than 2^64) to dest. Returns the count of digits written
+static u64 write_big_dec_int(u8* dest, u64 c, s64 q)
+{
+  big_uint num;
+  big_uint_set_u64(&num, c);
+  big_uint_shift_left(&num, (u64)q);
+
+  // Split in 9-digit chunks, least significant first. 2^1024 has 309 digits
+  u32 chunks[35];
+  u64 chunk_count = 0;
+  while (num.limb_count != 0)
+  {
+    chunks[chunk_count] = big_uint_div_u32(&num, 1000000000);
+    chunk_count += 1;
+  }
+
+  const u64 lead_digit_count = u32_digit_count(chunks[chunk_count - 1]);
+  write_dec_u64(dest, chunks[chunk_count - 1], lead_digit_count);
+
+  u8* chunk_dest = dest + lead_digit_count;
+  for (u64 i = chunk_count - 1; i > 0; i--)
+  {
+    write_dec_u64(chunk_dest, chunks[i - 1], 9);
+    chunk_dest += 9;
+  }
+
+  return (u64)(chunk_dest - dest);
+}
+
+
+// Write c x 2^q (c in [0; 2^53[, finite and positive) to dest in fixed notation, correctly rounded
+// to frac_digit_count fractional digits (in [0; 17]). Returns the count of characters written
+static inline u64 write_fixed_dec(u8* dest, u64 c, s64 q, u64 frac_digit_count)
+{
+  const u64 frac_pow10 = u64_pow10_table[frac_digit_count];
+  const s64 msb_exp    = (s64)get_msb_1_bit_idx_u64(c) + q;
+
+  u64 int_part;
+  u64 frac_part;
+  u64 int_digit_count = 0;
+  if (c == 0)
+  {
+    int_part  = 0;
+    frac_part = 0;
+  }
+  else if ((msb_exp + 2 + floor_log2_pow10((s64)frac_digit_count)) <= 63)
+  {
+    // c x 2^q x 10^frac_digit_count is lower than 2^63
+    const u64 scaled = round_scaled_dec(c, q, -(s64)frac_digit_count);
+    int_part  = scaled / frac_pow10;
+    frac_part = scaled % frac_pow10;
+  }
+  else if (q < 0)
+  {
+    // Large enough for the integer part to fit in a u64 and the fractional part to be at most 46
+    // bits, which are exactly scaled by 10^frac_digit_count on 128 bits
+    const u64 frac_bit_count = (u64)-q;
+    const u64 frac_bits      = c & ((1ull << frac_bit_count) - 1);
+    int_part = c >> frac_bit_count;
+
+    u64 product_hi;
+    const u64 product_lo = umul128(frac_bits, frac_pow10, &product_hi);
+    frac_part = (product_lo >> frac_bit_count) | (product_hi << (64 - frac_bit_count));
+
+    const u64 rest      = product_lo & ((1ull << frac_bit_count) - 1);
+    const u64 half      = 1ull << (frac_bit_count - 1);
+    const u64 last_part = (frac_digit_count != 0) ? frac_part : int_part;
+    frac_part += (rest > half) || ((rest == half) && ((last_part & 1) != 0));
+
+    // Carry the rounding to the integer part, e.g. 0.999 -> 1.00
+    const u64 carry = frac_part == frac_pow10;
+    int_part  += carry;
+    frac_part  = carry ? 0 : frac_part;
+  }
+  else if ((u64)q <= lzcnt64(c))
+  {
+    int_part  = c << q;
+    frac_part = 0;
+  }
+  else
+  {
+    int_part        = 0;
+    frac_part       = 0;
+    int_digit_count = write_big_dec_int(dest, c, q);
+  }
+
+  if (int_digit_count == 0)
+  {
+    int_digit_count = u64_digit_count(int_part);
+    write_dec_u64(dest, int_part, int_digit_count);
+  }
+
+  u8* const frac_dest = dest + int_digit_count;
+  frac_dest[0] = '.'; // overwritten if unnecessary
+  if (frac_digit_count != 0)
+  {
+    write_dec_u64(frac_dest + 1, frac_part, frac_digit_count);
+  }
+
+  return int_digit_count + (frac_digit_count != 0) + frac_digit_count;
+}
+
+
+// Get the significand c and binary exponent q of the finite f32 made of num_bits, so that its
+// absolute value is c x 2^q
+static inline u64 f32_significand(u32 num_bits, s64* q)
+{
+  const u64 exp_bits  = (num_bits >> 23) & 0xFF;
+  const u64 frac_bits = num_bits & 0x007FFFFF;
+
+  // Subnormals have the same exponent as the smallest normals, without the hidden bit
+  *q = ((exp_bits != 0) ? (s64)exp_bits : 1) - (127 + 23);
+  return ((u64)(exp_bits != 0) << 23) | frac_bits;
+}
+
+
+// Get the significand c and binary exponent q of the finite f64 made of num_bits, so that its
+// absolute value is c x 2^q
+static inline u64 f64_significand(u64 num_bits, s64* q)
+{
+  const u64 exp_bits  = (num_bits >> 52) & 0x7FF;
+  const u64 frac_bits = num_bits & 0x000FFFFFFFFFFFFFull;
+
+  // See f32_significand()
+  *q = ((exp_bits != 0) ? (s64)exp_bits : 1) - (1023 + 52);
+  return ((u64)(exp_bits != 0) << 52) | frac_bits;
+}
+
+
+void log_sized_dec_f32_number(f32 num, u64 frac_digit_to_write_count)
+{
+  DEFER_FORMATTING(DEFERRED_SIZED_DEC_F32_NUMBER, *(u32*)&num, frac_digit_to_write_count);
+
+  reserve_bytes(F32_MAX_SIZED_DEC_STR_SIZE);
+
+  const u32 num_bits = *(u32*)&num;
+  const u64 is_neg   = num_bits >> 31;
+
+  s64 q;
+  const u64 c = f32_significand(num_bits, &q);
+
+  // There can never be more fractional digits than the configured maximum allowed.
+  // F32_DEC_FRAC_MAX_STR_SIZE is defined in logs.h
+  const u64 frac_digit_count = (frac_digit_to_write_count < F32_DEC_FRAC_MAX_STR_SIZE) ?
+                               frac_digit_to_write_count : F32_DEC_FRAC_MAX_STR_SIZE;
+
+  u8* const num_str_start = logs.buffer + logs.buffer_end_idx;
+  num_str_start[0] = '-'; // overwritten if unnecessary
+
+  logs.buffer_end_idx += is_neg + write_fixed_dec(num_str_start + is_neg, c, q, frac_digit_count);
+}
+
+
+void log_sized_dec_f32(f32 num, u64 frac_digit_to_write_count)
+{
+  u64 is_a_number = f32_is_a_number(num);
+  if (is_a_number)
+  {
+    log_sized_dec_f32_number(num, frac_digit_to_write_count);
+  }
+  else
+  {
+    log_dec_f32_nan_or_inf(num);
+  }
+}
+
+
+void log_sized_dec_f64_number(f64 num, u64 frac_digit_to_write_count)
+{
+  DEFER_FORMATTING(DEFERRED_SIZED_DEC_F64_NUMBER, *(u64*)&num, frac_digit_to_write_count);
+
+  reserve_bytes(F64_MAX_SIZED_DEC_STR_SIZE);
+
+  const u64 num_bits = *(u64*)&num;
+  const u64 is_neg   = num_bits >> 63;
+
+  s64 q;
+  const u64 c = f64_significand(num_bits, &q);
+
+  // F64_DEC_FRAC_MAX_STR_SIZE is defined in logs.h
+  const u64 frac_digit_count = (frac_digit_to_write_count < F64_DEC_FRAC_MAX_STR_SIZE) ?
+                               frac_digit_to_write_count : F64_DEC_FRAC_MAX_STR_SIZE;
+
+  u8* const num_str_start = logs.buffer + logs.buffer_end_idx;
+  num_str_start[0] = '-'; // overwritten if unnecessary
+
+  logs.buffer_end_idx += is_neg + write_fixed_dec(num_str_start + is_neg, c, q, frac_digit_count);
+}
+
+
+void log_sized_dec_f64(f64 num, u64 frac_digit_to_write_count)
+{
+  u64 is_a_number = f64_is_a_number(num);
+  if (is_a_number)
+  {
+    log_sized_dec_f64_number(num, frac_digit_to_write_count);
+  }
+  else
+  {
+    log_dec_f64_nan_or_inf(num);
+  }
+}
+
+
+void log_dec_s8 (s8  num) { log_dec_s32(num); }
+void log_dec_s16(s16 num) { log_dec_s32(num); }
+
+
+void log_dec_s32(s32 num)
+{
+  DEFER_FORMATTING(DEFERRED_DEC_S32, (u64)num, 0);
+
+  reserve_bytes(S32_MAX_DEC_STR_SIZE);
+
+  u32 is_neg  = num < 0;
+  u32 pos_num = is_neg ? (0u - (u32)num) : (u32)num;
+
+  u8* const num_str_start        = logs.buffer + logs.buffer_end_idx;
+  u64       digit_to_write_count = u32_digit_count(pos_num);
+  u64       char_to_write_count  = digit_to_write_count + is_neg;
+  
+  *num_str_start = '-'; // will be overwritten if not needed
+  write_dec_u64(num_str_start + is_neg, pos_num, digit_to_write_count);
+  
+  logs.buffer_end_idx += char_to_write_count;
+}
+
+
+void log_dec_s64(s64 num)
+{
+  DEFER_FORMATTING(DEFERRED_DEC_S64, (u64)num, 0);
+
+  reserve_bytes(S64_MAX_DEC_STR_SIZE);
+
+  u64 is_neg  = num < 0ll;
+  u64 pos_num = is_neg ? (0ull - (u64)num) : (u64)num;
+
+  u8* const num_str_start        = logs.buffer + logs.buffer_end_idx;
+  u64       digit_to_write_count = u64_digit_count(pos_num);
+  u64       char_to_write_count  = digit_to_write_count + is_neg;
+  
+  *num_str_start = '-'; // will be overwritten if not needed
+  write_dec_u64(num_str_start + is_neg, pos_num, digit_to_write_count);
+  
+  logs.buffer_end_idx += char_to_write_count;
+}
+
+
+void log_dec_u8 (u8  num) { log_sized_dec_u64(num, u32_digit_count(num)); }
+void log_dec_u16(u16 num) { log_sized_dec_u64(num, u32_digit_count(num)); }
+void log_dec_u32(u32 num) { log_sized_dec_u64(num, u32_digit_count(num)); }
+void log_dec_u64(u64 num) { log_sized_dec_u64(num, u64_digit_count(num)); }
+
+
+void log_dec_f32_nan_or_inf(f32 num)
+{
+  DEFER_FORMATTING(DEFERRED_DEC_F32_NAN_OR_INF, *(u32*)&num, 0);
+
+  reserve_bytes(F32_MAX_DEC_STR_SIZE);
+
+  // num is +infinity, -infinity, qnan, -qnan, snan or -snan
+  const u32 num_bits = *(u32*)&num;
+  const u64 is_neg   = num_bits >> 31;
+  const u64 is_inf   = (num_bits & 0x007FFFFF) == 0;
+  const u64 is_quiet = (num_bits >> 22) & 1;
+
+  u8* const dest = logs.buffer + logs.buffer_end_idx;
+  logs.buffer_end_idx += write_nan_or_inf(dest, is_neg, is_inf, is_quiet);
+}
+
+
+void log_dec_f32_number(f32 num)
+{
+  DEFER_FORMATTING(DEFERRED_DEC_F32_NUMBER, *(u32*)&num, 0);
+
+  reserve_bytes(F32_MAX_DEC_STR_SIZE);
+
+  const u32 num_bits  = *(u32*)&num;
+  const u64 is_neg    = num_bits >> 31;
+  const u64 exp_bits  = (num_bits >> 23) & 0xFF;
+  const u64 frac_bits = num_bits & 0x007FFFFF;
+
+  u8* const num_str_start = logs.buffer + logs.buffer_end_idx;
+  u8* const dest          = num_str_start + is_neg;
+  num_str_start[0] = '-'; // overwritten if unnecessary
+
+  u64 char_count;
+  if ((exp_bits | frac_bits) == 0)
+  {
+    dest[0]    = '0';
+    char_count = 1;
+  }
+  else
+  {
+    s64 dec_exp;
+    const u64 significand = f32_shortest_dec(exp_bits, frac_bits, &dec_exp);
+    char_count = write_shortest_dec(dest, significand, dec_exp);
+  }
+
+  logs.buffer_end_idx += is_neg + char_count;
+}
+
+
+void log_dec_f32(f32 num)
+{
+  u64 is_a_number = f32_is_a_number(num);
+  if (is_a_number)
+  {
+    log_dec_f32_number(num);
+  }
+  else
+  {
+    log_dec_f32_nan_or_inf(num);
+  }
+}
+
+
+void log_dec_f64_nan_or_inf(f64 num)
+{
+  DEFER_FORMATTING(DEFERRED_DEC_F64_NAN_OR_INF, *(u64*)&num, 0);
+
+  reserve_bytes(F64_MAX_DEC_STR_SIZE);
+
+  // num is +infinity, -infinity, qnan, -qnan, snan or -snan
+  const u64 num_bits = *(u64*)&num;
+  const u64 is_neg   = num_bits >> 63;
+  const u64 is_inf   = (num_bits & 0x000FFFFFFFFFFFFFull) == 0;
+  const u64 is_quiet = (num_bits >> 51) & 1;
+
+  u8* const dest = logs.buffer + logs.buffer_end_idx;
+  logs.buffer_end_idx += write_nan_or_inf(dest, is_neg, is_inf, is_quiet);
+}
+
+
+void log_dec_f64_number(f64 num)
+{
+  DEFER_FORMATTING(DEFERRED_DEC_F64_NUMBER, *(u64*)&num, 0);
+
+  reserve_bytes(F64_MAX_DEC_STR_SIZE);
+
+  const u64 num_bits  = *(u64*)&num;
+  const u64 is_neg    = num_bits >> 63;
+  const u64 exp_bits  = (num_bits >> 52) & 0x7FF;
+  const u64 frac_bits = num_bits & 0x000FFFFFFFFFFFFFull;
+
+  u8* const num_str_start = logs.buffer + logs.buffer_end_idx;
+  u8* const dest          = num_str_start + is_neg;
+  num_str_start[0] = '-'; // overwritten if unnecessary
+
+  u64 char_count;
+  if ((exp_bits | frac_bits) == 0)
+  {
+    dest[0]    = '0';
+    char_count = 1;
+  }
+  else
+  {
+    s64 dec_exp;
+    const u64 significand = f64_shortest_dec(exp_bits, frac_bits, &dec_exp);
+    char_count = write_shortest_dec(dest, significand, dec_exp);
+  }
+
+  logs.buffer_end_idx += is_neg + char_count;
+}
+
+
+void log_dec_f64(f64 num)
+{
+  u64 is_a_number = f64_is_a_number(num);
+  if (is_a_number)
+  {
+    log_dec_f64_number(num);
+  }
+  else
+  {
+    log_dec_f64_nan_or_inf(num);
+  }
+}
+
+
+// Scientific
+void log_sized_sci_f32_number(f32 num, u64 digit_to_write_count)
+{
+  DEFER_FORMATTING(DEFERRED_SIZED_SCI_F32_NUMBER, *(u32*)&num, digit_to_write_count);
+
+  reserve_bytes(F32_MAX_SCI_STR_SIZE);
+
+  const u32 num_bits = *(u32*)&num;
+  const u64 is_neg   = num_bits >> 31;
+
+  // F32_MAX_DEC_SIGNIFICANT_DIGITS is defined in logs.h
+  const u64 digit_count = (digit_to_write_count == 0) ? 1 :
+                          (digit_to_write_count < F32_MAX_DEC_SIGNIFICANT_DIGITS) ?
+                          digit_to_write_count : F32_MAX_DEC_SIGNIFICANT_DIGITS;
+
+  s64 q;
+  const u64 c           = f32_significand(num_bits, &q);
+  s64       dec_exp     = 0;
+  const u64 significand = (c != 0) ? round_to_significant_dec(c, q, digit_count, &dec_exp) : 0;
+
+  u8* const num_str_start = logs.buffer + logs.buffer_end_idx;
+  u8* const dest          = num_str_start + is_neg;
+  num_str_start[0] = '-'; // overwritten if unnecessary
+
+  const s64 sci_exp = (c != 0) ? (dec_exp + (s64)digit_count - 1) : 0;
+  logs.buffer_end_idx += is_neg + write_sci_dec(dest, significand, digit_count, sci_exp);
+}
+
+
+void log_sized_sci_f32(f32 num, u64 digit_to_write_count)
+{
+  u64 is_a_number = f32_is_a_number(num);
+  if (is_a_number)
+  {
+    log_sized_sci_f32_number(num, digit_to_write_count);
+  }
+  else
+  {
+    log_dec_f32_nan_or_inf(num);
+  }
+}
+
+
+void log_sized_sci_f64_number(f64 num, u64 digit_to_write_count)
+{
+  DEFER_FORMATTING(DEFERRED_SIZED_SCI_F64_NUMBER, *(u64*)&num, digit_to_write_count);
+
+  reserve_bytes(F64_MAX_SCI_STR_SIZE);
+
+  const u64 num_bits = *(u64*)&num;
+  const u64 is_neg   = num_bits >> 63;
+
+  // F64_MAX_DEC_SIGNIFICANT_DIGITS is defined in logs.h
+  const u64 digit_count = (digit_to_write_count == 0) ? 1 :
+                          (digit_to_write_count < F64_MAX_DEC_SIGNIFICANT_DIGITS) ?
+                          digit_to_write_count : F64_MAX_DEC_SIGNIFICANT_DIGITS;
+
+  s64 q;
+  const u64 c           = f64_significand(num_bits, &q);
+  s64       dec_exp     = 0;
+  const u64 significand = (c != 0) ? round_to_significant_dec(c, q, digit_count, &dec_exp) : 0;
+
+  u8* const num_str_start = logs.buffer + logs.buffer_end_idx;
+  u8* const dest          = num_str_start + is_neg;
+  num_str_start[0] = '-'; // overwritten if unnecessary
+
+  const s64 sci_exp = (c != 0) ? (dec_exp + (s64)digit_count - 1) : 0;
+  logs.buffer_end_idx += is_neg + write_sci_dec(dest, significand, digit_count, sci_exp);
+}
+
+
+void log_sized_sci_f64(f64 num, u64 digit_to_write_count)
+{
+  u64 is_a_number = f64_is_a_number(num);
+  if (is_a_number)
+  {
+    log_sized_sci_f64_number(num, digit_to_write_count);
+  }
+  else
+  {
+    log_dec_f64_nan_or_inf(num);
+  }
+}
+
+
+void log_sci_f32_number(f32 num)
+{
+  DEFER_FORMATTING(DEFERRED_SCI_F32_NUMBER, *(u32*)&num, 0);
+
+  reserve_bytes(F32_MAX_SCI_STR_SIZE);
+
+  const u32 num_bits  = *(u32*)&num;
+  const u64 is_neg    = num_bits >> 31;
+  const u64 exp_bits  = (num_bits >> 23) & 0xFF;
+  const u64 frac_bits = num_bits & 0x007FFFFF;
+
+  u64 significand = 0;
+  s64 dec_exp     = 0;
+  if ((exp_bits | frac_bits) != 0)
+  {
+    significand = f32_shortest_dec(exp_bits, frac_bits, &dec_exp);
+    significand = remove_trailing_zeros(significand, &dec_exp);
+  }
+
+  u8* const num_str_start = logs.buffer + logs.buffer_end_idx;
+  u8* const dest          = num_str_start + is_neg;
+  num_str_start[0] = '-'; // overwritten if unnecessary
+
+  const u64 digit_count = u64_digit_count(significand);
+  const s64 sci_exp     = dec_exp + (s64)digit_count - 1;
+  logs.buffer_end_idx += is_neg + write_sci_dec(dest, significand, digit_count, sci_exp);
+}
+
+
+void log_sci_f32(f32 num)
+{
+  u64 is_a_number = f32_is_a_number(num);
+  if (is_a_number)
+  {
+    log_sci_f32_number(num);
+  }
+  else
+  {
+    log_dec_f32_nan_or_inf(num);
+  }
+}
+
+
+void log_sci_f64_number(f64 num)
+{
+  DEFER_FORMATTING(DEFERRED_SCI_F64_NUMBER, *(u64*)&num, 0);
+
+  reserve_bytes(F64_MAX_SCI_STR_SIZE);
+
+  const u64 num_bits  = *(u64*)&num;
+  const u64 is_neg    = num_bits >> 63;
+  const u64 exp_bits  = (num_bits >> 52) & 0x7FF;
+  const u64 frac_bits = num_bits & 0x000FFFFFFFFFFFFFull;
+
+  u64 significand = 0;
+  s64 dec_exp     = 0;
+  if ((exp_bits | frac_bits) != 0)
+  {
+    significand = f64_shortest_dec(exp_bits, frac_bits, &dec_exp);
+    significand = remove_trailing_zeros(significand, &dec_exp);
+  }
+
+  u8* const num_str_start = logs.buffer + logs.buffer_end_idx;
+  u8* const dest          = num_str_start + is_neg;
+  num_str_start[0] = '-'; // overwritten if unnecessary
+
+  const u64 digit_count = u64_digit_count(significand);
+  const s64 sci_exp     = dec_exp + (s64)digit_count - 1;
+  logs.buffer_end_idx += is_neg + write_sci_dec(dest, significand, digit_count, sci_exp);
+}
+
+
+void log_sci_f64(f64 num)
+{
+  u64 is_a_number = f64_is_a_number(num);
+  if (is_a_number)
+  {
+    log_sci_f64_number(num);
+  }
+  else
+  {
+    log_dec_f64_nan_or_inf(num);
+  }
+}
+
+
+// Hexadecimal
+static const char hex_digits[]       = "0123456789ABCDEF";
+static const char hex_digits_lower[] = "0123456789abcdef";
+
+// Write the nibble_count (>= 1) least significant nibbles of num to dest, left-padded with '0'.
+// digits is either hex_digits or hex_digits_lower. Up to 15 bytes past the last nibble may be
+// overwritten
+static inline void write_hex_u64(u8* dest, u64 num, u64 nibble_count, const char* digits)
+{
+  // u64 values have at most 16 nibbles, anything requested beyond can only be a '0'
+  while (nibble_count > 16)
+  {
+    *dest = '0';
+    dest         += 1;
+    nibble_count -= 1;
+  }
+
+  // Move the nibbles to write to the most significant end of num. All 16 nibbles are converted,
+  // the unwanted ones end up past the last written character
+  num <<= (16 - nibble_count) * 4;
+
+  // Split each byte into its 2 nibbles, interleaved from the least to the most significant one,
+  // then use them as indices into the 16-character digits table
+  const __m128i nibble_mask = _mm_set1_epi8(0x0F);
+  const __m128i bytes       = _mm_cvtsi64_si128((s64)num);
+  const __m128i lo_nibbles  = _mm_and_si128(bytes, nibble_mask);
+  const __m128i hi_nibbles  = _mm_and_si128(_mm_srli_epi16(bytes, 4), nibble_mask);
+  const __m128i nibbles     = _mm_unpacklo_epi8(lo_nibbles, hi_nibbles);
+  const __m128i digits_lut  = _mm_loadu_si128((const __m128i*)digits);
+  const __m128i chars       = _mm_shuffle_epi8(digits_lut, nibbles);
+
+  // Reverse the characters so that the most significant nibble is written first
+  const __m128i reverse = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+  _mm_storeu_si128((__m128i*)dest, _mm_shuffle_epi8(chars, reverse));
+}
+
+
+void log_sized_hex_s8 (s8  num, u64 nibble_to_write_count) { log_sized_hex_u64((u64)num, nibble_to_write_count); }
+void log_sized_hex_s16(s16 num, u64 nibble_to_write_count) { log_sized_hex_u64((u64)num, nibble_to_write_count); }
+void log_sized_hex_s32(s32 num, u64 nibble_to_write_count) { log_sized_hex_u64((u64)num, nibble_to_write_count); }
+void log_sized_hex_s64(s64 num, u64 nibble_to_write_count) { log_sized_hex_u64((u64)num, nibble_to_write_count); }
+void log_sized_hex_u8 (u8  num, u64 nibble_to_write_count) { log_sized_hex_u64(num,      nibble_to_write_count); }
+void log_sized_hex_u16(u16 num, u64 nibble_to_write_count) { log_sized_hex_u64(num,      nibble_to_write_count); }
+void log_sized_hex_u32(u32 num, u64 nibble_to_write_count) { log_sized_hex_u64(num,      nibble_to_write_count); }
+
+
+void log_sized_hex_u64(u64 num, u64 nibble_to_write_count)
+{
+  DEFER_FORMATTING(DEFERRED_SIZED_HEX_U64, num, nibble_to_write_count);
+
+  if (nibble_to_write_count > U64_MAX_HEX_STR_SIZE)
+  {
+    log_zero_padding(nibble_to_write_count - U64_MAX_HEX_STR_SIZE);
+    nibble_to_write_count = U64_MAX_HEX_STR_SIZE;
+  }
+
+  reserve_bytes(U64_MAX_HEX_STR_SIZE);
+
+  if (nibble_to_write_count != 0)
+  {
+    u8* const dest = logs.buffer + logs.buffer_end_idx;
+    write_hex_u64(dest, num, nibble_to_write_count, hex_digits);
+
+    logs.buffer_end_idx += nibble_to_write_count;
+  }
+}
+
+
+void log_sized_hex_f32(f32 num, u64 nibble_to_write_count) { log_sized_hex_u64(*(u32*)&num, nibble_to_write_count); }
+
+
+void log_hex_s8 (s8  num) { log_sized_hex_u64((u64)num,    u32_nibble_count((u32)num));    }
+void log_hex_s16(s16 num) { log_sized_hex_u64((u64)num,    u32_nibble_count((u32)num));    }
+void log_hex_s32(s32 num) { log_sized_hex_u64((u64)num,    u32_nibble_count((u32)num));    }
+void log_hex_s64(s64 num) { log_sized_hex_u64((u64)num,    u64_nibble_count((u64)num));    }
+void log_hex_u8 (u8  num) { log_sized_hex_u64(num,         u32_nibble_count(num));         }
+void log_hex_u16(u16 num) { log_sized_hex_u64(num,         u32_nibble_count(num));         }
+void log_hex_u32(u32 num) { log_sized_hex_u64(num,         u32_nibble_count(num));         }
+void log_hex_u64(u64 num) { log_sized_hex_u64(num,         u64_nibble_count(num));         }
+void log_hex_f32(f32 num) { log_sized_hex_u64(*(u32*)&num, u32_nibble_count(*(u32*)&num)); }
+
+
+// Lowercase hexadecimal
+void log_sized_hex_lower_s8 (s8  num, u64 nibble_to_write_count) { log_sized_hex_lower_u64((u64)num, nibble_to_write_count); }
+void log_sized_hex_lower_s16(s16 num, u64 nibble_to_write_count) { log_sized_hex_lower_u64((u64)num, nibble_to_write_count); }
+void log_sized_hex_lower_s32(s32 num, u64 nibble_to_write_count) { log_sized_hex_lower_u64((u64)num, nibble_to_write_count); }
+void log_sized_hex_lower_s64(s64 num, u64 nibble_to_write_count) { log_sized_hex_lower_u64((u64)num, nibble_to_write_count); }
+void log_sized_hex_lower_u8 (u8  num, u64 nibble_to_write_count) { log_sized_hex_lower_u64(num,      nibble_to_write_count); }
+void log_sized_hex_lower_u16(u16 num, u64 nibble_to_write_count) { log_sized_hex_lower_u64(num,      nibble_to_write_count); }
+void log_sized_hex_lower_u32(u32 num, u64 nibble_to_write_count) { log_sized_hex_lower_u64(num,      nibble_to_write_count); }
+
+
+void log_sized_hex_lower_u64(u64 num, u64 nibble_to_write_count)
+{
+  DEFER_FORMATTING(DEFERRED_SIZED_HEX_LOWER_U64, num, nibble_to_write_count);
+
+  if (nibble_to_write_count > U64_MAX_HEX_STR_SIZE)
+  {
+    log_zero_padding(nibble_to_write_count - U64_MAX_HEX_STR_SIZE);
+    nibble_to_write_count = U64_MAX_HEX_STR_SIZE;
+  }
+
+  reserve_bytes(U64_MAX_HEX_STR_SIZE);
+
+  if (nibble_to_write_count != 0)
+  {
+    u8* const dest = logs.buffer + logs.buffer_end_idx;
+    write_hex_u64(dest, num, nibble_to_write_count, hex_digits_lower);
+
+    logs.buffer_end_idx += nibble_to_write_count;
+  }
+}
+
+
+void log_sized_hex_lower_f32(f32 num, u64 nibble_to_write_count) { log_sized_hex_lower_u64(*(u32*)&num, nibble_to_write_count); }
+
+
+void log_hex_lower_s8 (s8  num) { log_sized_hex_lower_u64((u64)num,    u32_nibble_count((u32)num));    }
+void log_hex_lower_s16(s16 num) { log_sized_hex_lower_u64((u64)num,    u32_nibble_count((u32)num));    }
+void log_hex_lower_s32(s32 num) { log_sized_hex_lower_u64((u64)num,    u32_nibble_count((u32)num));    }
+void log_hex_lower_s64(s64 num) { log_sized_hex_lower_u64((u64)num,    u64_nibble_count((u64)num));    }
+void log_hex_lower_u8 (u8  num) { log_sized_hex_lower_u64(num,         u32_nibble_count(num));         }
+void log_hex_lower_u16(u16 num) { log_sized_hex_lower_u64(num,         u32_nibble_count(num));         }
+void log_hex_lower_u32(u32 num) { log_sized_hex_lower_u64(num,         u32_nibble_count(num));         }
+void log_hex_lower_u64(u64 num) { log_sized_hex_lower_u64(num,         u64_nibble_count(num));         }
+void log_hex_lower_f32(f32 num) { log_sized_hex_lower_u64(*(u32*)&num, u32_nibble_count(*(u32*)&num)); }
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//// Utilities
+u64 lzcnt32(u32 num)
+{
+#if defined(_MSC_VER)
+  return __lzcnt(num);
+#elif defined(__clang__) || defined(__GNUC__)
+  return __builtin_ia32_lzcnt_u32(num);
+#endif
+}
+
+
+u64 lzcnt64(u64 num)
+{
+#if defined(_MSC_VER)
+  return __lzcnt64(num);
+#elif defined(__clang__) || defined(__GNUC__)
+  return __builtin_ia32_lzcnt_u64(num);
+#endif
+}
+
+
+u64 tzcnt32(u32 num)
+{
+#if defined(_MSC_VER)
+  return _tzcnt_u32(num);
+#elif defined(__clang__) || defined(__GNUC__)
+  return (u64)__builtin_ctz(num);
+#endif
+}
+
+
+u32 pdep32(u32 a, u32 mask)
+{
+#if defined(_MSC_VER)
+  return _pdep_u32(a, mask);
+#elif defined(__clang__) || defined(__GNUC__)
+  return __builtin_ia32_pdep_si(a, mask);
+#endif
+}
+
+
+u64 pdep64(u64 a, u64 mask)
+{
+#if defined(_MSC_VER)
+  return _pdep_u64(a, mask);
+#elif defined(__clang__) || defined(__GNUC__)
+  return __builtin_ia32_pdep_di(a, mask);
+#endif
+}
+
+
+u32 bswap32(u32 a)
+{
+#if defined(_MSC_VER)
+  // Should generate a bswap instruction
+  return (a              << 24) |
+         (a              >> 24) |
+         ((a & 0xFF00)   << 8) |
+         ((a & 0xFF0000) >> 8);
+#elif defined(__clang__) || defined(__GNUC__)
+  return __builtin_bswap32(a);
+#endif
+}
+
+
+u64 bswap64(u64 a)
+{
+#if defined(_MSC_VER)
+  return _byteswap_uint64(a);
+#elif defined(__clang__) || defined(__GNUC__)
+  return __builtin_bswap64(a);
+#endif
+}
+
+
+u64 umul128(u64 a, u64 b, u64* hi)
+{
+#if defined(_MSC_VER)
+  return _umul128(a, b, hi);
+#elif defined(__clang__) || defined(__GNUC__)
+  __extension__ typedef unsigned __int128 u128;
+  u128 product = (u128)a * b;
+  *hi = (u64)(product >> 64);
+  return (u64)product;
+#endif
+}
+
+
+u64 get_msb_1_bit_idx_u32(u32 num)
+{
+  return 31 ^ lzcnt32(num | 1);
+}
+
+
+u64 get_msb_1_bit_idx_u64(u64 num)
+{
+  return 63 ^ lzcnt64(num | 1);
+}
+
+
+// Numerals count in a number
+u64 u32_digit_count(u32 num)
+{
+  // Similar to https://commaok.xyz/post/lookup_tables/, but:
+  // - lzcnt replaces bsr
+  // - table is reversed
+  // - an extra entry is added for num = 0, so this function returns 1
+  // - the bitwise OR and substraction performed by int_log2() no longer happen
+  static const u64 offsets[33] =
+  {
+    42949672960ull, 42949672960ull,                                 // (10 << 32)
+    41949672960ull, 41949672960ull, 41949672960ull,                 // (10 << 32) - 1000000000
+    38554705664ull, 38554705664ull, 38554705664ull,                 // (9  << 32) - 100000000
+    34349738368ull, 34349738368ull, 34349738368ull, 34349738368ull, // (8  << 32) - 10000000
+    30063771072ull, 30063771072ull, 30063771072ull,                 // (7  << 32) - 1000000
+    25769703776ull, 25769703776ull, 25769703776ull,                 // (6  << 32) - 100000
+    21474826480ull, 21474826480ull, 21474826480ull, 21474826480ull, // (5  << 32) - 10000
+    17179868184ull, 17179868184ull, 17179868184ull,                 // (4  << 32) - 1000
+    12884901788ull, 12884901788ull, 12884901788ull,                 // (3  << 32) - 100
+    8589934582ull,  8589934582ull,  8589934582ull,                  // (2  << 32) - 10
+    4294967296ull,                                                  // (1  << 32)
+    4294967296ull                                                   // (1  << 32)
+  };
+
+  u64 lzcnt       = lzcnt32(num);
+  u64 offset      = offsets[lzcnt];
+  u64 digit_count = (num + offset) >> 32;
+
+  return digit_count;
+}
+
+
+u64 u64_digit_count(u64 num)
+{
+  // https://lemire.me/blog/2025/01/07/counting-the-digits-of-64-bit-integers/
+  static u64 thresholds[19] =
+  {
+    9ull,
+    99ull,
+    999ull,
+    9999ull,
+    99999ull,
+    999999ull,
+    9999999ull,
+    99999999ull,
+    999999999ull,
+    9999999999ull,
+    99999999999ull,
+    999999999999ull,
+    9999999999999ull,
+    99999999999999ull,
+    999999999999999ull,
+    9999999999999999ull,
+    99999999999999999ull,
+    999999999999999999ull,
+    9999999999999999999ull
+  };
+  u64 msb_idx       = get_msb_1_bit_idx_u64(num);
+  u64 threshold_idx = (19 * msb_idx) >> 6;
+  u64 threshold     = thresholds[threshold_idx];
+  u64 is_greater    = num > threshold;
+  u64 digit_count   = threshold_idx + is_greater + 1;
+
+  return digit_count;
+}
+
+
+u64 u32_bit_count(u32 num)
+{
+  return get_msb_1_bit_idx_u32(num) + 1;
+}
+
+
+u64 u64_bit_count(u64 num)
+{
+  return get_msb_1_bit_idx_u64(num) + 1;
+}
+
+
+u64 u32_nibble_count(u32 num)
+{
+  u64 msb_idx      = get_msb_1_bit_idx_u32(num);
+  u64 nibble_count = 1 + (msb_idx >> 2);
+
+  return nibble_count;
+}
+
+
+u64 u64_nibble_count(u64 num)
+{
+  u64 msb_idx      = get_msb_1_bit_idx_u64(num);
+  u64 nibble_count = 1 + (msb_idx >> 2);
+  
+  return nibble_count;
+}
+
+
+u64 f32_is_a_number(f32 num)
+{
+  const u32 EXPONENT_ALL_ONE = 0x7F800000;
+  
+  u32 num_bits = *(u32*)&num;
+  
+  return (num_bits & EXPONENT_ALL_ONE) != EXPONENT_ALL_ONE;
+}
+
+
+u64 f64_is_a_number(f64 num)
+{
+  const u64 EXPONENT_ALL_ONE = 0x7FF0000000000000ull;
+
+  u64 num_bits = *(u64*)&num;
+
+  return (num_bits & EXPONENT_ALL_ONE) != EXPONENT_ALL_ONE;
+}
+
+
+u64 utf16_code_point_to_unicode(const u16* utf16, u32* unicode)
+{
+  const u16 range = 0xDFFF - 0xD800;
+  u16 offset = utf16[0] - 0xD800;
+  if (offset > range)
+  {
+    *unicode = utf16[0];
+    return 1;
+  }
+  else
+  {
+    u32 hi = (utf16[0] & 0x3FF) << 10;
+    u32 lo = utf16[1] & 0x3FF;
+    
+    *unicode = (hi | lo) + 0x10000;
+    return 2;
+  }
+}
+
+
+static const u8 lzcnt_to_utf8_byte_count[33] =
+{
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  4, 4, 4, 4, 4,
+  3, 3, 3, 3, 3,
+  2, 2, 2, 2,
+  1, 1, 1, 1, 1, 1, 1,
+  0
+};
+
+static const u32 high_order_bits[] =
+{
+  0x0,
+  0x0,
+  0x80C0, // 0b1000000011000000
+  0x8080E0, // 0b100000001000000011100000
+  0x808080F0, // 0b10000000100000001000000011110000
+};
+
+static const u32 pdep_mask[] =
+{
+  0x0,
+  0xFF000000, // 0b11111111000000000000000000000000
+  0x1F3F0000, // 0b00011111001111110000000000000000
+  0x0F3F3F00, // 0b00001111001111110011111100000000
+  0x073F3F3F  // 0b00000111001111110011111100111111
+};
+
+u64 unicode_to_utf8_code_point(u32 unicode, u8* utf8)
+{
+  // lzcnt | byte_count | Unicode
+  // ------|------------|---------------------------
+  // 31-25 | 1          | 0wwwwwww
+  // 24-21 | 2          | 00000xxx xxwwwwww
+  // 20-16 | 3          | yyyyxxxx xxwwwwww
+  // 15-11 | 4          | 000zzzyy yyyyxxxx xxwwwwww
+  // 10- 0 | 0          | Invalid unicode
+  u64 lzcnt      = lzcnt32(unicode);
+  u64 byte_count = lzcnt_to_utf8_byte_count[lzcnt];
+
+  // byte_count |              deposited              |         bswap32(deposited)
+  // -----------|-------------------------------------|------------------------------------
+  // 1          | wwwwwwww 00000000 00000000 00000000 | 00000000 00000000 00000000 wwwwwwww
+  // 2          | 000xxxxx 00wwwwww 00000000 00000000 | 00000000 00000000 00wwwwww 000xxxxx
+  // 3          | 0000yyyy 00xxxxxx 00wwwwww 00000000 | 00000000 00wwwwww 00xxxxxx 0000yyyy
+  // 4          | 00000zzz 00yyyyyy 00xxxxxx 00wwwwww | 00wwwwww 00xxxxxx 00yyyyyy 00000zzz
+  u32 deposited = pdep32(unicode, pdep_mask[byte_count]);
+  u32 bswapped  = bswap32(deposited);
+
+  // byte_count |         bswap32(deposited)          |               encoded
+  // -----------|-------------------------------------|------------------------------------
+  // 1          | 00000000 00000000 00000000 wwwwwwww | 00000000 00000000 00000000 wwwwwwww
+  // 2          | 00000000 00000000 00wwwwww 000xxxxx | 00000000 00000000 10wwwwww 110xxxxx
+  // 3          | 00000000 00wwwwww 00xxxxxx 0000yyyy | 00000000 10wwwwww 10xxxxxx 1110yyyy
+  // 4          | 00wwwwww 00xxxxxx 00yyyyyy 00000zzz | 10wwwwww 10xxxxxx 10yyyyyy 11110zzz
+  u32 high_bits = high_order_bits[byte_count];
+  u32 encoded   = high_bits | bswapped;
+
+  *(u32*)utf8 = encoded;
+
+  return byte_count;
+}
+
+#elif defined(_MSC_VER)
+#  pragma warning(disable: 4206) // Disable "empty translation unit" warning
+#endif // defined(LOGS_ENABLED) && (LOGS_ENABLED != 0)
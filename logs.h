@@ -9,10 +9,12 @@
 // - logs_buffer_remaining_bytes()
 // - logs_flush()
 //
-// None of the functions below check whether enough space is available in the buffer before
-// appending content to it. It is advised to tweak LOGS_BUFFER_SIZE to a value that's appropriate
-// to your use-case (typically to the size of your biggest "chunk" of logs), either through compiler
-// flags (-DLOGS_BUFFER_SIZE=<your size>) or by changing its default size (see below).
+// By default, none of the functions below check whether enough space is available in the buffer
+// before appending content to it. It is advised to tweak LOGS_BUFFER_SIZE to a value that's
+// appropriate to your use-case (typically to the size of your biggest "chunk" of logs), either
+// through compiler flags (-DLOGS_BUFFER_SIZE=<your size>) or by changing its default size (see
+// below). Alternatively, the buffer can be flushed automatically when it fills up by defining
+// LOGS_AUTO_FLUSH (see below).
 //
 // Functions with a name starting with "logs_" (e.g. logs_open_console_output()) manage the general
 // logging context. Function with a name starting with "log_" (e.g. log_dec_u32()) format and append
@@ -23,6 +25,10 @@
 #include "detect_compilation_os.h"
 #include "types.h"
 
+#if defined(_MSC_VER)
+#  include <intrin.h>
+#endif
+
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -31,6 +37,298 @@
 #  define LOGS_BUFFER_SIZE 4096
 #endif
 
+// Formatting functions store whole words at once and may write up to this many bytes past the
+// content they append. These extra bytes are reserved after the buffer so that such stores never
+// leave it, and are never flushed
+#define LOGS_BUFFER_PADDING 64
+
+// Opt-in bounds-checked mode, enabled by defining LOGS_AUTO_FLUSH to a non-zero value
+// (-DLOGS_AUTO_FLUSH=1). Every function appending to the buffer first reserves the maximum size of
+// what it may append (see the *_MAX_*_STR_SIZE constants below), and flushes the buffer to the open
+// outputs if that size would take it past LOGS_AUTO_FLUSH_WATERMARK. Strings that don't fit are
+// appended and flushed in chunks. This lets a small buffer be used safely, at the cost of one
+// compare per call. When disabled, no check is compiled at all
+#if defined(LOGS_AUTO_FLUSH) && (LOGS_AUTO_FLUSH != 0)
+#  if !defined(LOGS_AUTO_FLUSH_WATERMARK)
+#    define LOGS_AUTO_FLUSH_WATERMARK LOGS_BUFFER_SIZE
+#  endif
+#endif
+
+// Opt-in asynchronous flushes on Linux, enabled by defining LOGS_ASYNC_FLUSH to a non-zero value
+// (-DLOGS_ASYNC_FLUSH=1). logs.buffer then points to one of LOGS_ASYNC_FLUSH_BUFFER_COUNT buffers
+// (2 for double buffering, 3 for triple buffering). A flush hands the full buffer over to a writer
+// thread and switches logs.buffer to a free one, which only costs a wakeup if the writer thread is
+// asleep. When no buffer is free, the flush waits for the writer thread to release one: for as long
+// as it takes if LOGS_ASYNC_FLUSH_MAX_WAIT_NS is 0 (default), or up to that many nanoseconds after
+// which the logs to flush are dropped and counted in logs.dropped_byte_count.
+// The writer thread sleeps until a flush wakes it up. If LOGS_ASYNC_FLUSH_WRITER_POLL_NS isn't 0,
+// it instead checks for flushed buffers every that many nanoseconds, and flushes never pay for the
+// wakeup syscall. Processes must be exited with the exit_group syscall (231) to end the writer
+// thread as well
+#if defined(LOGS_OS_LINUX) && defined(LOGS_ASYNC_FLUSH) && (LOGS_ASYNC_FLUSH != 0)
+#  if !defined(LOGS_ASYNC_FLUSH_BUFFER_COUNT)
+#    define LOGS_ASYNC_FLUSH_BUFFER_COUNT 2
+#  endif
+#  if !defined(LOGS_ASYNC_FLUSH_MAX_WAIT_NS)
+#    define LOGS_ASYNC_FLUSH_MAX_WAIT_NS 0
+#  endif
+#  if !defined(LOGS_ASYNC_FLUSH_WRITER_POLL_NS)
+#    define LOGS_ASYNC_FLUSH_WRITER_POLL_NS 0
+#  endif
+#  if defined(LOGS_IO_URING) && (LOGS_IO_URING != 0)
+#    error "LOGS_ASYNC_FLUSH and LOGS_IO_URING are exclusive"
+#  endif
+#endif
+
+// Opt-in per-thread buffers on Linux, enabled by defining LOGS_PER_THREAD to a non-zero value
+// (-DLOGS_PER_THREAD=1). Each thread logs to its own struct logs, which it registers with
+// logs_attach_thread() before calling any other function. "logs" then names the calling thread's
+// struct, found through the %gs segment base (x86_64 libcs only use %fs for thread-local storage),
+// so threads log without sharing anything but the output handles. Outputs are opened and closed
+// while no other thread logs.
+// Flushes only write the complete lines at the start of the buffer, with one write syscall per
+// output, and keep the last, incomplete line for the next flush. Lines of different threads thus
+// never interleave in files (opened with O_APPEND) nor in pipes and terminals, as long as a flush
+// doesn't exceed PIPE_BUF (4096 bytes) for the latter. Only incomplete lines longer than half the
+// buffer are flushed as is, as are those which LOGS_AUTO_FLUSH has no room left for.
+// A thread that logs before calling logs_attach_thread() reads %gs:0 with a null segment base and
+// crashes. Defining LOGS_PER_THREAD_CHECKS to a non-zero value checks the segment base on each use
+// of "logs" instead (one arch_prctl syscall), and exits with a message on stderr if it is null.
+// This is meant for debug builds only
+#if defined(LOGS_OS_LINUX) && defined(LOGS_PER_THREAD) && (LOGS_PER_THREAD != 0)
+#  if (defined(LOGS_ASYNC_FLUSH) && (LOGS_ASYNC_FLUSH != 0)) || \
+      (defined(LOGS_IO_URING) && (LOGS_IO_URING != 0))
+#    error "LOGS_PER_THREAD is exclusive with LOGS_ASYNC_FLUSH and LOGS_IO_URING"
+#  endif
+#endif
+
+// Opt-in lock-free ring shared by all threads, on top of LOGS_PER_THREAD, enabled by defining
+// LOGS_SHARED_RING to a non-zero value (-DLOGS_SHARED_RING=1). The ring holds LOGS_BUFFER_SIZE
+// bytes of records:
+// - logs_reserve() claims a record of up to a given size with a single atomic compare-and-swap
+//   (fetch-add if LOGS_SHARED_RING_OVERWRITE isn't 0). The log_* functions called by the thread
+//   then format straight into it, and logs_commit() publishes it. Logs appended outside of a
+//   reserved record are discarded
+// - Each log_* function checks that the maximum size of what it appends (see the *_MAX_*_STR_SIZE
+//   constants below) fits in the record. Strings are cut to the room left. The first append that
+//   doesn't fit ends the record, and the appends after it are discarded until logs_commit()
+// - logs_flush() and logs_flush_to() write the committed records in order, up to the first one
+//   which isn't committed yet, with one writev syscall per output for up to 64 records. Any thread
+//   may flush: batches of records are claimed under a lock, and written in order outside of it
+// - When a record doesn't fit, it is dropped without waiting for flushes (default), or if
+//   LOGS_SHARED_RING_OVERWRITE isn't 0, the oldest committed records are discarded to make room
+//   for it. The size of the logs lost either way is counted by logs_ring_dropped_byte_count()
+// A record holds at most LOGS_SHARED_RING_MAX_RECORD_SIZE bytes (1 KiB by default)
+#if defined(LOGS_OS_LINUX) && defined(LOGS_SHARED_RING) && (LOGS_SHARED_RING != 0)
+#  if !defined(LOGS_PER_THREAD) || (LOGS_PER_THREAD == 0)
+#    error "LOGS_SHARED_RING requires LOGS_PER_THREAD"
+#  endif
+#  if defined(LOGS_AUTO_FLUSH) && (LOGS_AUTO_FLUSH != 0)
+#    error "LOGS_SHARED_RING and LOGS_AUTO_FLUSH are exclusive, records are sized by logs_reserve()"
+#  endif
+#  if !defined(LOGS_SHARED_RING_MAX_RECORD_SIZE)
+#    define LOGS_SHARED_RING_MAX_RECORD_SIZE 1024
+#  endif
+#  if !defined(LOGS_SHARED_RING_OVERWRITE)
+#    define LOGS_SHARED_RING_OVERWRITE 0
+#  endif
+#endif
+
+// Opt-in per-CPU rings, on top of LOGS_SHARED_RING, enabled by defining LOGS_PER_CPU to a non-zero
+// value (-DLOGS_PER_CPU=1). Each CPU gets its own ring of LOGS_BUFFER_SIZE bytes, and
+// logs_reserve() claims records in the ring of the CPU it runs on inside a restartable sequence
+// (rseq), without atomic instructions: the kernel restarts the sequence if the thread is preempted,
+// migrated or signaled before it completes. Flushes collect the committed records of all rings.
+// With LOGS_PER_CPU_TIMESTAMPS set to a non-zero value, records embed the time-stamp counter read
+// when they are reserved, and each flush merges them in that order (the time-stamp counters of
+// all CPUs must be synchronized). The merge only orders the records committed when it reaches them:
+// a ring leaves it at its first record which isn't committed yet, e.g. because its thread was
+// preempted before logs_commit(), and the later records of the other rings are written before
+// that one. Otherwise, each flush writes the records of one ring after the other, so the records
+// of a thread which migrated between CPUs may be written out of order. The rings take about
+// (LOGS_PER_CPU_MAX_CPU_COUNT + 1) * (LOGS_BUFFER_SIZE + LOGS_SHARED_RING_MAX_RECORD_SIZE) bytes
+// of static storage (4.3 MB with 64 KiB buffers): lower LOGS_PER_CPU_MAX_CPU_COUNT to the CPU
+// count of the target machines.
+// logs_attach_thread() registers the thread's rseq area, which is part of its struct logs. Threads
+// which can't register it (e.g. because the C library already did, as glibc 2.35 and above do
+// unless GLIBC_TUNABLES=glibc.pthread.rseq=0 is set), and threads running on CPUs past
+// LOGS_PER_CPU_MAX_CPU_COUNT (64 by default), reserve records in an extra ring shared with atomic
+// fetch-adds, as in LOGS_SHARED_RING mode
+#if defined(LOGS_OS_LINUX) && defined(LOGS_PER_CPU) && (LOGS_PER_CPU != 0)
+#  if !defined(LOGS_SHARED_RING) || (LOGS_SHARED_RING == 0)
+#    error "LOGS_PER_CPU requires LOGS_SHARED_RING"
+#  endif
+#  if !defined(LOGS_PER_CPU_MAX_CPU_COUNT)
+#    define LOGS_PER_CPU_MAX_CPU_COUNT 64
+#  endif
+#  if !defined(LOGS_PER_CPU_TIMESTAMPS)
+#    define LOGS_PER_CPU_TIMESTAMPS 0
+#  endif
+#endif
+
+// Opt-in binary logs on Linux, enabled by defining LOGS_BINARY to a non-zero value
+// (-DLOGS_BINARY=1). log_binary(format, args...) appends the index of its call site followed by the
+// raw bits of its arguments instead of formatted text: varint-encoded integers (zigzag-encoded if
+// signed), f32 and f64 bits as is, and length-prefixed strings. The format and argument types of
+// every call site are stored at compile time in the logs_binary_sites section, and written as a
+// dictionary before the first logs flushed to each output since it was opened. logs_decode
+// (build.sh decode) turns such a stream back into the text the log_* functions would have written.
+// Placeholders in formats are replaced by the arguments, in order:
+// - {}   decimal (log_dec_*), or the string
+// - {x}  lowercase hexadecimal (log_hex_lower_*), {X} uppercase hexadecimal (log_hex_*)
+// - {b}  binary (log_bin_*)
+// - {e}  scientific notation (log_sci_*)
+// - {.N} decimal with N fractional digits (log_sized_dec_f32/f64)
+// - {{   a single '{'
+// log_binary() takes up to LOGS_BINARY_MAX_ARG_COUNT arguments. Text appended by other log_*
+// functions isn't decodable, and mustn't be mixed with binary logs
+#if defined(LOGS_OS_LINUX) && defined(LOGS_BINARY) && (LOGS_BINARY != 0)
+#  if defined(LOGS_PER_THREAD) && (LOGS_PER_THREAD != 0)
+#    error "LOGS_BINARY and LOGS_PER_THREAD are exclusive, the latter flushes complete lines only"
+#  endif
+#endif
+
+// Opt-in memory-mapped file output on Linux, enabled by defining LOGS_MMAP_FILE to a non-zero value
+// (-DLOGS_MMAP_FILE=1). Flushes copy logs to a shared mapping of the file output instead of calling
+// write, and only make syscalls to grow the file by LOGS_MMAP_FILE_EXTENT_SIZE bytes (16 MiB by
+// default, a multiple of 4096) with fallocate, or ftruncate where it isn't supported, and to map the
+// next window. logs_close_file_output() truncates the file to the size of its logs: until then,
+// and if the process ends without closing it, the file ends with zeros up to the end of the extent.
+// The file output is written with write syscalls if it can't be mapped
+#if defined(LOGS_OS_LINUX) && defined(LOGS_MMAP_FILE) && (LOGS_MMAP_FILE != 0)
+#  if !defined(LOGS_MMAP_FILE_EXTENT_SIZE)
+#    define LOGS_MMAP_FILE_EXTENT_SIZE (16 * 1024 * 1024)
+#  endif
+
+#  if (defined(LOGS_PER_THREAD) && (LOGS_PER_THREAD != 0)) || \
+      (defined(LOGS_IO_URING) && (LOGS_IO_URING != 0))
+#    error "LOGS_MMAP_FILE is exclusive with LOGS_PER_THREAD and LOGS_IO_URING"
+#  endif
+#endif
+
+// Opt-in file output rotation on Linux, enabled by defining LOGS_FILE_ROTATION to a non-zero value
+// (-DLOGS_FILE_ROTATION=1). Before a flush to the file output, once the file holds
+// LOGS_FILE_ROTATION_SIZE bytes (64 MiB by default), or got LOGS_FILE_ROTATION_FLUSH_COUNT flushes
+// (0, the default, doesn't count flushes), it is renamed to <path>.1 and logs continue in a new
+// <path>. Up to LOGS_FILE_ROTATION_FILE_COUNT rotated files are kept (4 by default), <path>.1 being
+// the most recent, and older ones are overwritten. The next file is opened under <path>.next and
+// its LOGS_FILE_ROTATION_SIZE bytes preallocated with fallocate beforehand, so that a rotation only
+// renames files and swaps the new one in place of the file output's descriptor, without the file
+// system allocating extents as logs are written. With LOGS_ASYNC_FLUSH, the writer thread rotates
+// files. Paths of the file output are at most LOGS_FILE_ROTATION_MAX_PATH_SIZE bytes long (4096 by
+// default, null terminator included), or the file isn't rotated
+#if defined(LOGS_OS_LINUX) && defined(LOGS_FILE_ROTATION) && (LOGS_FILE_ROTATION != 0)
+#  if !defined(LOGS_FILE_ROTATION_SIZE)
+#    define LOGS_FILE_ROTATION_SIZE (64 * 1024 * 1024)
+#  endif
+#  if !defined(LOGS_FILE_ROTATION_FLUSH_COUNT)
+#    define LOGS_FILE_ROTATION_FLUSH_COUNT 0
+#  endif
+#  if !defined(LOGS_FILE_ROTATION_FILE_COUNT)
+#    define LOGS_FILE_ROTATION_FILE_COUNT 4
+#  endif
+#  if !defined(LOGS_FILE_ROTATION_MAX_PATH_SIZE)
+#    define LOGS_FILE_ROTATION_MAX_PATH_SIZE 4096
+#  endif
+
+#  if (defined(LOGS_PER_THREAD) && (LOGS_PER_THREAD != 0)) || \
+      (defined(LOGS_IO_URING) && (LOGS_IO_URING != 0))     || \
+      (defined(LOGS_MMAP_FILE) && (LOGS_MMAP_FILE != 0))
+#    error "LOGS_FILE_ROTATION is exclusive with LOGS_PER_THREAD, LOGS_IO_URING and LOGS_MMAP_FILE"
+#  endif
+#  if defined(LOGS_ASYNC_FLUSH) && (LOGS_ASYNC_FLUSH != 0) && defined(LOGS_BINARY) && (LOGS_BINARY != 0)
+#    error "LOGS_FILE_ROTATION can't rotate binary logs flushed by LOGS_ASYNC_FLUSH"
+#  endif
+#endif
+
+// Opt-in zero-copy strings on Linux, enabled by defining LOGS_ZERO_COPY to a non-zero value
+// (-DLOGS_ZERO_COPY=1). log_sized_utf8_str_ref() records a reference to strings of at least
+// LOGS_ZERO_COPY_MIN_SIZE bytes (defaults to 4096) instead of copying them, and flushes write the
+// buffered logs and the referenced strings in order with a single writev syscall per output. Up to
+// LOGS_ZERO_COPY_MAX_REF_COUNT strings (defaults to 64) are referenced between flushes, the buffer
+// being flushed first when one more is. Large payloads (request bodies, packet dumps) then don't
+// pass through the cache nor need a large LOGS_BUFFER_SIZE
+#if defined(LOGS_OS_LINUX) && defined(LOGS_ZERO_COPY) && (LOGS_ZERO_COPY != 0)
+#  if !defined(LOGS_ZERO_COPY_MIN_SIZE)
+#    define LOGS_ZERO_COPY_MIN_SIZE 4096
+#  endif
+#  if !defined(LOGS_ZERO_COPY_MAX_REF_COUNT)
+#    define LOGS_ZERO_COPY_MAX_REF_COUNT 64
+#  endif
+#  if ((2 * LOGS_ZERO_COPY_MAX_REF_COUNT) + 1) > 1024
+#    error "LOGS_ZERO_COPY_MAX_REF_COUNT is at most 511: writev takes up to IOV_MAX (1024) buffers"
+#  endif
+
+#  if defined(LOGS_PER_THREAD) && (LOGS_PER_THREAD != 0)
+#    error "LOGS_ZERO_COPY and LOGS_PER_THREAD are exclusive"
+#  endif
+#  if defined(LOGS_ASYNC_FLUSH) && (LOGS_ASYNC_FLUSH != 0)
+#    error "LOGS_ZERO_COPY and LOGS_ASYNC_FLUSH are exclusive, strings are referenced until flushes return"
+#  endif
+#  if defined(LOGS_DEFERRED_FORMATTING) && (LOGS_DEFERRED_FORMATTING != 0)
+#    error "LOGS_ZERO_COPY and LOGS_DEFERRED_FORMATTING are exclusive"
+#  endif
+#endif
+
+// Opt-in deferred formatting, enabled by defining LOGS_DEFERRED_FORMATTING to a non-zero value
+// (-DLOGS_DEFERRED_FORMATTING=1). Functions formatting numbers append a record of
+// LOGS_DEFERRED_RECORD_SIZE bytes instead (a 0xFF marker, the formatting function, the size it was
+// passed and the raw bits of the number), while characters and strings are still appended as is.
+// Flushes format the records into the logs buffer, writing it as many times as needed, and skip
+// formatting entirely if the outputs they write to are all closed. A record may be larger than the
+// number it stands for (e.g. a single digit), which the logs buffer size must account for.
+// Characters and strings must be valid UTF-8, which never holds a 0xFF byte
+#if defined(LOGS_DEFERRED_FORMATTING) && (LOGS_DEFERRED_FORMATTING != 0)
+#  define LOGS_DEFERRED_RECORD_SIZE 18
+
+#  if defined(LOGS_PER_THREAD) && (LOGS_PER_THREAD != 0)
+#    error "LOGS_DEFERRED_FORMATTING and LOGS_PER_THREAD are exclusive"
+#  endif
+#  if defined(LOGS_BINARY) && (LOGS_BINARY != 0)
+#    error "LOGS_DEFERRED_FORMATTING and LOGS_BINARY are exclusive, the latter never formats"
+#  endif
+#endif
+
+// Severity levels of logs_at_level() statements. Statements of a level below LOGS_MIN_LEVEL
+// (LOGS_LEVEL_TRACE by default) compile to nothing, e.g. -DLOGS_MIN_LEVEL=2 strips trace and debug
+// logs out of a build. The others are filtered at run time by logs_set_level(). LOGS_LEVEL_OFF is
+// only a minimum level, which filters out every statement
+#define LOGS_LEVEL_TRACE 0
+#define LOGS_LEVEL_DEBUG 1
+#define LOGS_LEVEL_INFO  2
+#define LOGS_LEVEL_WARN  3
+#define LOGS_LEVEL_ERROR 4
+#define LOGS_LEVEL_FATAL 5
+#define LOGS_LEVEL_COUNT 6
+#define LOGS_LEVEL_OFF   LOGS_LEVEL_COUNT
+
+#if !defined(LOGS_MIN_LEVEL)
+#  define LOGS_MIN_LEVEL LOGS_LEVEL_TRACE
+#endif
+
+// Opt-in per-output levels, enabled by defining LOGS_OUTPUT_LEVELS to a non-zero value
+// (-DLOGS_OUTPUT_LEVELS=1). logs_set_output_level() sets the minimum level of each output (e.g.
+// warnings to the console, everything to the file), and logs are formatted once in the buffer
+// whatever outputs they go to. A logs_at_level() statement going to other outputs than the previous
+// one starts a new segment of the buffer, and flushes write to each output only the segments going
+// to it, with a single writev syscall per output on Linux. Up to
+// LOGS_OUTPUT_LEVELS_MAX_SEGMENT_COUNT segments (defaults to 64) are started between flushes, the
+// buffer being flushed first when one more is. Logs appended outside of statements go to the same
+// outputs as the statement before them
+#if defined(LOGS_OUTPUT_LEVELS) && (LOGS_OUTPUT_LEVELS != 0)
+#  if !defined(LOGS_OUTPUT_LEVELS_MAX_SEGMENT_COUNT)
+#    define LOGS_OUTPUT_LEVELS_MAX_SEGMENT_COUNT 64
+#  endif
+
+#  if (defined(LOGS_PER_THREAD) && (LOGS_PER_THREAD != 0))                   || \
+      (defined(LOGS_ASYNC_FLUSH) && (LOGS_ASYNC_FLUSH != 0))                 || \
+      (defined(LOGS_IO_URING) && (LOGS_IO_URING != 0))                       || \
+      (defined(LOGS_ZERO_COPY) && (LOGS_ZERO_COPY != 0))                     || \
+      (defined(LOGS_DEFERRED_FORMATTING) && (LOGS_DEFERRED_FORMATTING != 0))
+#    error "LOGS_OUTPUT_LEVELS is exclusive with LOGS_PER_THREAD, LOGS_ASYNC_FLUSH, LOGS_IO_URING, LOGS_ZERO_COPY and LOGS_DEFERRED_FORMATTING"
+#  endif
+#endif
+
 // Index of available outputs in logs.outputs
 enum logs_output_idx
 {
@@ -41,17 +339,226 @@ enum logs_output_idx
 };
 typedef enum logs_output_idx logs_output_idx;
 
+#if defined(LOGS_OS_LINUX) && defined(LOGS_IO_URING) && (LOGS_IO_URING != 0)
+// How logs_flush() and logs_flush_to() write to outputs on Linux, when the io_uring backend is
+// compiled in (-DLOGS_IO_URING=1):
+// - LOGS_FLUSH_WRITE: one blocking write syscall per open output
+// - LOGS_FLUSH_IO_URING (default): writes to all open outputs are submitted with a single
+//   io_uring_enter syscall, which returns once they complete
+// - LOGS_FLUSH_IO_URING_ASYNC: same, except the buffer is copied and the flush returns right after
+//   submitting. Completions are reaped by the next flush, logs_wait_for_flush(), or when an output
+//   is closed
+// If io_uring is unavailable (kernels older than 5.6, or io_uring disabled), flushes fall back to
+// write syscalls
+enum logs_flush_mode
+{
+  LOGS_FLUSH_WRITE          = 0,
+  LOGS_FLUSH_IO_URING       = 1,
+  LOGS_FLUSH_IO_URING_ASYNC = 2
+};
+typedef enum logs_flush_mode logs_flush_mode;
+#endif
+
+#if defined(LOGS_OS_LINUX) && defined(LOGS_PER_CPU) && (LOGS_PER_CPU != 0)
+// Restartable sequences area registered with the kernel (struct rseq in linux/rseq.h), which keeps
+// cpu_id up to date and restarts the sequence described by rseq_cs when it is interrupted
+struct logs_rseq
+{
+  u32 cpu_id_start;
+  u32 cpu_id;
+  u64 rseq_cs;
+  u32 flags;
+  u32 reserved[3];
+};
+#endif
+
+#if defined(LOGS_OS_LINUX)
+// Types of log_binary() arguments, as stored in the dictionary of binary logs
+enum logs_binary_type
+{
+  LOGS_BINARY_U8  = 0,
+  LOGS_BINARY_U16 = 1,
+  LOGS_BINARY_U32 = 2,
+  LOGS_BINARY_U64 = 3,
+  LOGS_BINARY_S8  = 4,
+  LOGS_BINARY_S16 = 5,
+  LOGS_BINARY_S32 = 6,
+  LOGS_BINARY_S64 = 7,
+  LOGS_BINARY_F32 = 8,
+  LOGS_BINARY_F64 = 9,
+  LOGS_BINARY_STR = 10,
+
+  LOGS_BINARY_TYPE_COUNT
+};
+typedef enum logs_binary_type logs_binary_type;
+
+#  define LOGS_BINARY_MAX_ARG_COUNT 8
+
+// A binary logs stream is a sequence of records, each starting with a varint tag: the index of a
+// call site plus 1, followed by its arguments, or 0, followed by LOGS_BINARY_MAGIC and a
+// dictionary which replaces the previous one:
+// - the varint count of call sites
+// - for each call site: its u8 count of arguments, their u8 types, the varint size of its format
+//   and the format itself
+#  define LOGS_BINARY_MAGIC      "LOGSBIN1"
+#  define LOGS_BINARY_MAGIC_SIZE 8
+
+// Call site of log_binary(), stored in the logs_binary_sites section. Its size is a power of 2 so
+// that sites are laid out without padding, and can be indexed
+struct logs_binary_site
+{
+  _Alignas(32) const char* format;
+  u8 arg_count;
+  u8 arg_types[LOGS_BINARY_MAX_ARG_COUNT];
+};
+#endif
+
+// State of a rate-limited or sampled call site, allocated statically by logs_rate_limited() and
+// logs_sampled()
+struct logs_site
+{
+  // Rate limits: TSC value from which the next message is logged. Sampling: count of messages
+  // skipped before the next one is logged
+  u64 next;
+
+  // Rate limits: TSC ticks between 2 messages at the sustained rate, and the ticks the burst lets
+  // messages through ahead of it. Computed when the first message is logged
+  u64 interval_ticks;
+  u64 burst_ticks;
+
+  // Rate limits: count of messages suppressed since the last one logged
+  u64 suppressed_count;
+
+  const char* file;
+  u64         line;
+};
+
+// Line prefixes are templates built once with logs_prefix_append_*() (e.g. ANSI colour, timestamp,
+// level tag, thread id), then stamped at the start of lines with log_prefix(). Their static bytes
+// are stored with room left for their fields, which log_prefix() copies with 16-byte stores before
+// formatting the fields in place. Each prefix holds 2 variants of its bytes, with and without its
+// ANSI escape sequences, whose sizes are at most LOGS_PREFIX_MAX_SIZE bytes
+#define LOGS_PREFIX_MAX_SIZE        64
+#define LOGS_PREFIX_MAX_FIELD_COUNT 6
+
+// Fields of line prefixes, formatted from the values passed to log_prefix():
+// - LOGS_PREFIX_DEC:         the digit_count least significant decimal digits of a u64, left-padded
+//                            with '0' (1 to 20 digits)
+// - LOGS_PREFIX_TIME_OF_DAY: "HH:MM:SS" of a timestamp in nanoseconds since the Unix epoch, then
+//                            digit_count fractional digits after a '.' (0, 3, 6 or 9, up to 9)
+// - LOGS_PREFIX_ISO8601:     "YYYY-MM-DDTHH:MM:SS" of a timestamp in nanoseconds since the Unix
+//                            epoch, then digit_count fractional digits after a '.' (if any) and 'Z'
+enum logs_prefix_field_type
+{
+  LOGS_PREFIX_DEC         = 0,
+  LOGS_PREFIX_TIME_OF_DAY = 1,
+  LOGS_PREFIX_ISO8601     = 2
+};
+typedef enum logs_prefix_field_type logs_prefix_field_type;
+
+struct logs_prefix_field
+{
+  u8 type;
+  u8 digit_count;
+  u8 offsets[2]; // in the bytes of both variants
+};
+
+// Zero-initialize before appending to it
+struct logs_prefix
+{
+  // Without ([0]) and with ([1]) ANSI escape sequences. The 16 extra bytes are never stamped, and
+  // keep the 16-byte stores of log_prefix() and the restoring of fields' trailing bytes in bounds
+  _Alignas(16) u8 bytes[2][LOGS_PREFIX_MAX_SIZE + 16];
+  u8 sizes[2];
+  u8 field_count;
+  struct logs_prefix_field fields[LOGS_PREFIX_MAX_FIELD_COUNT];
+};
+typedef struct logs_prefix logs_prefix;
+
+// ANSI escape sequences (Select Graphic Rendition) to append to line prefixes with
+// logs_prefix_append_ansi_str()
+#define LOGS_ANSI_RESET   "\x1B[0m"
+#define LOGS_ANSI_BOLD    "\x1B[1m"
+#define LOGS_ANSI_DIM     "\x1B[2m"
+#define LOGS_ANSI_RED     "\x1B[31m"
+#define LOGS_ANSI_GREEN   "\x1B[32m"
+#define LOGS_ANSI_YELLOW  "\x1B[33m"
+#define LOGS_ANSI_BLUE    "\x1B[34m"
+#define LOGS_ANSI_MAGENTA "\x1B[35m"
+#define LOGS_ANSI_CYAN    "\x1B[36m"
+#define LOGS_ANSI_GRAY    "\x1B[90m"
+
+// "YYYY-MM-DDTHH:MM:SS" of the last second logged by log_time_of_day(), log_iso8601_*() or
+// log_prefix(), whose date is only formatted again when its day changes
+struct logs_timestamp_cache
+{
+  u64 second;
+  u64 day;
+  u8  date_time[19];
+};
+
 struct logs
 {
+#if defined(LOGS_OS_LINUX) && defined(LOGS_PER_THREAD) && (LOGS_PER_THREAD != 0)
+  // Address of this struct, read from %gs:0 to find the calling thread's struct
+  struct logs* self;
+#endif
+
+#if defined(LOGS_OS_LINUX) && defined(LOGS_ASYNC_FLUSH) && (LOGS_ASYNC_FLUSH != 0)
+  // Characters storage, encoded as UTF-8. Swapped with a free buffer by every flush
+  u8* buffer;
+
+  // Count of bytes dropped by flushes that waited LOGS_ASYNC_FLUSH_MAX_WAIT_NS for a free buffer
+  u64 dropped_byte_count;
+#elif defined(LOGS_OS_LINUX) && defined(LOGS_SHARED_RING) && (LOGS_SHARED_RING != 0)
+  // Characters storage, encoded as UTF-8: the reserved record in the ring, or discarded_logs
+  u8* buffer;
+
+  // Position in the ring of the reserved record, and its maximum size (0 if none is reserved)
+  u64 record_position;
+  u64 record_max_size;
+
+  // Logs of the reserved record (0 if it was dropped), and their size once an append didn't fit in
+  // it (~0 until then)
+  u8* record_logs;
+  u64 record_size;
+#else
   // Characters storage, encoded as UTF-8
-  u8 buffer[LOGS_BUFFER_SIZE];
+  u8 buffer[LOGS_BUFFER_SIZE + LOGS_BUFFER_PADDING];
+#endif
 
+#if defined(LOGS_OS_LINUX) && defined(LOGS_PER_THREAD) && (LOGS_PER_THREAD != 0)
+  // Output handles, shared by all threads
+  u32* outputs;
+#else
   // Output handles
   u32 outputs[LOGS_OUTPUT_COUNT];
+#endif
 
   // Index past the last character written to the buffer
   u64 buffer_end_idx;
 
+#if defined(LOGS_OUTPUT_LEVELS) && (LOGS_OUTPUT_LEVELS != 0)
+  // Outputs the logs appended since the last segment of the buffer go to, as a mask of bits
+  // (1 << output_idx)
+  u32 routed_output_mask;
+#endif
+
+  // Timestamp formatted last, kept with each thread's logs with LOGS_PER_THREAD as it is written
+  // by every timestamp logged
+  struct logs_timestamp_cache timestamp_cache;
+
+#if defined(LOGS_OS_LINUX) && defined(LOGS_SHARED_RING) && (LOGS_SHARED_RING != 0)
+  // Where logs appended outside of a reserved record, or to a dropped one, are formatted then
+  // discarded
+  u8 discarded_logs[LOGS_SHARED_RING_MAX_RECORD_SIZE + LOGS_BUFFER_PADDING];
+#endif
+
+#if defined(LOGS_OS_LINUX) && defined(LOGS_PER_CPU) && (LOGS_PER_CPU != 0)
+  // Registered by logs_attach_thread(). The kernel requires it to be 32-byte aligned
+  _Alignas(32) struct logs_rseq rseq;
+#endif
+
 #if defined(LOGS_OS_WINDOWS)
   // If the console used to output logs is borrowed, restore its original output code page
   // when logs_close_console_output() is called. This is only used on Windows, whose terminal has
@@ -62,7 +569,36 @@ struct logs
 
 
 #if defined(LOGS_ENABLED) && (LOGS_ENABLED != 0) 
+#  if defined(LOGS_OS_LINUX) && defined(LOGS_PER_THREAD) && (LOGS_PER_THREAD != 0)
+// "struct logs" can't be spelled once logs names the calling thread's struct
+typedef struct logs logs_thread;
+
+// Make the calling thread log to thread_logs, which must remain valid for as long as the thread
+// logs. Its buffer starts empty. In LOGS_PER_CPU mode, a thread attaches once, as its rseq area
+// stays registered until it exits
+void logs_attach_thread(logs_thread* thread_logs);
+
+// The calling thread's struct logs. The load is volatile so that it is never hoisted above
+// logs_attach_thread()
+#    if defined(LOGS_PER_THREAD_CHECKS) && (LOGS_PER_THREAD_CHECKS != 0)
+void logs_check_thread_attached(void);
+#    endif
+
+static inline logs_thread* logs_current_thread(void)
+{
+#    if defined(LOGS_PER_THREAD_CHECKS) && (LOGS_PER_THREAD_CHECKS != 0)
+  logs_check_thread_attached();
+#    endif
+
+  logs_thread* thread_logs;
+  __asm__ __volatile__ ("movq %%gs:0, %0" : "=r"(thread_logs));
+  return thread_logs;
+}
+
+#    define logs (*logs_current_thread())
+#  else
 extern struct logs logs;
+#  endif
 
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -74,6 +610,14 @@ void logs_open_console_output(void);
 // Close the log console output, where logs will no longer be written
 void logs_close_console_output(void);
 
+// Make log_prefix() stamp line prefixes with their ANSI escape sequences (e.g. colours), or without
+// them. They are disabled by default. On Windows, enabling them also turns on the virtual terminal
+// processing of the open console (Windows 10 and above), which interprets them. Buffered logs are
+// written to every open output: enable them while only the console is open, or flush lines with
+// prefixes to the console only
+void logs_enable_console_ansi_escape_sequence(void);
+void logs_disable_console_ansi_escape_sequence(void);
+
 // Open a file to append the logs to. file_path is an ASCII-encoded relative or absolute path (as in
 // between "" quotes) that must be null-terminated. If the file exists, logs will be appended to the
 // end of the file. If the file doesn't already exist, it is created
@@ -107,6 +651,31 @@ void logs_flush_to(logs_output_idx output_idx);
 // Write the content of the log buffer to all open outputs and set the log buffer end index to 0
 void logs_flush(void);
 
+#if defined(LOGS_OS_LINUX) && defined(LOGS_IO_URING) && (LOGS_IO_URING != 0)
+// Select how the next flushes write to outputs (see logs_flush_mode above). Pending asynchronous
+// writes are completed first
+void logs_set_flush_mode(logs_flush_mode flush_mode);
+#endif
+
+#if defined(LOGS_OS_LINUX) && defined(LOGS_SHARED_RING) && (LOGS_SHARED_RING != 0)
+// Reserve a record of up to max_byte_count bytes (capped to LOGS_SHARED_RING_MAX_RECORD_SIZE) in
+// the shared ring, which the next log_* calls of this thread append to
+void logs_reserve(u64 max_byte_count);
+
+// Publish the record reserved by this thread, which flushes may then write
+void logs_commit(void);
+
+// Count of bytes of logs dropped because the ring was full
+u64 logs_ring_dropped_byte_count(void);
+#endif
+
+#if defined(LOGS_OS_LINUX) && ((defined(LOGS_IO_URING) && (LOGS_IO_URING != 0)) || \
+                               (defined(LOGS_ASYNC_FLUSH) && (LOGS_ASYNC_FLUSH != 0)))
+// Wait for the writes of asynchronous flushes to complete. Call it before exiting the process
+// without closing outputs
+void logs_wait_for_flush(void);
+#endif
+
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -115,6 +684,157 @@ void logs_flush(void);
 u64 logs_buffer_remaining_bytes(void);
 
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//// Log levels
+// Bit ((level * LOGS_OUTPUT_COUNT) + output_idx) is set if statements of that level go to that
+// output. All levels go to all outputs by default
+extern u32 logs_level_mask;
+
+// Filter out the statements of a level below min_level (LOGS_LEVEL_OFF filters out all of them)
+void logs_set_level(u32 min_level);
+
+#if defined(LOGS_OUTPUT_LEVELS) && (LOGS_OUTPUT_LEVELS != 0)
+// Stop writing the statements of a level below min_level to an output
+void logs_set_output_level(logs_output_idx output_idx, u32 min_level);
+
+// Start a segment of the buffer going to the outputs of output_mask. Called by logs_at_level()
+void logs_route_to_outputs(u32 output_mask);
+#endif
+
+// Whether statements of a level go to any output. In LOGS_OUTPUT_LEVELS mode, the logs appended
+// next are routed to the outputs it goes to
+static inline u32 logs_level_is_enabled(u32 level)
+{
+  const u32 output_mask = (logs_level_mask >> (level * LOGS_OUTPUT_COUNT)) &
+                          ((1u << LOGS_OUTPUT_COUNT) - 1);
+#if defined(LOGS_OUTPUT_LEVELS) && (LOGS_OUTPUT_LEVELS != 0)
+  if ((output_mask != 0) && (output_mask != logs.routed_output_mask))
+  {
+    logs_route_to_outputs(output_mask);
+  }
+#endif
+  return output_mask != 0;
+}
+
+// Run the statement (or block) that follows if its level isn't filtered out, e.g.
+//   logs_at_level(LOGS_LEVEL_WARN)
+//   {
+//     log_literal_str("disk almost full: ");
+//     log_dec_u64(free_byte_count);
+//     log_character('\n');
+//   }
+// The level is checked once for all the log_* calls of the statement, with a load and a
+// predictable branch, and not at all if it is below LOGS_MIN_LEVEL. As with any if statement, an
+// else that follows belongs to it. Levels are only compared to a LOGS_MIN_LEVEL above
+// LOGS_LEVEL_TRACE, as unsigned levels are always at least 0
+#if LOGS_MIN_LEVEL > LOGS_LEVEL_TRACE
+#  define logs_at_level(level) if (((level) >= LOGS_MIN_LEVEL) && logs_level_is_enabled(level))
+#else
+#  define logs_at_level(level) if (logs_level_is_enabled(level))
+#endif
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//// Rate limiting & sampling
+// Read the time-stamp counter, whose frequency is measured by logs_calibrate_clock()
+static inline u64 logs_read_tsc(void)
+{
+#if defined(_MSC_VER)
+  return __rdtsc();
+#elif defined(__clang__) || defined(__GNUC__)
+  return __builtin_ia32_rdtsc();
+#endif
+}
+
+// Update a site whose message is logged, and log a line with the count of messages it suppressed
+// since the last one, if any. Called by logs_rate_limited()
+void logs_pass_rate_limit(struct logs_site* site, u64 tsc, u32 max_per_second, u32 burst);
+
+// Whether the message of a rate-limited site is logged, as a token bucket refilled with
+// max_per_second tokens per second and holding up to burst of them (generic cell rate algorithm).
+// The TSC is read for every message, so that none is suppressed once the limit allows it again:
+// suppressed messages only cost that read, a compare and an increment
+static inline u32 logs_rate_limit_allows(struct logs_site* site, u32 max_per_second, u32 burst)
+{
+  const u64 tsc = logs_read_tsc();
+  if (tsc < site->next)
+  {
+    site->suppressed_count++;
+    return 0;
+  }
+
+  logs_pass_rate_limit(site, tsc, max_per_second, burst);
+  return 1;
+}
+
+// Whether the message of a sampled site is logged, 1 in every sample_period of them starting with
+// the first. A sample_period of 0 logs every message, as 1 does
+static inline u32 logs_sample_allows(struct logs_site* site, u64 sample_period)
+{
+  if (site->next != 0)
+  {
+    site->next--;
+    return 0;
+  }
+
+  site->next = (sample_period != 0) ? (sample_period - 1) : 0;
+  return 1;
+}
+
+// Run the log_* calls passed after burst at most max_per_second times per second on average, and
+// up to burst times in a row, e.g.
+//   logs_rate_limited(10, 20, log_literal_str("read failed: "); log_os_api_error(error_code));
+// Messages over the limit are counted and reported by a "suppressed N messages from file:line"
+// line, logged before the next message of the site that isn't suppressed. Rate limits are measured
+// in TSC ticks, which the first message converts from seconds by calibrating the clock, unless
+// logs_calibrate_clock() was called at startup. Sites aren't synchronized: threads sharing one may
+// let a few more messages through, or miscount the suppressed ones
+#define logs_rate_limited(max_per_second, burst, ...)                                   \
+  do                                                                                    \
+  {                                                                                     \
+    static struct logs_site logs_site = {.file = __FILE__, .line = __LINE__};           \
+    if (logs_rate_limit_allows(&logs_site, (max_per_second), (burst))) { __VA_ARGS__; } \
+  } while (0)
+
+// Run the log_* calls passed after sample_period once in every sample_period times, starting with
+// the first, e.g. logs_sampled(100, log_literal_str("cache miss\n")). Skipped messages aren't
+// reported, as there are always sample_period - 1 of them between 2 logged ones. A sample_period
+// of 0 is taken as 1
+#define logs_sampled(sample_period, ...)                                      \
+  do                                                                          \
+  {                                                                           \
+    static struct logs_site logs_site = {.file = __FILE__, .line = __LINE__}; \
+    if (logs_sample_allows(&logs_site, (sample_period))) { __VA_ARGS__; }     \
+  } while (0)
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//// Timestamps
+// Timestamps are read from the time-stamp counter (TSC), and converted to nanoseconds since the
+// Unix epoch (1970-01-01 00:00:00 UTC) with a multiplication, which takes a few nanoseconds and no
+// syscall. The conversion is calibrated against the clocks of the OS, by measuring the TSC
+// frequency over LOGS_CLOCK_CALIBRATION_MS milliseconds (20 by default) the first time. Each later
+// calibration measures it again since the first one, which makes it more precise, and catches up
+// with adjustments of the OS's wall clock (e.g. by NTP). On CPUs whose TSC isn't invariant (its
+// frequency changes with power states), timestamps are read from the OS's wall clock instead, with
+// a clock_gettime syscall on Linux and GetSystemTimeAsFileTime() on Windows
+#if !defined(LOGS_CLOCK_CALIBRATION_MS)
+#  define LOGS_CLOCK_CALIBRATION_MS 20
+#endif
+
+// Calibrate the conversion of TSC values to timestamps. Timestamps can't be read while it runs:
+// call it at startup, before other threads read timestamps, so that neither the first
+// logs_timestamp_ns() call nor the first rate-limited message waits for it, and then every now and
+// then (e.g. every few seconds) from the same thread as them
+void logs_calibrate_clock(void);
+
+// Get the current wall-clock time, in nanoseconds since the Unix epoch
+u64 logs_timestamp_ns(void);
+
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 //// Characters & strings logging
@@ -128,6 +848,9 @@ void log_utf8_character(char character);
 // Append a single UTF-16 unit ('\u732B') to the log buffer
 void log_utf16_character(char16 character);
 
+// Maximum count of bytes a UTF-16 code unit is transcoded to
+#define UTF16_UNIT_MAX_UTF8_SIZE 3
+
 // In C, an ASCII or UTF-8 character literal is an int by default
 #define log_character(character)        \
   _Generic((character),                 \
@@ -144,6 +867,15 @@ void log_utf16_character(char16 character);
 // Append a chain of UTF-8-encoded characters (u8"Fluß") of predetermined size to the log buffer
 void log_sized_utf8_str(const char* str, u64 char_count);
 
+#if defined(LOGS_OS_LINUX) && defined(LOGS_ZERO_COPY) && (LOGS_ZERO_COPY != 0)
+// Reference a chain of UTF-8-encoded characters of predetermined size, written by the next flush
+// between what was appended before and after it, without copying it to the log buffer. str must
+// remain valid and unchanged until then. Chains smaller than LOGS_ZERO_COPY_MIN_SIZE are copied
+void log_sized_utf8_str_ref(const char* str, u64 char_count);
+#else
+#  define log_sized_utf8_str_ref(str, char_count) log_sized_utf8_str(str, char_count)
+#endif
+
 // Append a chain of UTF-16-encoded characters (u"çéÖ", L"çéÖ") of predetermined size to the
 // log buffer
 void log_sized_utf16_str(const char16* str, u64 char16_count);
@@ -265,12 +997,27 @@ void log_bin_f32(f32 num);
 #define S64_MAX_DEC_STR_SIZE          20
 #define F32_DEC_FRAC_DEFAULT_STR_SIZE  6
 #define F32_DEC_FRAC_MAX_STR_SIZE      9
+#define F64_DEC_FRAC_MAX_STR_SIZE     17
 
 // Should be a 1 followed by F32_DEC_FRAC_DEFAULT_STR_SIZE zeros
 #define F32_DEC_FRAC_MULT 1000000.f
 
-// Sign + integer part + period + fractional part
-#define F32_MAX_DEC_STR_SIZE (1 + U32_MAX_DEC_STR_SIZE + 1 + F32_DEC_FRAC_MAX_STR_SIZE)
+// Maximum count of significant digits needed for a f32 or a f64 to round-trip
+#define F32_MAX_DEC_SIGNIFICANT_DIGITS  9
+#define F64_MAX_DEC_SIGNIFICANT_DIGITS 17
+
+// log_dec_f32() and log_dec_f64() write the shortest decimal that rounds back to the same value, in
+// fixed notation for absolute values in [10^-6; 10^21[, in scientific notation otherwise. Their
+// longest output is either:
+// - sign + 21 integer digits (e.g. "-123456789000000000000")
+// - sign + "0." + 5 zeros + all significant digits (e.g. "-0.0000012345678901234567")
+#define F32_MAX_DEC_STR_SIZE (1 + 21)
+#define F64_MAX_DEC_STR_SIZE (1 + 2 + 5 + F64_MAX_DEC_SIGNIFICANT_DIGITS)
+
+// log_sized_dec_f32() and log_sized_dec_f64() write a sign + integer part + period + fractional
+// part. The largest f32 and f64 have 39 and 309 integer digits
+#define F32_MAX_SIZED_DEC_STR_SIZE (1 + 39 + 1 + F32_DEC_FRAC_MAX_STR_SIZE)
+#define F64_MAX_SIZED_DEC_STR_SIZE (1 + 309 + 1 + F64_DEC_FRAC_MAX_STR_SIZE)
 
 
 void log_sized_dec_s8 (s8  num, u64 digit_to_write_count);
@@ -282,9 +1029,15 @@ void log_sized_dec_u16(u16 num, u64 digit_to_write_count);
 void log_sized_dec_u32(u32 num, u64 digit_to_write_count);
 void log_sized_dec_u64(u64 num, u64 digit_to_write_count);
 
+// Write num in fixed notation, correctly rounded (ties to even) to frac_digit_to_write_count
+// fractional digits, e.g. 0.125 with 2 fractional digits is written "0.12", 2.5 with none "2".
+// frac_digit_to_write_count is capped at F32_DEC_FRAC_MAX_STR_SIZE or F64_DEC_FRAC_MAX_STR_SIZE
 void log_sized_dec_f32_number(f32 num, u64 frac_digit_to_write_count);
 void log_sized_dec_f32(f32 num, u64 frac_digit_to_write_count);
 
+void log_sized_dec_f64_number(f64 num, u64 frac_digit_to_write_count);
+void log_sized_dec_f64(f64 num, u64 frac_digit_to_write_count);
+
 #define log_sized_dec_num(num, digit_to_write_count) \
   _Generic((num),                               \
            s8:  log_sized_dec_s8,               \
@@ -295,7 +1048,8 @@ void log_sized_dec_f32(f32 num, u64 frac_digit_to_write_count);
            u16: log_sized_dec_u16,              \
            u32: log_sized_dec_u32,              \
            u64: log_sized_dec_u64,              \
-           f32: log_sized_dec_f32)              \
+           f32: log_sized_dec_f32,              \
+           f64: log_sized_dec_f64)              \
           (num, digit_to_write_count)
 
 void log_dec_s8 (s8  num);
@@ -307,10 +1061,16 @@ void log_dec_u16(u16 num);
 void log_dec_u32(u32 num);
 void log_dec_u64(u64 num);
 
+// Write the shortest decimal that rounds back to num, e.g. 0.3 for 0.3f (whose exact value is
+// 0.300000011920928955078125), 1e+30 for 1e30f and 1.17549435e-38 for FLT_MIN
 void log_dec_f32_nan_or_inf(f32 num);
 void log_dec_f32_number(f32 num);
 void log_dec_f32(f32 num);
 
+void log_dec_f64_nan_or_inf(f64 num);
+void log_dec_f64_number(f64 num);
+void log_dec_f64(f64 num);
+
 #define log_dec_num(num)     \
   _Generic((num),            \
            s8:  log_dec_s8,  \
@@ -321,7 +1081,43 @@ void log_dec_f32(f32 num);
            u16: log_dec_u16, \
            u32: log_dec_u32, \
            u64: log_dec_u64, \
-           f32: log_dec_f32) \
+           f32: log_dec_f32, \
+           f64: log_dec_f64) \
+          (num)
+
+// Scientific
+// Sign + first digit + period + other significant digits + 'e' + exponent sign + exponent digits
+// (e.g. "-1.17549435e-38")
+#define F32_MAX_SCI_STR_SIZE (1 + F32_MAX_DEC_SIGNIFICANT_DIGITS + 1 + 1 + 1 + 2)
+#define F64_MAX_SCI_STR_SIZE (1 + F64_MAX_DEC_SIGNIFICANT_DIGITS + 1 + 1 + 1 + 3)
+
+// Write num in scientific notation, correctly rounded (ties to even) to digit_to_write_count
+// significant digits, e.g. 1.2345e-7 with 4 significant digits is written "1.234e-07".
+// digit_to_write_count is clamped to [1; F32_MAX_DEC_SIGNIFICANT_DIGITS] or
+// [1; F64_MAX_DEC_SIGNIFICANT_DIGITS]
+void log_sized_sci_f32_number(f32 num, u64 digit_to_write_count);
+void log_sized_sci_f32(f32 num, u64 digit_to_write_count);
+
+void log_sized_sci_f64_number(f64 num, u64 digit_to_write_count);
+void log_sized_sci_f64(f64 num, u64 digit_to_write_count);
+
+#define log_sized_sci_num(num, digit_to_write_count) \
+  _Generic((num),                               \
+           f32: log_sized_sci_f32,              \
+           f64: log_sized_sci_f64)              \
+          (num, digit_to_write_count)
+
+// Write the shortest decimal that rounds back to num in scientific notation, e.g. "1.234e-07"
+void log_sci_f32_number(f32 num);
+void log_sci_f32(f32 num);
+
+void log_sci_f64_number(f64 num);
+void log_sci_f64(f64 num);
+
+#define log_sci_num(num)     \
+  _Generic((num),            \
+           f32: log_sci_f32, \
+           f64: log_sci_f64) \
           (num)
 
 // Hexadecimal
@@ -381,10 +1177,60 @@ void log_hex_f32(f32 num);
            f32: log_hex_f32) \
           (num)
 
+// Lowercase hexadecimal, same as above with the 'a' to 'f' digits instead of 'A' to 'F'
+void log_sized_hex_lower_s8 (s8  num, u64 nibble_to_write_count);
+void log_sized_hex_lower_s16(s16 num, u64 nibble_to_write_count);
+void log_sized_hex_lower_s32(s32 num, u64 nibble_to_write_count);
+void log_sized_hex_lower_s64(s64 num, u64 nibble_to_write_count);
+void log_sized_hex_lower_u8 (u8  num, u64 nibble_to_write_count);
+void log_sized_hex_lower_u16(u16 num, u64 nibble_to_write_count);
+void log_sized_hex_lower_u32(u32 num, u64 nibble_to_write_count);
+void log_sized_hex_lower_u64(u64 num, u64 nibble_to_write_count);
+void log_sized_hex_lower_f32(f32 num, u64 nibble_to_write_count);
+
+#define log_sized_hex_lower_num(num, nibble_to_write_count) \
+  _Generic((num),                                           \
+           s8:  log_sized_hex_lower_s8,                     \
+           s16: log_sized_hex_lower_s16,                    \
+           s32: log_sized_hex_lower_s32,                    \
+           s64: log_sized_hex_lower_s64,                    \
+           u8:  log_sized_hex_lower_u8,                     \
+           u16: log_sized_hex_lower_u16,                    \
+           u32: log_sized_hex_lower_u32,                    \
+           u64: log_sized_hex_lower_u64,                    \
+           f32: log_sized_hex_lower_f32)                    \
+          (num, nibble_to_write_count)
+
+void log_hex_lower_s8 (s8  num);
+void log_hex_lower_s16(s16 num);
+void log_hex_lower_s32(s32 num);
+void log_hex_lower_s64(s64 num);
+void log_hex_lower_u8 (u8  num);
+void log_hex_lower_u16(u16 num);
+void log_hex_lower_u32(u32 num);
+void log_hex_lower_u64(u64 num);
+void log_hex_lower_f32(f32 num);
+
+#define log_hex_lower_num(num)     \
+  _Generic((num),                  \
+           s8:  log_hex_lower_s8,  \
+           s16: log_hex_lower_s16, \
+           s32: log_hex_lower_s32, \
+           s64: log_hex_lower_s64, \
+           u8:  log_hex_lower_u8,  \
+           u16: log_hex_lower_u16, \
+           u32: log_hex_lower_u32, \
+           u64: log_hex_lower_u64, \
+           f32: log_hex_lower_f32) \
+          (num)
+
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 //// Non-alphanumeric types logging
+// "false"
+#define BOOL_MAX_STR_SIZE 5
+
 void    log_bool(u64 boolean);
 #define log_pointer(ptr) log_sized_hex_u64((u64)(ptr), 16)
 
@@ -397,6 +1243,11 @@ void    log_bool(u64 boolean);
 #define BYTE_COUNT_FRAC_SIZE 2
 #define BYTE_COUNT_FRAC_DIV  100
 
+// Up to 3 integer digits + '.' + fractional digits + " EB" (e.g. "999.99 PB"), and up to 4 integer
+// digits + '.' + fractional digits + " EiB" (e.g. "1023.99 KiB")
+#define BYTE_COUNT_DEC_UNIT_MAX_STR_SIZE (3 + 1 + BYTE_COUNT_FRAC_SIZE + 3)
+#define BYTE_COUNT_BIN_UNIT_MAX_STR_SIZE (4 + 1 + BYTE_COUNT_FRAC_SIZE + 4)
+
 // Log the passed count of bytes shortened to be human-readable (if necessary), followed by a space
 // character (' '), its matching decimal unit prefix (if any), and the unit character ('B').
 //
@@ -443,28 +1294,240 @@ void log_byte_count_dec_unit(u64 byte_count);
 void log_byte_count_bin_unit(u64 byte_count);
 
 
+// "HH:MM:SS.nnnnnnnnn"
+#define TIME_OF_DAY_MAX_STR_SIZE 18
+
+// "YYYY-MM-DDTHH:MM:SSZ", "YYYY-MM-DDTHH:MM:SS.sssZ", "YYYY-MM-DDTHH:MM:SS.ssssssZ" and
+// "YYYY-MM-DDTHH:MM:SS.nnnnnnnnnZ"
+#define ISO8601_S_MAX_STR_SIZE  20
+#define ISO8601_MS_MAX_STR_SIZE 24
+#define ISO8601_US_MAX_STR_SIZE 27
+#define ISO8601_NS_MAX_STR_SIZE 30
+
+// Log the UTC time of day of timestamp_ns, in nanoseconds since the Unix epoch (e.g. from
+// logs_timestamp_ns()), as "HH:MM:SS.nnnnnnnnn". The hours, minutes and seconds of the last
+// second logged are cached, only the nanoseconds are formatted for timestamps of the same second
+void log_time_of_day(u64 timestamp_ns);
+
+// Log a timestamp in seconds, milliseconds, microseconds or nanoseconds since the Unix epoch as an
+// ISO 8601 UTC date and time, with 0, 3, 6 or 9 fractional digits (e.g. log_iso8601_ms() logs
+// "YYYY-MM-DDTHH:MM:SS.sssZ"). "YYYY-MM-DDTHH:MM:SS" of the last second logged is cached, and
+// shared with log_time_of_day(): timestamps of the same second only have their fractional digits
+// formatted. Dates range from 1970-01-01 to 9999-12-31: later timestamps are clamped to
+// "9999-12-31T23:59:59" with all fractional digits 9 (nanosecond ones end in 2554)
+void log_iso8601_s (u64 timestamp_s);
+void log_iso8601_ms(u64 timestamp_ms);
+void log_iso8601_us(u64 timestamp_us);
+void log_iso8601_ns(u64 timestamp_ns);
+
+
 // Log the passed Windows or Linux API error code in decimal and its matching description as:
 //   "<OS> API error <decimal error code>: <error description>"
 void log_os_api_error(u32 error_code);
 
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//// Line prefixes
+// Append str, a string of char_count UTF-8 characters, to both variants of prefix. Strings, fields
+// and escape sequences which don't fit in LOGS_PREFIX_MAX_SIZE bytes are ignored
+void logs_prefix_append_str(logs_prefix* prefix, const char* str, u64 char_count);
+
+// Append an ANSI escape sequence (e.g. LOGS_ANSI_RED) of char_count characters to the variant of
+// prefix stamped while they are enabled (see logs_enable_console_ansi_escape_sequence())
+void logs_prefix_append_ansi_str(logs_prefix* prefix, const char* str, u64 char_count);
+
+// Append a field of type field_type to prefix (see logs_prefix_field_type). Fields past
+// LOGS_PREFIX_MAX_FIELD_COUNT are ignored
+void logs_prefix_append_field(logs_prefix* prefix, logs_prefix_field_type field_type,
+                              u64 digit_count);
+
+#define logs_prefix_append_literal_str(prefix, str) \
+          logs_prefix_append_str((prefix), (str), sizeof(str) - 1)
+#define logs_prefix_append_literal_ansi_str(prefix, str) \
+          logs_prefix_append_ansi_str((prefix), (str), sizeof(str) - 1)
+
+// Append prefix to the log buffer, its fields being formatted from values, one per field in the
+// order they were appended, e.g.:
+//   log_prefix(&warning_prefix, (u64[]){logs_timestamp_ns(), thread_id});
+// Timestamp fields share the cache of the last second logged with log_iso8601_*()
+void log_prefix(const logs_prefix* prefix, const u64* values);
+
+
+#  if defined(LOGS_OS_LINUX) && defined(LOGS_BINARY) && (LOGS_BINARY != 0)
+///////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//// Binary logging
+// Maximum size of a varint-encoded u64: 7 bits per byte
+#define VARINT_MAX_SIZE 10
+
+// Append the tag of a call site, then its arguments. Called by log_binary()
+void log_binary_site(const struct logs_binary_site* site);
+void log_binary_u64(u64 num);
+void log_binary_s64(s64 num);
+void log_binary_f32(f32 num);
+void log_binary_f64(f64 num);
+void log_binary_str(const char* str);
+
+// char, long and unsigned long (size_t) are distinct from the fixed-width types, and are mapped to
+// those of their size on x86_64 Linux, where char is signed
+#define log_binary_type(arg)              \
+  _Generic((arg),                         \
+           u8:            LOGS_BINARY_U8,  \
+           u16:           LOGS_BINARY_U16, \
+           u32:           LOGS_BINARY_U32, \
+           u64:           LOGS_BINARY_U64, \
+           unsigned long: LOGS_BINARY_U64, \
+           s8:            LOGS_BINARY_S8,  \
+           char:          LOGS_BINARY_S8,  \
+           s16:           LOGS_BINARY_S16, \
+           s32:           LOGS_BINARY_S32, \
+           s64:           LOGS_BINARY_S64, \
+           long:          LOGS_BINARY_S64, \
+           f32:           LOGS_BINARY_F32, \
+           f64:           LOGS_BINARY_F64, \
+           char*:         LOGS_BINARY_STR, \
+           const char*:   LOGS_BINARY_STR)
+
+#define log_binary_arg(arg)               \
+  _Generic((arg),                         \
+           u8:            log_binary_u64, \
+           u16:           log_binary_u64, \
+           u32:           log_binary_u64, \
+           u64:           log_binary_u64, \
+           unsigned long: log_binary_u64, \
+           s8:            log_binary_s64, \
+           char:          log_binary_s64, \
+           s16:           log_binary_s64, \
+           s32:           log_binary_s64, \
+           s64:           log_binary_s64, \
+           long:          log_binary_s64, \
+           f32:           log_binary_f32, \
+           f64:           log_binary_f64, \
+           char*:         log_binary_str, \
+           const char*:   log_binary_str) \
+          (arg)
+
+// Append a binary log of a literal format and up to LOGS_BINARY_MAX_ARG_COUNT arguments, e.g.
+// log_binary("read {} bytes from {} at {x}\n", byte_count, file_name, offset). Only the tag of the
+// call site and the arguments are appended: the format and the argument types are stored in the
+// logs_binary_sites section at compile time
+#define log_binary(...)                                                                           \
+  LOGS_BINARY_SELECT(__VA_ARGS__, LOGS_BINARY_8, LOGS_BINARY_7, LOGS_BINARY_6, LOGS_BINARY_5,      \
+                     LOGS_BINARY_4, LOGS_BINARY_3, LOGS_BINARY_2, LOGS_BINARY_1, LOGS_BINARY_0, 0) \
+                    (__VA_ARGS__)
+
+#define LOGS_BINARY_SELECT(format, a, b, c, d, e, f, g, h, statement, ...) statement
+
+// The types are passed last, so that the variable arguments are never empty
+#define LOGS_BINARY_SITE(format, arg_count, ...)                                           \
+  static const struct logs_binary_site __attribute__((section("logs_binary_sites"), used)) \
+    logs_binary_site = {"" format, arg_count, {__VA_ARGS__}};                              \
+  log_binary_site(&logs_binary_site)
+
+#define LOGS_BINARY_0(format) \
+  do { LOGS_BINARY_SITE(format, 0, 0); } while (0)
+#define LOGS_BINARY_1(format, a)                                 \
+  do                                                             \
+  {                                                              \
+    LOGS_BINARY_SITE(format, 1, log_binary_type(a));             \
+    log_binary_arg(a);                                           \
+  } while (0)
+#define LOGS_BINARY_2(format, a, b)                                      \
+  do                                                                     \
+  {                                                                      \
+    LOGS_BINARY_SITE(format, 2, log_binary_type(a), log_binary_type(b)); \
+    log_binary_arg(a); log_binary_arg(b);                                \
+  } while (0)
+#define LOGS_BINARY_3(format, a, b, c)                                       \
+  do                                                                         \
+  {                                                                          \
+    LOGS_BINARY_SITE(format, 3, log_binary_type(a), log_binary_type(b),      \
+                     log_binary_type(c));                                    \
+    log_binary_arg(a); log_binary_arg(b); log_binary_arg(c);                 \
+  } while (0)
+#define LOGS_BINARY_4(format, a, b, c, d)                                    \
+  do                                                                         \
+  {                                                                          \
+    LOGS_BINARY_SITE(format, 4, log_binary_type(a), log_binary_type(b),      \
+                     log_binary_type(c), log_binary_type(d));                \
+    log_binary_arg(a); log_binary_arg(b); log_binary_arg(c);                 \
+    log_binary_arg(d);                                                       \
+  } while (0)
+#define LOGS_BINARY_5(format, a, b, c, d, e)                                 \
+  do                                                                         \
+  {                                                                          \
+    LOGS_BINARY_SITE(format, 5, log_binary_type(a), log_binary_type(b),      \
+                     log_binary_type(c), log_binary_type(d),                 \
+                     log_binary_type(e));                                    \
+    log_binary_arg(a); log_binary_arg(b); log_binary_arg(c);                 \
+    log_binary_arg(d); log_binary_arg(e);                                    \
+  } while (0)
+#define LOGS_BINARY_6(format, a, b, c, d, e, f)                              \
+  do                                                                         \
+  {                                                                          \
+    LOGS_BINARY_SITE(format, 6, log_binary_type(a), log_binary_type(b),      \
+                     log_binary_type(c), log_binary_type(d),                 \
+                     log_binary_type(e), log_binary_type(f));                \
+    log_binary_arg(a); log_binary_arg(b); log_binary_arg(c);                 \
+    log_binary_arg(d); log_binary_arg(e); log_binary_arg(f);                 \
+  } while (0)
+#define LOGS_BINARY_7(format, a, b, c, d, e, f, g)                           \
+  do                                                                         \
+  {                                                                          \
+    LOGS_BINARY_SITE(format, 7, log_binary_type(a), log_binary_type(b),      \
+                     log_binary_type(c), log_binary_type(d),                 \
+                     log_binary_type(e), log_binary_type(f),                 \
+                     log_binary_type(g));                                    \
+    log_binary_arg(a); log_binary_arg(b); log_binary_arg(c);                 \
+    log_binary_arg(d); log_binary_arg(e); log_binary_arg(f);                 \
+    log_binary_arg(g);                                                       \
+  } while (0)
+#define LOGS_BINARY_8(format, a, b, c, d, e, f, g, h)                        \
+  do                                                                         \
+  {                                                                          \
+    LOGS_BINARY_SITE(format, 8, log_binary_type(a), log_binary_type(b),      \
+                     log_binary_type(c), log_binary_type(d),                 \
+                     log_binary_type(e), log_binary_type(f),                 \
+                     log_binary_type(g), log_binary_type(h));                \
+    log_binary_arg(a); log_binary_arg(b); log_binary_arg(c);                 \
+    log_binary_arg(d); log_binary_arg(e); log_binary_arg(f);                 \
+    log_binary_arg(g); log_binary_arg(h);                                    \
+  } while (0)
+#  endif
+
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 //// Utilities
 
+// Multiply a by b. The low 64 bits of the 128-bit product are returned, its high 64 bits are
+// written to hi
+u64 umul128(u64 a, u64 b, u64* hi);
+
 // Get the count of leading zeros in num
 u64 lzcnt32(u32 num);
 
 // Get the count of leading zeros in num
 u64 lzcnt64(u64 num);
 
+// Get the count of trailing zeros in num, which must not be 0
+u64 tzcnt32(u32 num);
+
 // From low to high bits, everytime a 1 bit is encounted in mask, deposit the bit located at the
 // same index in 'a' into the destination (from low to high bits as well)
 u32 pdep32(u32 a, u32 mask);
 
+// From low to high bits, everytime a 1 bit is encounted in mask, deposit the bit located at the
+// same index in 'a' into the destination (from low to high bits as well)
+u64 pdep64(u64 a, u64 mask);
+
 // Reverse the order of a
 u32 bswap32(u32 a);
 
+// Reverse the order of a
+u64 bswap64(u64 a);
+
 // Get the most significant 1 bit index of num
 u64 get_msb_1_bit_idx_u32(u32 num);
 
@@ -493,6 +1556,10 @@ u64 u64_nibble_count(u64 num);
 // +/- infinity. Otherwise, it is a number
 u64 f32_is_a_number(f32 num);
 
+// Returns whether f64 is a number (1) of not (0). A f64 is not a number if it +/-qnan, +/-snan, or
+// +/- infinity. Otherwise, it is a number
+u64 f64_is_a_number(f64 num);
+
 // Returns in "unicode" the Unicode number of the next UTF-16 code-point pointed by "utf16". The
 // count of u16 read is returned
 u64 utf16_code_point_to_unicode(const u16* utf16, u32* unicode);
@@ -508,17 +1575,40 @@ u64 unicode_to_utf8_code_point(u32 unicode, u8* utf8);
 #  define logs_close_console_output()                              do { } while (0)
 #  define logs_enable_console_ansi_escape_sequence()               do { } while (0)
 #  define logs_disable_console_ansi_escape_sequence()              do { } while (0)
+#  define logs_prefix_append_str(prefix, str, char_count)          do { (void)(prefix); (void)(str); (void)(char_count); } while (0)
+#  define logs_prefix_append_ansi_str(prefix, str, char_count)     do { (void)(prefix); (void)(str); (void)(char_count); } while (0)
+#  define logs_prefix_append_field(prefix, field_type, digit_count) do { (void)(prefix); (void)(field_type); (void)(digit_count); } while (0)
+#  define logs_prefix_append_literal_str(prefix, str)              do { (void)(prefix); (void)(str); } while (0)
+#  define logs_prefix_append_literal_ansi_str(prefix, str)         do { (void)(prefix); (void)(str); } while (0)
+#  define log_prefix(prefix, ...)                                  do { (void)(prefix); (void)(__VA_ARGS__); } while (0)
 #  define logs_open_file_output(file_path)                         do { (void)(file_path); } while (0)
 #  define logs_close_file_output()                                 do { } while (0)
 #  define logs_flush_to(output)                                    do { (void)output; } while (0)
 #  define logs_flush()                                             do { } while (0)
+#  define logs_set_flush_mode(flush_mode)                          do { (void)(flush_mode); } while (0)
+#  define logs_wait_for_flush()                                    do { } while (0)
+#  define logs_attach_thread(thread_logs)                          do { (void)(thread_logs); } while (0)
+#  define logs_reserve(max_byte_count)                             do { (void)(max_byte_count); } while (0)
+#  define logs_commit()                                            do { } while (0)
+#  define logs_ring_dropped_byte_count()                           0
+#  define log_binary(...)                                          do { } while (0)
 #  define logs_buffer_remaining_bytes()                            0
+#  define logs_set_level(min_level)                                do { (void)(min_level); } while (0)
+#  define logs_set_output_level(output_idx, min_level)             do { (void)(output_idx); (void)(min_level); } while (0)
+#  define logs_level_is_enabled(level)                             0
+#  define logs_at_level(level)                                     if (0)
+#  define logs_read_tsc()                                          0
+#  define logs_rate_limited(max_per_second, burst, ...)            do { (void)(max_per_second); (void)(burst); } while (0)
+#  define logs_sampled(sample_period, ...)                         do { (void)(sample_period); } while (0)
+#  define logs_calibrate_clock()                                   do { } while (0)
+#  define logs_timestamp_ns()                                      0
 #  define log_ascii_char(char_character)                           do { (void)(char_character); } while (0)
 #  define log_utf8_character(character)                            do { (void)(character); } while (0)
 #  define log_utf16_character(ucharacter)                          do { (void)(character); } while (0)
 #  define log_character(character)                                 do { (void)(character); } while (0)
 #  define log_sized_ascii_str(char_character)                      do { (void)(char_character); } while (0)
 #  define log_sized_utf8_str(str, char_count)                      do { (void)(str); (void)(char_count); } while (0)
+#  define log_sized_utf8_str_ref(str, char_count)                  do { (void)(str); (void)(char_count); } while (0)
 #  define log_sized_utf16_str(str, char16_count)                   do { (void)(str); (void)(char16_count); } while (0)
 #  define log_str(str, count)                                      do { (void)(str); (void)(count); } while (0)
 #  define log_null_terminated_ascii_str(char_character)            do { (void)(char_character); } while (0)
@@ -560,6 +1650,21 @@ u64 unicode_to_utf8_code_point(u32 unicode, u8* utf8);
 #  define log_dec_f32_nan_or_inf(num)                              do { (void)(num); } while (0)
 #  define log_dec_f32_number(num)                                  do { (void)(num); } while (0)
 #  define log_dec_f32(num)                                         do { (void)(num); } while (0)
+#  define log_dec_f64_nan_or_inf(num)                              do { (void)(num); } while (0)
+#  define log_dec_f64_number(num)                                  do { (void)(num); } while (0)
+#  define log_dec_f64(num)                                         do { (void)(num); } while (0)
+#  define log_sized_dec_f64_number(num, frac_digit_to_write_count) do { (void)(num); (void)(frac_digit_to_write_count); } while (0)
+#  define log_sized_dec_f64(num, frac_digit_to_write_count)        do { (void)(num); (void)(frac_digit_to_write_count); } while (0)
+#  define log_sized_sci_f32_number(num, digit_to_write_count)      do { (void)(num); (void)(digit_to_write_count); } while (0)
+#  define log_sized_sci_f32(num, digit_to_write_count)             do { (void)(num); (void)(digit_to_write_count); } while (0)
+#  define log_sized_sci_f64_number(num, digit_to_write_count)      do { (void)(num); (void)(digit_to_write_count); } while (0)
+#  define log_sized_sci_f64(num, digit_to_write_count)             do { (void)(num); (void)(digit_to_write_count); } while (0)
+#  define log_sized_sci_num(num, digit_to_write_count)             do { (void)(num); (void)(digit_to_write_count); } while (0)
+#  define log_sci_f32_number(num)                                  do { (void)(num); } while (0)
+#  define log_sci_f32(num)                                         do { (void)(num); } while (0)
+#  define log_sci_f64_number(num)                                  do { (void)(num); } while (0)
+#  define log_sci_f64(num)                                         do { (void)(num); } while (0)
+#  define log_sci_num(num)                                         do { (void)(num); } while (0)
 #  define log_dec_s8(num)                                          do { (void)(num); } while (0)
 #  define log_dec_s16(num)                                         do { (void)(num); } while (0)
 #  define log_dec_s32(num)                                         do { (void)(num); } while (0)
@@ -589,15 +1694,44 @@ u64 unicode_to_utf8_code_point(u32 unicode, u8* utf8);
 #  define log_hex_u64(num)                                         do { (void)(num); } while (0)
 #  define log_hex_f32(num)                                         do { (void)(num); } while (0)
 #  define log_hex_num(num)                                         do { (void)(num); } while (0)
+#  define log_sized_hex_lower_s8(num, nibble_to_write_count)       do { (void)(num); (void)(nibble_to_write_count); } while (0)
+#  define log_sized_hex_lower_s16(num, nibble_to_write_count)      do { (void)(num); (void)(nibble_to_write_count); } while (0)
+#  define log_sized_hex_lower_s32(num, nibble_to_write_count)      do { (void)(num); (void)(nibble_to_write_count); } while (0)
+#  define log_sized_hex_lower_s64(num, nibble_to_write_count)      do { (void)(num); (void)(nibble_to_write_count); } while (0)
+#  define log_sized_hex_lower_u8(num, nibble_to_write_count)       do { (void)(num); (void)(nibble_to_write_count); } while (0)
+#  define log_sized_hex_lower_u16(num, nibble_to_write_count)      do { (void)(num); (void)(nibble_to_write_count); } while (0)
+#  define log_sized_hex_lower_u32(num, nibble_to_write_count)      do { (void)(num); (void)(nibble_to_write_count); } while (0)
+#  define log_sized_hex_lower_u64(num, nibble_to_write_count)      do { (void)(num); (void)(nibble_to_write_count); } while (0)
+#  define log_sized_hex_lower_f32(num, nibble_to_write_count)      do { (void)(num); (void)(nibble_to_write_count); } while (0)
+#  define log_sized_hex_lower_num(num, nibble_to_write_count)      do { (void)(num); (void)(nibble_to_write_count); } while (0)
+#  define log_hex_lower_s8(num)                                    do { (void)(num); } while (0)
+#  define log_hex_lower_s16(num)                                   do { (void)(num); } while (0)
+#  define log_hex_lower_s32(num)                                   do { (void)(num); } while (0)
+#  define log_hex_lower_s64(num)                                   do { (void)(num); } while (0)
+#  define log_hex_lower_u8(num)                                    do { (void)(num); } while (0)
+#  define log_hex_lower_u16(num)                                   do { (void)(num); } while (0)
+#  define log_hex_lower_u32(num)                                   do { (void)(num); } while (0)
+#  define log_hex_lower_u64(num)                                   do { (void)(num); } while (0)
+#  define log_hex_lower_f32(num)                                   do { (void)(num); } while (0)
+#  define log_hex_lower_num(num)                                   do { (void)(num); } while (0)
 #  define log_bool(boolean)                                        do { (void)(boolean); } while (0)
 #  define log_pointer(ptr)                                         do { (void)(ptr); } while (0)
 #  define log_byte_count_dec_unit(byte_count)                      do { (void)(byte_count); } while (0)
 #  define log_byte_count_bin_unit(byte_count)                      do { (void)(byte_count); } while (0)
+#  define log_time_of_day(timestamp_ns)                            do { (void)(timestamp_ns); } while (0)
+#  define log_iso8601_s(timestamp_s)                               do { (void)(timestamp_s); } while (0)
+#  define log_iso8601_ms(timestamp_ms)                             do { (void)(timestamp_ms); } while (0)
+#  define log_iso8601_us(timestamp_us)                             do { (void)(timestamp_us); } while (0)
+#  define log_iso8601_ns(timestamp_ns)                             do { (void)(timestamp_ns); } while (0)
 #  define log_os_api_error(error_code)                             do { (void)(error_code); } while (0)
+#  define umul128(a, b, hi)                                        do { (void)(a); (void)(b); (void)(hi); } while (0)
 #  define lzcnt32(num)                                             do { (void)(num); } while (0)
 #  define lzcnt64(num)                                             do { (void)(num); } while (0)
+#  define tzcnt32(num)                                             do { (void)(num); } while (0)
 #  define pdep32(a, mask)                                          do { (void)(a); (void)(mask); } while (0)
+#  define pdep64(a, mask)                                          do { (void)(a); (void)(mask); } while (0)
 #  define bswap32(a)                                               do { (void)(a); } while (0)
+#  define bswap64(a)                                               do { (void)(a); } while (0)
 #  define get_msb_1_bit_idx_u32(num)                               do { (void)(num); } while (0)
 #  define get_msb_1_bit_idx_u64(num)                               do { (void)(num); } while (0)
 #  define u32_digit_count(num)                                     do { (void)(num); } while (0)
@@ -607,6 +1741,7 @@ u64 unicode_to_utf8_code_point(u32 unicode, u8* utf8);
 #  define u32_nibble_count(num)                                    do { (void)(num); } while (0)
 #  define u64_nibble_count(num)                                    do { (void)(num); } while (0)
 #  define f32_is_a_number(num)                                     do { (void)(num); } while (0)
+#  define f64_is_a_number(num)                                     do { (void)(num); } while (0)
 #  define utf16_code_point_to_unicode(utf16, unicode)              do { (void)(utf16); (void)(unicode); } while (0)
 #  define unicode_to_utf8_code_point(unicode, utf8)                do { (void)(unicode); (void)(utf8); } while (0)
 #endif // defined(LOGS_ENABLED) && (LOGS_ENABLED != 0)
@@ -0,0 +1,450 @@
+// Decoder of binary logs (see LOGS_BINARY in logs.h): reads a binary logs stream from the file
+// passed as its first argument, or from its standard input, and writes the text the log_*
+// functions would have formatted to its standard output, e.g.:
+//   ./build/logs_bench_binary | ./build/logs_decode
+//   ./build/logs_decode binary_logs.bin > logs.txt
+// Compilation command line, on Linux only:
+//   gcc -DLOGS_ENABLED -DLOGS_AUTO_FLUSH -O2 -fno-builtin -fno-stack-protector -mbmi2 -mlzcnt -mssse3 -nostdlib logs.c logs_decode.c
+#include "logs.h"
+
+#if !defined(LOGS_OS_LINUX)
+#  error "Binary logs are only written on Linux"
+#endif
+#if !defined(LOGS_AUTO_FLUSH) || (LOGS_AUTO_FLUSH == 0)
+#  error "logs_decode is built with LOGS_AUTO_FLUSH, as decoded strings may be of any size"
+#endif
+
+// Stream bytes are read in blocks of DECODE_INPUT_SIZE bytes, which bounds the size of a record
+#define DECODE_INPUT_SIZE     (1024 * 1024)
+#define DECODE_MAX_SITE_COUNT 65536
+#define DECODE_FORMATS_SIZE   (4 * 1024 * 1024)
+
+#define READ_SYSCALL       0
+#define OPEN_SYSCALL       2
+#define EXIT_GROUP_SYSCALL 231
+#define STDIN_FD           0
+
+struct decode_site
+{
+  u64 format_offset;
+  u64 format_size;
+  u8  arg_count;
+  u8  arg_types[LOGS_BINARY_MAX_ARG_COUNT];
+};
+
+static struct
+{
+  u8  bytes[DECODE_INPUT_SIZE];
+  u64 start_idx;
+  u64 end_idx;
+  u32 fd;
+  u32 is_at_end;
+} input;
+
+// The last dictionary read
+static struct
+{
+  struct decode_site sites[DECODE_MAX_SITE_COUNT];
+  u64                site_count;
+  char               formats[DECODE_FORMATS_SIZE];
+  u64                formats_size;
+} dictionary;
+
+// Argument of a record, decoded before being formatted
+union decode_arg
+{
+  u64 u;
+  s64 s;
+  f32 f32;
+  f64 f64;
+  struct
+  {
+    const char* chars;
+    u64         size;
+  } str;
+};
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//// Input
+static inline s64 decode_syscall3(u64 number, u64 arg_0, u64 arg_1, u64 arg_2)
+{
+  register u64 number_rax __asm__("rax") = number;
+  register u64 arg_0_rdi  __asm__("rdi") = arg_0;
+  register u64 arg_1_rsi  __asm__("rsi") = arg_1;
+  register u64 arg_2_rdx  __asm__("rdx") = arg_2;
+  s64 result;
+  __asm__ __volatile__ ("syscall" :
+                        "=a"(result) :
+                        "r"(number_rax), "r"(arg_0_rdi), "r"(arg_1_rsi), "r"(arg_2_rdx) :
+                        "rcx", "r11", "memory");
+  return result;
+}
+
+
+static void exit_decoder(u64 exit_code)
+{
+  logs_flush();
+  decode_syscall3(EXIT_GROUP_SYSCALL, exit_code, 0, 0);
+}
+
+
+static void exit_with_error(const char* description)
+{
+  log_literal_str("\nlogs_decode: ");
+  log_null_terminated_utf8_str(description);
+  log_character('\n');
+  exit_decoder(1);
+}
+
+
+// Make byte_count bytes available from input.start_idx on, reading more of the stream if needed.
+// Returns 0 if the stream ends before
+static u64 request_input(u64 byte_count)
+{
+  while ((input.end_idx - input.start_idx) < byte_count)
+  {
+    if (input.is_at_end)
+    {
+      return 0;
+    }
+
+    if (byte_count > DECODE_INPUT_SIZE)
+    {
+      exit_with_error("record larger than the input buffer");
+    }
+
+    // Move the unread bytes to the start of the buffer, then fill it
+    const u64 unread_byte_count = input.end_idx - input.start_idx;
+    for (u64 i = 0; i < unread_byte_count; i++)
+    {
+      input.bytes[i] = input.bytes[input.start_idx + i];
+    }
+    input.start_idx = 0;
+    input.end_idx   = unread_byte_count;
+
+    const s64 read_byte_count = decode_syscall3(READ_SYSCALL, input.fd, (u64)(input.bytes + input.end_idx),
+                                                DECODE_INPUT_SIZE - input.end_idx);
+    if (read_byte_count < 0)
+    {
+      exit_with_error("failed to read the input");
+    }
+
+    input.is_at_end  = (read_byte_count == 0);
+    input.end_idx   += (u64)read_byte_count;
+  }
+
+  return 1;
+}
+
+
+static const u8* read_bytes(u64 byte_count)
+{
+  if (!request_input(byte_count))
+  {
+    exit_with_error("truncated record");
+  }
+
+  const u8* bytes = input.bytes + input.start_idx;
+  input.start_idx += byte_count;
+  return bytes;
+}
+
+
+static u64 read_varint(void)
+{
+  u64 num = 0;
+  for (u64 shift = 0; shift < 70; shift += 7)
+  {
+    const u8 byte = *read_bytes(1);
+    num |= (u64)(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0)
+    {
+      return num;
+    }
+  }
+
+  exit_with_error("invalid varint");
+  return 0;
+}
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//// Decoding
+static void read_dictionary(void)
+{
+  const u8* magic = read_bytes(LOGS_BINARY_MAGIC_SIZE);
+  for (u64 i = 0; i < LOGS_BINARY_MAGIC_SIZE; i++)
+  {
+    if (magic[i] != (u8)LOGS_BINARY_MAGIC[i])
+    {
+      exit_with_error("unknown dictionary version");
+    }
+  }
+
+  dictionary.site_count   = read_varint();
+  dictionary.formats_size = 0;
+  if (dictionary.site_count > DECODE_MAX_SITE_COUNT)
+  {
+    exit_with_error("too many call sites");
+  }
+
+  for (u64 i = 0; i < dictionary.site_count; i++)
+  {
+    struct decode_site* site = &dictionary.sites[i];
+    site->arg_count = *read_bytes(1);
+    if (site->arg_count > LOGS_BINARY_MAX_ARG_COUNT)
+    {
+      exit_with_error("too many arguments");
+    }
+
+    const u8* arg_types = read_bytes(site->arg_count);
+    for (u64 arg_idx = 0; arg_idx < site->arg_count; arg_idx++)
+    {
+      if (arg_types[arg_idx] >= LOGS_BINARY_TYPE_COUNT)
+      {
+        exit_with_error("unknown argument type");
+      }
+      site->arg_types[arg_idx] = arg_types[arg_idx];
+    }
+
+    site->format_size = read_varint();
+    if (site->format_size > (DECODE_FORMATS_SIZE - dictionary.formats_size))
+    {
+      exit_with_error("formats too large");
+    }
+
+    const u8* format = read_bytes(site->format_size);
+    site->format_offset = dictionary.formats_size;
+    for (u64 c = 0; c < site->format_size; c++)
+    {
+      dictionary.formats[dictionary.formats_size + c] = (char)format[c];
+    }
+    dictionary.formats_size += site->format_size;
+  }
+}
+
+
+static union decode_arg read_arg(u8 arg_type)
+{
+  union decode_arg arg;
+  switch (arg_type)
+  {
+    case LOGS_BINARY_U8:
+    case LOGS_BINARY_U16:
+    case LOGS_BINARY_U32:
+    case LOGS_BINARY_U64:
+      arg.u = read_varint();
+      break;
+
+    case LOGS_BINARY_S8:
+    case LOGS_BINARY_S16:
+    case LOGS_BINARY_S32:
+    case LOGS_BINARY_S64:
+    {
+      const u64 zigzag = read_varint();
+      arg.s = (s64)(zigzag >> 1) ^ -(s64)(zigzag & 1);
+      break;
+    }
+
+    case LOGS_BINARY_F32:
+      arg.f32 = *(const f32*)read_bytes(sizeof(f32));
+      break;
+
+    case LOGS_BINARY_F64:
+      arg.f64 = *(const f64*)read_bytes(sizeof(f64));
+      break;
+
+    default:
+      arg.str.size  = read_varint();
+      arg.str.chars = (const char*)read_bytes(arg.str.size);
+      break;
+  }
+
+  return arg;
+}
+
+
+// Format an argument like the log_* function selected by the conversion of its placeholder: 0 for
+// "{}", 'x' for "{x}", 'X' for "{X}", 'b' for "{b}", 'e' for "{e}", or '.' for "{.N}"
+static void format_arg(u8 arg_type, union decode_arg arg, char conversion, u64 frac_digit_count)
+{
+  switch (arg_type)
+  {
+#define FORMAT_INT(type, num)                                       \
+    switch (conversion)                                             \
+    {                                                               \
+      case 'x': log_hex_lower_##type((type)(num)); break;           \
+      case 'X': log_hex_##type((type)(num));       break;           \
+      case 'b': log_bin_##type((type)(num));       break;           \
+      default:  log_dec_##type((type)(num));       break;           \
+    }                                                               \
+    break
+
+    case LOGS_BINARY_U8:  FORMAT_INT(u8,  arg.u);
+    case LOGS_BINARY_U16: FORMAT_INT(u16, arg.u);
+    case LOGS_BINARY_U32: FORMAT_INT(u32, arg.u);
+    case LOGS_BINARY_U64: FORMAT_INT(u64, arg.u);
+    case LOGS_BINARY_S8:  FORMAT_INT(s8,  arg.s);
+    case LOGS_BINARY_S16: FORMAT_INT(s16, arg.s);
+    case LOGS_BINARY_S32: FORMAT_INT(s32, arg.s);
+    case LOGS_BINARY_S64: FORMAT_INT(s64, arg.s);
+#undef FORMAT_INT
+
+    case LOGS_BINARY_F32:
+      switch (conversion)
+      {
+        case 'x': log_hex_lower_f32(arg.f32);                    break;
+        case 'X': log_hex_f32(arg.f32);                          break;
+        case 'b': log_bin_f32(arg.f32);                          break;
+        case 'e': log_sci_f32(arg.f32);                          break;
+        case '.': log_sized_dec_f32(arg.f32, frac_digit_count);  break;
+        default:  log_dec_f32(arg.f32);                          break;
+      }
+      break;
+
+    case LOGS_BINARY_F64:
+      // There is no hexadecimal nor binary formatting of f64 values
+      switch (conversion)
+      {
+        case 'e': log_sci_f64(arg.f64);                          break;
+        case '.': log_sized_dec_f64(arg.f64, frac_digit_count);  break;
+        default:  log_dec_f64(arg.f64);                          break;
+      }
+      break;
+
+    default:
+      log_sized_utf8_str(arg.str.chars, arg.str.size);
+      break;
+  }
+}
+
+
+// Write the format of a call site, its placeholders replaced by the arguments read from the stream
+static void decode_record(const struct decode_site* site)
+{
+  const char* format     = dictionary.formats + site->format_offset;
+  const char* format_end = format + site->format_size;
+  u64         arg_idx    = 0;
+  while (format < format_end)
+  {
+    // Characters up to the next placeholder, or "{{"
+    const char* literal_end = format;
+    while ((literal_end < format_end) && (*literal_end != '{'))
+    {
+      literal_end++;
+    }
+    log_sized_utf8_str(format, (u64)(literal_end - format));
+    format = literal_end;
+    if (format == format_end)
+    {
+      break;
+    }
+
+    if (((format + 1) < format_end) && (format[1] == '{'))
+    {
+      log_character('{');
+      format += 2;
+      continue;
+    }
+
+    const char* placeholder_end = format;
+    while ((placeholder_end < format_end) && (*placeholder_end != '}'))
+    {
+      placeholder_end++;
+    }
+    if ((placeholder_end == format_end) || (arg_idx == site->arg_count))
+    {
+      // Written as is, without any argument left to replace it
+      log_sized_utf8_str(format, (u64)(placeholder_end - format));
+      format = placeholder_end;
+      continue;
+    }
+
+    char conversion       = (placeholder_end > (format + 1)) ? format[1] : 0;
+    u64  frac_digit_count = 0;
+    for (const char* digit = format + 2; (conversion == '.') && (digit < placeholder_end); digit++)
+    {
+      frac_digit_count = (frac_digit_count * 10) + (u64)(*digit - '0');
+    }
+
+    const u8 arg_type = site->arg_types[arg_idx];
+    format_arg(arg_type, read_arg(arg_type), conversion, frac_digit_count);
+    arg_idx++;
+    format = placeholder_end + 1;
+  }
+
+  // Arguments without placeholders are skipped
+  for (; arg_idx < site->arg_count; arg_idx++)
+  {
+    read_arg(site->arg_types[arg_idx]);
+  }
+}
+
+
+static void decode(void)
+{
+  u64 has_dictionary = 0;
+  while (request_input(1))
+  {
+    const u64 tag = read_varint();
+    if (tag == 0)
+    {
+      read_dictionary();
+      has_dictionary = 1;
+      continue;
+    }
+
+    if (!has_dictionary || (tag > dictionary.site_count))
+    {
+      exit_with_error("record of an unknown call site");
+    }
+
+    decode_record(&dictionary.sites[tag - 1]);
+  }
+}
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//// Entry point
+// Called by _start with the initial stack pointer, where the kernel stored argc then argv. Marked
+// as used since only _start, written in assembly, references it
+__attribute__((used)) void run_decoder(u64* initial_stack)
+{
+  const u64          arg_count = initial_stack[0];
+  const char* const* args      = (const char* const*)(initial_stack + 1);
+
+  input.fd = STDIN_FD;
+  if (arg_count > 1)
+  {
+    const s64 fd = decode_syscall3(OPEN_SYSCALL, (u64)args[1], 0, 0); // O_RDONLY
+    if (fd < 0)
+    {
+      log_os_api_error((u32)-fd);
+      exit_with_error("failed to open the input file");
+    }
+    input.fd = (u32)fd;
+  }
+
+  decode();
+  exit_decoder(0);
+}
+
+
+// The stack pointer is passed before anything is pushed, then aligned for the call
+__asm__ (".globl _start\n"
+         "_start:\n\t"
+         "xorl %ebp, %ebp\n\t"
+         "movq %rsp, %rdi\n\t"
+         "andq $-16, %rsp\n\t"
+         "callq run_decoder\n\t"
+         "ud2");
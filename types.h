@@ -24,7 +24,8 @@
 #endif
 
 // Floating-point
-typedef float f32;
+typedef float  f32;
+typedef double f64;
 
 // Character
 typedef u16 char16;